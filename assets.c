@@ -0,0 +1,277 @@
+#include "assets.h"
+#include "startup.h"
+#include "profiler.h"
+#include "soundbank.h"
+#include <stdio.h>
+#include <string.h>
+
+// Helper function for error checking, same contract as checkInit
+static void checkAsset(int condition, const char* message, const char* path) {
+    if (condition) {
+        printf("Error: %s %s\n", message, path);
+        exit(1);
+    }
+}
+
+double assetMilliseconds(Uint64 start, Uint64 end) {
+    return (double)(end - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+// Runs on a worker thread: only file I/O and decoding, no renderer calls
+static void decodeAsset(AssetLoader* loader, Asset* asset) {
+    asset->decode_start = SDL_GetPerformanceCounter();
+    asset->decode_thread = SDL_ThreadID();
+    const PakEntry* entry;
+
+    switch (asset->kind) {
+        case ASSET_TEXTURE:
+            // Packed images are already RGBA at draw size, nothing to decode
+            entry = findArchiveEntry(&loader->archive, asset->path);
+            if (entry) {
+                asset->pixels = archivePixels(&loader->archive, entry);
+                asset->pixel_w = entry->width;
+                asset->pixel_h = entry->height;
+                asset->pixel_alpha = entry->flags & PAK_ALPHA;
+                asset->logical_size = (SDL_Point){ entry->logical_w, entry->logical_h };
+                break;
+            }
+
+            asset->surface = IMG_Load(asset->path);
+            if (!asset->surface) {
+                printf("Warning: Failed to load image %s\n", asset->path);
+                if (asset->fallback_w > 0) {
+                    // Create a placeholder
+                    SDL_Color c = asset->fallback_color;
+                    asset->surface = SDL_CreateRGBSurface(0, asset->fallback_w, asset->fallback_h, 32, 0, 0, 0, 0);
+                    if (asset->surface) {
+                        SDL_FillRect(asset->surface, NULL, SDL_MapRGB(asset->surface->format, c.r, c.g, c.b));
+                        asset->used_fallback = 1;
+                    }
+                }
+            }
+            if (asset->surface) asset->logical_size = (SDL_Point){ asset->surface->w, asset->surface->h };
+            break;
+
+        case ASSET_CHUNK:
+            // The other workers keep decoding images meanwhile
+            SDL_LockMutex(loader->mixer_lock);
+            asset->audio = Mix_LoadWAV(asset->path);
+            if (!asset->audio) printf("Warning: Failed to load sound %s: %s\n", asset->path, Mix_GetError());
+            SDL_UnlockMutex(loader->mixer_lock);
+            break;
+
+        case ASSET_SOUND:
+            // SDL_LoadWAV and SDL_ConvertAudio, no SDL_mixer: no lock
+            asset->audio = loadSoundBank(&asset->path, 1, asset->frequency);
+            break;
+    }
+
+    asset->decode_end = SDL_GetPerformanceCounter();
+}
+
+static int assetWorker(void* data) {
+    AssetLoader* loader = data;
+    nameProfilerThread("asset worker");
+
+    SDL_LockMutex(loader->lock);
+    while (!loader->quit) {
+        if (loader->job_head == loader->job_tail) {
+            SDL_CondWait(loader->work_available, loader->lock);
+            continue;
+        }
+
+        int index = loader->jobs[loader->job_head];
+        loader->job_head = (loader->job_head + 1) % ASSET_MAX;
+        Asset* asset = &loader->assets[index];
+        asset->status = ASSET_DECODING;
+        SDL_UnlockMutex(loader->lock);
+
+        PROFILE_BEGIN("decodeAsset");
+        decodeAsset(loader, asset);
+        PROFILE_END();
+
+        SDL_LockMutex(loader->lock);
+        asset->status = ASSET_DECODED;
+        loader->done[loader->done_tail] = index;
+        loader->done_tail = (loader->done_tail + 1) % ASSET_MAX;
+    }
+    SDL_UnlockMutex(loader->lock);
+
+    return 0;
+}
+
+void initAssetLoader(AssetLoader* loader, SDL_Renderer* renderer) {
+    memset(loader, 0, sizeof(*loader));
+    loader->renderer = renderer;
+    loader->started_at = SDL_GetPerformanceCounter();
+    openAssetArchive(&loader->archive, PAK_DEFAULT_PATH);
+
+    loader->lock = SDL_CreateMutex();
+    loader->work_available = SDL_CreateCond();
+    loader->mixer_lock = SDL_CreateMutex();
+    checkAsset(!loader->lock || !loader->work_available || !loader->mixer_lock, "Failed to create asset loader", "locks");
+
+    // Leave one core to the render thread
+    loader->num_workers = SDL_GetCPUCount() - 1;
+    if (loader->num_workers < 1) loader->num_workers = 1;
+    if (loader->num_workers > ASSET_MAX_WORKERS) loader->num_workers = ASSET_MAX_WORKERS;
+    for (int i = 0; i < loader->num_workers; i++) {
+        loader->workers[i] = SDL_CreateThread(assetWorker, "asset-decode", loader);
+        checkAsset(!loader->workers[i], "Failed to create asset worker", SDL_GetError());
+    }
+}
+
+void shutdownAssetLoader(AssetLoader* loader) {
+    if (!loader->lock) return;
+
+    SDL_LockMutex(loader->lock);
+    loader->quit = 1;
+    SDL_CondBroadcast(loader->work_available);
+    SDL_UnlockMutex(loader->lock);
+
+    for (int i = 0; i < loader->num_workers; i++) {
+        SDL_WaitThread(loader->workers[i], NULL);
+    }
+
+    // Decoded but never uploaded
+    for (int i = 0; i < loader->count; i++) {
+        if (loader->assets[i].surface) SDL_FreeSurface(loader->assets[i].surface);
+        if (loader->assets[i].audio && loader->assets[i].status == ASSET_DECODED) {
+            if (loader->assets[i].kind == ASSET_SOUND) freeSoundBank(loader->assets[i].audio);
+            else Mix_FreeChunk(loader->assets[i].audio);
+        }
+        loader->assets[i].surface = NULL;
+        loader->assets[i].audio = NULL;
+    }
+
+    SDL_DestroyCond(loader->work_available);
+    SDL_DestroyMutex(loader->lock);
+    SDL_DestroyMutex(loader->mixer_lock);
+    loader->lock = NULL;
+    loader->mixer_lock = NULL;
+    closeAssetArchive(&loader->archive);
+}
+
+// Returns the slot index
+int queueAsset(AssetLoader* loader, Asset asset) {
+    SDL_LockMutex(loader->lock);
+
+    int index = 0;
+    while (index < ASSET_MAX && loader->assets[index].in_use) index++;
+    checkAsset(index == ASSET_MAX, "Too many assets in flight, raise ASSET_MAX for", asset.path);
+
+    asset.in_use = 1;
+    asset.status = ASSET_QUEUED;
+    asset.queued_at = SDL_GetPerformanceCounter();
+    loader->assets[index] = asset;
+    if (index >= loader->count) loader->count = index + 1;
+    loader->pending++;
+
+    loader->jobs[loader->job_tail] = index;
+    loader->job_tail = (loader->job_tail + 1) % ASSET_MAX;
+
+    SDL_CondSignal(loader->work_available);
+    SDL_UnlockMutex(loader->lock);
+    return index;
+}
+
+// Render thread: turns a decoded asset into its final object
+static void finishAsset(AssetLoader* loader, Asset* asset) {
+    asset->upload_start = SDL_GetPerformanceCounter();
+
+    if (asset->kind == ASSET_TEXTURE) {
+        SDL_Texture* texture = NULL;
+        if (asset->pixels) {
+            // Straight from the mapping into the texture, no intermediate surface
+            texture = SDL_CreateTexture(loader->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, asset->pixel_w, asset->pixel_h);
+            if (texture) SDL_UpdateTexture(texture, NULL, asset->pixels, asset->pixel_w * 4);
+            // Same blend mode SDL_CreateTextureFromSurface would have picked
+            if (texture && (asset->blend || asset->pixel_alpha)) SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            asset->pixels = NULL;
+        } else if (asset->surface) {
+            texture = SDL_CreateTextureFromSurface(loader->renderer, asset->surface);
+            if (texture && asset->blend) SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            SDL_FreeSurface(asset->surface);
+            asset->surface = NULL;
+        }
+        checkAsset(!texture && asset->required, "Failed to create texture", asset->path);
+        asset->status = texture ? ASSET_READY : ASSET_FAILED;
+
+        if (asset->on_ready) asset->on_ready(asset, texture);
+        else if (asset->target) *asset->target = texture;
+    } else {
+        checkAsset(!asset->audio && asset->required, "Failed to load", asset->path);
+        asset->status = asset->audio ? ASSET_READY : ASSET_FAILED;
+
+        if (asset->on_ready) asset->on_ready(asset, asset->audio);
+        else if (asset->target) *asset->target = asset->audio;
+    }
+
+    asset->upload_end = SDL_GetPerformanceCounter();
+}
+
+// Creates textures for decoded assets until the time budget is spent.
+// Returns the number of assets finished.
+int uploadDecodedAssets(AssetLoader* loader, float budget_ms) {
+    PROFILE_FUNCTION();
+    Uint64 start = SDL_GetPerformanceCounter();
+    int finished = 0;
+
+    for (;;) {
+        SDL_LockMutex(loader->lock);
+        if (loader->done_head == loader->done_tail) {
+            SDL_UnlockMutex(loader->lock);
+            break;
+        }
+        int index = loader->done[loader->done_head];
+        loader->done_head = (loader->done_head + 1) % ASSET_MAX;
+        SDL_UnlockMutex(loader->lock);
+
+        Asset* asset = &loader->assets[index];
+        finishAsset(loader, asset);
+        traceAssetSpans(asset);
+        loader->last_ready = asset->path;
+        finished++;
+
+        // Slot can be reused, the timings stay until then
+        SDL_LockMutex(loader->lock);
+        asset->in_use = 0;
+        loader->pending--;
+        loader->finished++;
+        SDL_UnlockMutex(loader->lock);
+
+        if (assetMilliseconds(start, SDL_GetPerformanceCounter()) > budget_ms) break;
+    }
+
+    return finished;
+}
+
+int assetLoaderDone(AssetLoader* loader) {
+    return loader->pending == 0;
+}
+
+// Share of the assets requested since init that are finished, out: [0, 1]
+float assetLoaderProgress(AssetLoader* loader) {
+    int total = loader->finished + loader->pending;
+    return total > 0 ? (float)loader->finished / total : 1.0f;
+}
+
+void printAssetTimings(AssetLoader* loader) {
+    Uint64 end = loader->started_at;
+    for (int i = 0; i < loader->count; i++) {
+        if (loader->assets[i].upload_end > end) end = loader->assets[i].upload_end;
+    }
+
+    printf("Loaded %d assets in %.1f ms on %d threads (%s)\n", loader->finished, assetMilliseconds(loader->started_at, end), loader->num_workers,
+           loader->archive.data ? "archive + loose files" : "loose files");
+    for (int i = 0; i < loader->count; i++) {
+        Asset* a = &loader->assets[i];
+        if (a->in_use) continue;
+        printf("  %-60s wait %7.2f ms  decode %7.2f ms  upload %6.2f ms%s\n", a->path,
+               assetMilliseconds(a->queued_at, a->decode_start),
+               assetMilliseconds(a->decode_start, a->decode_end),
+               assetMilliseconds(a->upload_start, a->upload_end),
+               a->status == ASSET_FAILED ? "  FAILED" : a->used_fallback ? "  (placeholder)" : "");
+    }
+}
+
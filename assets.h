@@ -0,0 +1,104 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+#include "pak.h"
+
+/*
+            DEFINITIONS
+*/
+#define ASSET_MAX 256             // Assets in flight (slots are recycled once finished)
+#define ASSET_MAX_WORKERS 4       // Decode threads
+#define ASSET_UPLOAD_BUDGET 8.0f  // ms of texture creation per loading screen frame
+
+typedef enum {
+    ASSET_TEXTURE,   // IMG_Load on a worker, texture created on the render thread
+    ASSET_CHUNK,     // Mix_LoadWAV on a worker, one worker at a time
+    ASSET_SOUND      // Effect converted to the mixer format on a worker, as a bank of one
+} AssetKind;
+
+typedef enum {
+    ASSET_QUEUED,
+    ASSET_DECODING,
+    ASSET_DECODED,   // Waiting for the render thread
+    ASSET_READY,
+    ASSET_FAILED
+} AssetStatus;
+
+/*
+            ASSET STRUCTURES
+*/
+typedef struct Asset Asset;
+typedef void (*AssetCallback)(Asset* asset, void* object);
+
+struct Asset {
+    // Description, filled by the caller
+    AssetKind kind;
+    const char* path;            // Must outlive the request
+    void** target;               // SDL_Texture**, Mix_Chunk** or SoundBank** to fill
+    AssetCallback on_ready;      // Or: called on the render thread with the object (NULL if it failed)
+    void* userdata;
+    int user_index;
+    int required;                // Abort startup if it cannot be loaded
+    int blend;                   // Set SDL_BLENDMODE_BLEND on the texture
+    int fallback_w, fallback_h;  // Placeholder size when the file is missing (0: none)
+    SDL_Color fallback_color;
+    int frequency;               // ASSET_SOUND: device rate to convert to
+
+    // Results
+    int in_use;                  // Slot taken until the asset is finished
+    AssetStatus status;
+    SDL_Surface* surface;        // Decoded image waiting for upload
+    const void* pixels;          // Or: RGBA32 pixels mapped from the archive
+    int pixel_w, pixel_h;
+    int pixel_alpha;             // The packed source had alpha, blended like a surface with alpha
+    SDL_Point logical_size;      // Source image size, what the game computes draw sizes from
+    void* audio;                 // Decoded Mix_Chunk or SoundBank
+    int used_fallback;
+    Uint64 queued_at;            // Performance counter timestamps
+    SDL_threadID decode_thread;  // Worker that decoded it
+    Uint64 decode_start;
+    Uint64 decode_end;
+    Uint64 upload_start;
+    Uint64 upload_end;
+};
+
+typedef struct {
+    Asset assets[ASSET_MAX];
+    int count;                   // Highest slot ever used + 1
+    int jobs[ASSET_MAX];         // Slots waiting for a worker (ring)
+    int job_head, job_tail;
+    int done[ASSET_MAX];         // Decoded assets waiting for upload (ring)
+    int done_head, done_tail;
+    int pending;                 // Queued, decoding or waiting for upload
+    int finished;                // Uploaded (or failed) assets since init
+    const char* last_ready;      // Path of the last uploaded asset, for the loading screen
+
+    SDL_Thread* workers[ASSET_MAX_WORKERS];
+    int num_workers;
+    SDL_mutex* lock;
+    SDL_cond* work_available;
+    SDL_mutex* mixer_lock;       // SDL_mixer does not document its loaders as thread-safe
+    int quit;
+
+    SDL_Renderer* renderer;
+    AssetArchive archive;        // Pre-decoded images, loose files are the fallback
+    Uint64 started_at;
+} AssetLoader;
+
+
+/*
+            DECLARATIONS
+*/
+void initAssetLoader(AssetLoader* loader, SDL_Renderer* renderer);
+void shutdownAssetLoader(AssetLoader* loader);
+int queueAsset(AssetLoader* loader, Asset asset);
+int uploadDecodedAssets(AssetLoader* loader, float budget_ms);
+int assetLoaderDone(AssetLoader* loader);
+float assetLoaderProgress(AssetLoader* loader);
+double assetMilliseconds(Uint64 start, Uint64 end);
+void printAssetTimings(AssetLoader* loader);
+
+#endif
@@ -0,0 +1,571 @@
+// Microbenchmarks of the per-frame kernels, headless: rendering goes to a
+// software renderer drawing into a surface, audio and video use the dummy
+// drivers. Results are printed and written as JSON, one benchmark per line,
+// so runs from two commits can be diffed.
+// One gameplay frame is also counted call by call: a pass going over its
+// budget in bench/draw.budgets fails the run, so does a benchmark whose
+// median goes over its time budget. A stretch of the game loop, capped at
+// FPS with a key press per frame, reports the frame time percentiles and
+// input latency, press to present.
+// Usage: bench.out [--update-budgets] [results.json]
+#include "init.h"
+#include "game.h"
+#include "render.h"
+#include "gravity.h"
+#include "memtrack.h"
+#include "drawstats.h"
+#include "sfxmixer.h"
+#include "latency.h"
+#include "pacer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_RESULTS_PATH "bench_results.json"
+#define BENCH_BUDGETS_PATH "bench/draw.budgets"
+#define BENCH_WIDTH 1200               // Same as the window initWindow asks for
+#define BENCH_HEIGHT 900
+#define BENCH_SEED 1                   // Starfield and astral objects are the same every run
+#define BENCH_MAX 32
+#define BENCH_PARTICLES 100000         // What the particle system must sustain at FPS
+#define BENCH_FRAME_US (1000000.0 / FPS)
+#define BENCH_BUDGET_HEADROOM 10       // % over the counted frame for the passes that follow rand()
+#define BENCH_LOOP_FRAMES 240          // Frames of the game loop, a key press in each
+
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown"       // Set by the Makefile from git describe
+#endif
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+    int renders;                       // Flush the renderer: SDL batches draws until then
+    int batch;                         // Calls per sample, for kernels faster than the timer
+    int samples;
+    int warmup;                        // Samples run first and thrown away
+    void (*setup)(void);               // Before the warm-up, NULL for none
+    double budget_us;                  // Most the median may take, 0 for no limit
+    int voices;                        // Sound effects mixed per call, also reported per voice (0: none)
+} Benchmark;
+
+typedef struct {
+    const char* name;
+    int samples, batch;
+    double median_us, p99_us, mean_us, min_us, max_us;   // Per call
+    double budget_us;
+    int voices;
+} BenchResult;
+
+// Most a pass may send in the counted frame, -1 for no limit
+typedef struct {
+    int draw_calls;
+    int texture_switches;
+    int textures_created;
+} DrawBudget;
+
+// What the benchmarked functions run on
+static struct {
+    SDL_Window* window;              // Hidden, the UI is laid out from its size
+    SDL_Surface* surface;
+    SDL_Renderer* renderer;
+    GameResources resources;
+    UIElements ui;
+    BackgroundEffects* bg_effects;
+    GameData data;
+    Fighter fighter;
+    Game game;
+} bench;
+
+/*
+            BENCHMARKS
+*/
+static void benchStarfield() {
+    renderStarfield(bench.renderer, bench.bg_effects, &bench.resources);
+}
+
+static void benchOrbitalTrails() {
+    renderOrbitalTrails(bench.renderer, bench.bg_effects, &bench.resources);
+}
+
+static void benchDrawCircle() {
+    drawCircle(bench.renderer, BENCH_WIDTH / 2, BENCH_HEIGHT / 2, 200, (SDL_Color){150, 200, 255, 255});
+}
+
+// A new surface and texture every call, like every label in the HUD
+static void benchRenderText() {
+    SDL_Rect rect = {20, 10, 300, 50};
+    renderText(bench.renderer, bench.resources.font, "Score: 12500", (SDL_Color){255, 255, 255, 255}, &rect, 0, 1);
+}
+
+static void benchGravityExact() {
+    bench.bg_effects->gravity_field->mode = GRAVITY_EXACT;
+    calculateGravityForces(&bench.game.player, bench.bg_effects);
+}
+
+static void benchGravityGrid() {
+    bench.bg_effects->gravity_field->mode = GRAVITY_GRID;
+    calculateGravityForces(&bench.game.player, bench.bg_effects);
+}
+
+// The fighter is out of reach of every object: the per-frame scan, not a discovery
+static void benchDiscovery() {
+    SimEvents events;
+    checkAstralObjectDiscovery(&bench.game.player, bench.bg_effects, &events);
+}
+
+// Everything a gameplay frame draws, with the HUD and the present
+static void benchGameScreen() {
+    renderGameScreen(bench.renderer, &bench.game, &bench.fighter, &bench.resources, &bench.ui, bench.bg_effects);
+}
+
+static void benchGenerateStarfield() {
+    generateStarfield(bench.bg_effects);
+}
+
+// Spread over the screen and alive for the whole run, every sample moves
+// and draws all of them
+static void fillParticles() {
+    ParticleSystem* ps = &bench.bg_effects->particles;
+    clearParticles(ps);
+    for (int i = 0; i < BENCH_PARTICLES; i++) {
+        float x = bench.resources.bg_x + particleRandom(ps) * BENCH_WIDTH;
+        float y = bench.resources.bg_y + particleRandom(ps) * BENCH_HEIGHT;
+        spawnParticle(ps, x, y, particleRandom(ps) - 0.5f, particleRandom(ps) - 0.5f, 1e6f, 4.0f, (SDL_Color){255, 140, 40, 255});
+    }
+}
+
+static void benchUpdateParticles() {
+    updateParticles(&bench.bg_effects->particles, 1.0f / FPS);
+}
+
+static void benchRenderParticles() {
+    ParticleSystem* ps = &bench.bg_effects->particles;
+    renderParticles(bench.renderer, ps, bench.resources.bg_x, bench.resources.bg_y, BENCH_WIDTH, BENCH_HEIGHT);
+}
+
+// One pass of the sound effect callback: voices mixed into the float buffer
+// with their gains ramping, then added to the music stream. Each voice reads
+// its own source, like different effects from the bank.
+static float mixSources[SFX_MAX_VOICES][SFX_MIX_FRAMES * 2];
+static float mixBuffer[SFX_MIX_FRAMES * 2] __attribute__((aligned(16)));
+static Sint16 mixStream[SFX_MIX_FRAMES * 2];
+
+static void fillMixSources() {
+    Uint32 rng = BENCH_SEED;
+    for (int v = 0; v < SFX_MAX_VOICES; v++) {
+        for (int i = 0; i < SFX_MIX_FRAMES * 2; i++) {
+            rng = rng * 1103515245u + 12345u;
+            mixSources[v][i] = (float)((rng >> 16) & 0x7FFF) - 16384.0f;
+        }
+    }
+}
+
+static void mixVoices(int voices) {
+    memset(mixBuffer, 0, sizeof(mixBuffer));
+    for (int v = 0; v < voices; v++) {
+        mixSfxVoice(mixBuffer, mixSources[v], SFX_MIX_FRAMES, 0.5f, 0.4f, 0.4f, 0.5f);
+    }
+    addSfxToStream(mixStream, mixBuffer, SFX_MIX_FRAMES * 2);
+}
+
+static void benchMixVoices1() {
+    mixVoices(1);
+}
+
+static void benchMixVoices8() {
+    mixVoices(8);
+}
+
+static void benchMixVoices32() {
+    mixVoices(SFX_MAX_VOICES);
+}
+
+static const Benchmark benchmarks[] = {
+    { "renderGameScreen",              benchGameScreen,        1,   1,  200, 20, NULL, 0, 0 },
+    { "renderStarfield",               benchStarfield,         1,   1,  300, 30, NULL, 0, 0 },
+    { "renderOrbitalTrails",           benchOrbitalTrails,     1,   1,  300, 30, NULL, 0, 0 },
+    { "drawCircle",                    benchDrawCircle,        1,  10,  300, 30, NULL, 0, 0 },
+    { "renderText",                    benchRenderText,        1,  10,  300, 30, NULL, 0, 0 },
+    { "calculateGravityForces/exact",  benchGravityExact,      0, 1000, 500, 50, NULL, 0, 0 },
+    { "calculateGravityForces/grid",   benchGravityGrid,       0, 1000, 500, 50, NULL, 0, 0 },
+    { "checkAstralObjectDiscovery",    benchDiscovery,         0, 1000, 500, 50, NULL, 0, 0 },
+    // The update has to fit a frame; the software rasterizer is no measure
+    // of what a GPU does with the quads, their time is only reported
+    { "updateParticles/100k",          benchUpdateParticles,   0,   1,  300, 30, fillParticles, BENCH_FRAME_US, 0 },
+    { "renderParticles/100k",          benchRenderParticles,   1,   1,   20,  2, fillParticles, 0, 0 },
+    // Up to every voice playing at once, the JSON also has the time per voice
+    { "mixSfxVoices/1",                benchMixVoices1,        0, 100,  300, 30, fillMixSources, 0, 1 },
+    { "mixSfxVoices/8",                benchMixVoices8,        0,  20,  300, 30, fillMixSources, 0, 8 },
+    { "mixSfxVoices/32",               benchMixVoices32,       0,  10,  300, 30, fillMixSources, 0, SFX_MAX_VOICES },
+    { "generateStarfield",             benchGenerateStarfield, 0,   1,  100, 10, NULL, 0, 0 },  // Last: it replaces the starfield
+};
+
+/*
+            HARNESS
+*/
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank on sorted samples
+static double percentile(const double* sorted, int count, double p) {
+    int rank = (int)(p * count + 0.999999);
+    if (rank < 1) rank = 1;
+    return sorted[SDL_min(rank, count) - 1];
+}
+
+static double sampleBatch(const Benchmark* b) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < b->batch; i++) b->run();
+    if (b->renders) SDL_RenderFlush(bench.renderer);
+    Uint64 end = SDL_GetPerformanceCounter();
+    return (double)(end - start) * 1000000.0 / SDL_GetPerformanceFrequency() / b->batch;
+}
+
+static void runBenchmark(const Benchmark* b, BenchResult* result) {
+    double* times = memAlloc(sizeof(double) * b->samples, MEM_GENERAL);
+    checkInit(!times, "Failed to allocate benchmark samples");
+
+    if (b->setup) b->setup();
+    for (int i = 0; i < b->warmup; i++) sampleBatch(b);
+
+    double total = 0.0;
+    for (int i = 0; i < b->samples; i++) {
+        // Clear outside the timing so every render sample draws on the same frame
+        if (b->renders) {
+            SDL_SetRenderDrawColor(bench.renderer, 0, 0, 0, 255);
+            SDL_RenderClear(bench.renderer);
+            SDL_RenderFlush(bench.renderer);
+        }
+        times[i] = sampleBatch(b);
+        total += times[i];
+    }
+    qsort(times, b->samples, sizeof(double), compareDoubles);
+
+    *result = (BenchResult){
+        .name = b->name,
+        .samples = b->samples,
+        .batch = b->batch,
+        .median_us = percentile(times, b->samples, 0.50),
+        .p99_us = percentile(times, b->samples, 0.99),
+        .mean_us = total / b->samples,
+        .min_us = times[0],
+        .max_us = times[b->samples - 1],
+        .budget_us = b->budget_us,
+        .voices = b->voices
+    };
+    memFree(times);
+
+    printf("%-30s median %10.3f us   p99 %10.3f us   (%d x %d)\n",
+           result->name, result->median_us, result->p99_us, result->samples, result->batch);
+}
+
+// Returns the number of benchmarks over their time budget
+static int checkTimeBudgets(const BenchResult* results, int count) {
+    int over = 0;
+    for (int i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        if (r->budget_us <= 0 || r->median_us <= r->budget_us) continue;
+        printf("Over budget: %s median %.3f us > %.3f us\n", r->name, r->median_us, r->budget_us);
+        over++;
+    }
+    return over;
+}
+
+/*
+            DRAW BUDGETS
+*/
+// bench/draw.budgets: "pass draw_calls texture_switches textures_created"
+// per line, # starts a comment. Returns 0 if there is no file or no budget
+// in it yet: the counts are still printed, nothing fails.
+static int loadDrawBudgets(const char* path, DrawBudget budgets[DRAW_PASSES]) {
+    for (int i = 0; i < DRAW_PASSES; i++) budgets[i] = (DrawBudget){ -1, -1, -1 };
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Warning: No draw budgets in %s, nothing is checked\n", path);
+        return 0;
+    }
+
+    char line[256];
+    int number = 0, loaded = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char name[64];
+        DrawBudget budget;
+        if (line[0] == '#' || sscanf(line, "%63s", name) != 1) continue;
+        if (sscanf(line, "%63s %d %d %d", name, &budget.draw_calls, &budget.texture_switches, &budget.textures_created) != 4) {
+            printf("Warning: %s:%d: expected a pass and three budgets\n", path, number);
+            continue;
+        }
+
+        int pass = 0;
+        while (pass < DRAW_PASSES && strcmp(drawPassName(pass), name) != 0) pass++;
+        if (pass == DRAW_PASSES) {
+            printf("Warning: %s:%d: unknown pass %s\n", path, number, name);
+            continue;
+        }
+        budgets[pass] = budget;
+        loaded++;
+    }
+    fclose(file);
+
+    if (loaded == 0) printf("Warning: No draw budgets in %s yet, nothing is checked (bench.out --update-budgets)\n", path);
+    return loaded > 0;
+}
+
+// The star and astral object counts depend on the C library's rand()
+static int budgetWithHeadroom(int pass, int count) {
+    if (pass != DRAW_PASS_STARFIELD && pass != DRAW_PASS_ASTRAL) return count;
+    return count + (count * BENCH_BUDGET_HEADROOM + 99) / 100;
+}
+
+// Exact counts, with headroom where they depend on the C library
+static void writeDrawBudgets(const char* path, const DrawStats* stats) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Warning: Could not write %s\n", path);
+        return;
+    }
+
+    fprintf(file, "# Most each pass may send to the renderer in the benchmark frame\n");
+    fprintf(file, "# (bench/bench.c: seeded world, camera on the sun, %dx%d).\n", BENCH_WIDTH, BENCH_HEIGHT);
+    fprintf(file, "# Written by bench.out --update-budgets, `make bench` fails when one is exceeded.\n");
+    fprintf(file, "# The star and astral object passes follow glibc's rand() and get %d%% headroom:\n", BENCH_BUDGET_HEADROOM);
+    fprintf(file, "# regenerate them on another C library. The other passes are exact.\n");
+    fprintf(file, "# pass         draw_calls  texture_switches  textures_created\n");
+    for (int i = 0; i < DRAW_PASSES; i++) {
+        const PassStats* pass = &stats->passes[i];
+        fprintf(file, "%-14s %10d %17d %17d\n", drawPassName(i), budgetWithHeadroom(i, pass->draw_calls),
+                budgetWithHeadroom(i, pass->texture_switches), pass->calls[DRAW_CREATE_TEXTURE]);
+    }
+    fclose(file);
+
+    printf("Draw budgets written to %s\n", path);
+}
+
+static int checkLimit(const char* pass, const char* what, int count, int budget) {
+    if (budget < 0 || count <= budget) return 1;
+    printf("Over budget: %s %s %d > %d\n", pass, what, count, budget);
+    return 0;
+}
+
+// Returns the number of passes over budget
+static int checkDrawBudgets(const DrawStats* stats, const DrawBudget budgets[DRAW_PASSES]) {
+    int over = 0;
+    printf("\n%-14s %10s %10s %10s %10s\n", "pass", "draws", "switches", "created", "alpha mod");
+    for (int i = 0; i < DRAW_PASSES; i++) {
+        const PassStats* pass = &stats->passes[i];
+        printf("%-14s %10d %10d %10d %10d\n", drawPassName(i), pass->draw_calls, pass->texture_switches,
+               pass->calls[DRAW_CREATE_TEXTURE], pass->calls[DRAW_ALPHA_MOD]);
+
+        int ok = checkLimit(drawPassName(i), "draw calls", pass->draw_calls, budgets[i].draw_calls);
+        ok &= checkLimit(drawPassName(i), "texture switches", pass->texture_switches, budgets[i].texture_switches);
+        ok &= checkLimit(drawPassName(i), "textures created", pass->calls[DRAW_CREATE_TEXTURE], budgets[i].textures_created);
+        if (!ok) over++;
+    }
+    return over;
+}
+
+static void writeResults(const char* path, const BenchResult* results, int count, const DrawStats* draws,
+                         const LatencyReport* latency, const FrameStats* frames) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Warning: Could not write %s\n", path);
+        return;
+    }
+
+    SDL_version version;
+    SDL_GetVersion(&version);
+    fprintf(file, "{\n\"revision\": \"%s\",\n\"renderer\": \"software\",\n\"sdl\": \"%d.%d.%d\",\n",
+            BENCH_REVISION, version.major, version.minor, version.patch);
+    fprintf(file, "\"width\": %d,\n\"height\": %d,\n\"stars\": %d,\n\"astral_objects\": %d,\n",
+            BENCH_WIDTH, BENCH_HEIGHT, bench.bg_effects->num_stars, bench.bg_effects->num_astral_objects);
+    fprintf(file, "\"benchmarks\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(file, "{\"name\": \"%s\", \"median_us\": %.3f, \"p99_us\": %.3f, \"mean_us\": %.3f, \"min_us\": %.3f, \"max_us\": %.3f, \"samples\": %d, \"batch\": %d",
+                r->name, r->median_us, r->p99_us, r->mean_us, r->min_us, r->max_us, r->samples, r->batch);
+        if (r->budget_us > 0) fprintf(file, ", \"budget_us\": %.3f", r->budget_us);
+        if (r->voices > 0) {
+            fprintf(file, ", \"voices\": %d, \"median_per_voice_us\": %.3f, \"p99_per_voice_us\": %.3f",
+                    r->voices, r->median_us / r->voices, r->p99_us / r->voices);
+        }
+        fprintf(file, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "],\n\"draws\": [\n");
+    for (int i = 0; i < DRAW_PASSES; i++) {
+        const PassStats* pass = &draws->passes[i];
+        fprintf(file, "{\"pass\": \"%s\", \"draw_calls\": %d, \"texture_switches\": %d", drawPassName(i), pass->draw_calls, pass->texture_switches);
+        for (int k = 0; k < DRAW_CALL_KINDS; k++) fprintf(file, ", \"%s\": %d", drawCallName(k), pass->calls[k]);
+        fprintf(file, "}%s\n", i + 1 < DRAW_PASSES ? "," : "");
+    }
+    fprintf(file, "],\n\"frame_pacing\": {\"fps\": %d, \"frames\": %llu, \"average_ms\": %.3f, \"p50_ms\": %.3f, \"p95_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f},\n",
+            FPS, (unsigned long long)frames->frames, frames->average_ms, frames->p50_ms, frames->p95_ms, frames->p99_ms, frames->max_ms);
+    fprintf(file, "\"input_latency\": {\"p50_ms\": %.3f, \"p99_ms\": %.3f, \"max_ms\": %.3f, \"samples\": %d}\n}\n",
+            latency->p50, latency->p99, latency->max, latency->samples);
+    fclose(file);
+
+    printf("Results written to %s\n", path);
+}
+
+/*
+            FRAME LOOP
+*/
+static void sendKey(Uint32 type, SDL_Scancode scancode) {
+    SDL_Event e;
+    memset(&e, 0, sizeof(e));
+    e.type = type;
+    e.key.timestamp = SDL_GetTicks();
+    e.key.state = type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+    e.key.keysym.scancode = scancode;
+    handleInputEvent(&bench.game.input, &e);
+}
+
+// The main loop's input path and pacing around the gameplay frame: thrust
+// is pressed before each frame, the tick consumes it and the present shows
+// it. The simulation stays out, the world must not move under the other
+// benchmarks.
+static void runFrameLoop(LatencyReport* latency, FrameStats* frames) {
+    static LatencyTracker tracker;
+    static FramePacer pacer;
+    initLatencyTracker(&tracker);
+    initFramePacer(&pacer, bench.renderer, bench.window, PACE_CAPPED, FPS);
+
+    for (int i = 0; i < BENCH_LOOP_FRAMES; i++) {
+        sendKey(SDL_KEYDOWN, SDL_SCANCODE_UP);
+        InputTick tick;
+        sampleInput(&bench.game.input, SDL_GetTicks(), &tick);
+        latencyTickConsumed(&tracker, &tick);
+
+        benchGameScreen();
+        latencyFramePresented(&tracker);
+        endTextureFrame(&bench.resources.textures);
+        sendKey(SDL_KEYUP, SDL_SCANCODE_UP);
+        endFrame(&pacer);
+    }
+    getLatencyReport(&tracker, latency);
+    getFrameStats(&pacer, frames);
+    printf("\n");
+    printFrameStats(&pacer);
+    printf("Input latency over %d frames: p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           latency->samples, latency->p50, latency->p99, latency->max);
+}
+
+/*
+            SETUP
+*/
+// The game's own init path, on dummy drivers and an offscreen target
+static void initBench() {
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    initSDLSystems();
+
+    bench.window = SDL_CreateWindow("bench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, BENCH_WIDTH, BENCH_HEIGHT, SDL_WINDOW_HIDDEN);
+    checkInit(!bench.window, "Window could not be created!");
+    bench.surface = SDL_CreateRGBSurfaceWithFormat(0, BENCH_WIDTH, BENCH_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    checkInit(!bench.surface, "Could not create the offscreen surface!");
+    bench.renderer = SDL_CreateSoftwareRenderer(bench.surface);
+    checkInit(!bench.renderer, "Software renderer could not be created!");
+
+    GameResources* resources = &bench.resources;
+    memset(resources, 0, sizeof(*resources));
+    resources->windowWidth = BENCH_WIDTH;
+    resources->windowHeight = BENCH_HEIGHT;
+    initGameResources(bench.renderer, resources);
+    initUIElements(&bench.ui, bench.window);
+
+    // Camera centered on the sun, where a game starts
+    resources->bg_x = -BENCH_WIDTH / 2;
+    resources->bg_y = -BENCH_HEIGHT / 2;
+
+    // The default world, whatever the game's command line would change
+    WorldConfig world = {0};
+    initWorldConfig(&world, 0);
+
+    loadGameData(&bench.data);
+    bench.bg_effects = memCalloc(1, sizeof(BackgroundEffects), MEM_WORLD);
+    checkInit(!bench.bg_effects, "Failed to allocate background effects");
+    initWorld(bench.bg_effects, &world);
+
+    srand(BENCH_SEED);
+    generateStarfield(bench.bg_effects);
+    initSolarSystem(bench.bg_effects, &bench.data);
+    initGravityField(bench.bg_effects, GRAVITY_CELL_SIZE, GRAVITY_GRID);
+    initAstralObjects(bench.bg_effects, resources);
+    acquireWorldTextures(bench.bg_effects, resources);
+    initParticleSystem(&bench.bg_effects->particles, bench.renderer);
+
+    initGame(&bench.game, &world);
+    bench.game.screen = GAME;
+    initFighter(&bench.fighter, BENCH_WIDTH, BENCH_HEIGHT);
+    // Out in the dark, between the outer planets. Only the gravity and discovery
+    // benchmarks look at it, the camera stays on the sun.
+    initSimPlayer(&bench.game.player, bench.bg_effects, GRAVITY_FIELD_EXTENT, GRAVITY_FIELD_EXTENT / 2);
+}
+
+// Planets load when they come into view: draw until a frame misses nothing,
+// so every sample (and the counted frame) draws the same thing
+static void loadVisibleTextures() {
+    TextureManager* tm = &bench.resources.textures;
+    for (int i = 0; i < 100; i++) {
+        Uint64 misses = tm->misses;
+        benchGameScreen();
+        endTextureFrame(tm);
+        if (tm->misses == misses) return;
+        while (!assetLoaderDone(&bench.resources.loader)) uploadDecodedAssets(&bench.resources.loader, ASSET_UPLOAD_BUDGET);
+    }
+    printf("Warning: Textures still missing after 100 frames\n");
+}
+
+static void cleanupBench() {
+    destroyParticleSystem(&bench.bg_effects->particles);
+    destroyGravityField(bench.bg_effects);
+    releaseWorldTextures(bench.bg_effects, &bench.resources);
+    destroyWorld(bench.bg_effects);
+    memFree(bench.bg_effects);
+    cleanupGame(&bench.game);
+    cleanupUIElements(&bench.ui);
+    cleanupResources(&bench.resources);
+    SDL_DestroyRenderer(bench.renderer);
+    SDL_FreeSurface(bench.surface);
+    SDL_DestroyWindow(bench.window);
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = BENCH_RESULTS_PATH;
+    int update_budgets = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update-budgets") == 0) update_budgets = 1;
+        else path = argv[i];
+    }
+
+    initBench();
+    loadVisibleTextures();
+
+    // Counted before the timings, generateStarfield replaces the stars
+    benchGameScreen();
+    DrawStats draws = drawStats;
+    DrawBudget budgets[DRAW_PASSES];
+    int over = 0;
+    if (update_budgets) writeDrawBudgets(BENCH_BUDGETS_PATH, &draws);
+    else if (loadDrawBudgets(BENCH_BUDGETS_PATH, budgets)) over = checkDrawBudgets(&draws, budgets);
+
+    const int count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    BenchResult results[BENCH_MAX];
+    printf("\nBenchmarks (%s, software renderer %dx%d)\n", BENCH_REVISION, BENCH_WIDTH, BENCH_HEIGHT);
+    for (int i = 0; i < count && i < BENCH_MAX; i++) runBenchmark(&benchmarks[i], &results[i]);
+    LatencyReport latency;
+    FrameStats frames;
+    runFrameLoop(&latency, &frames);
+    writeResults(path, results, SDL_min(count, BENCH_MAX), &draws, &latency, &frames);
+    int slow = checkTimeBudgets(results, SDL_min(count, BENCH_MAX));
+
+    cleanupBench();
+    printMemoryLeaks();
+
+    if (over > 0) printf("%d passes over their draw budget (%s)\n", over, BENCH_BUDGETS_PATH);
+    if (slow > 0) printf("%d benchmarks over their time budget\n", slow);
+    return over > 0 || slow > 0;
+}
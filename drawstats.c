@@ -0,0 +1,19 @@
+#include "drawstats.h"
+#include <string.h>
+
+DrawStats drawStats;
+
+static const char* passNames[DRAW_PASSES] = { "other", "starfield", "trails", "astral", "solar_system", "sprites", "hud" };
+static const char* callNames[DRAW_CALL_KINDS] = { "copy", "copy_ex", "line", "fill_rect", "geometry", "alpha_mod", "create_texture" };
+
+void resetDrawStats() {
+    memset(&drawStats, 0, sizeof(drawStats));
+}
+
+const char* drawPassName(DrawPass pass) {
+    return pass >= 0 && pass < DRAW_PASSES ? passNames[pass] : "?";
+}
+
+const char* drawCallName(DrawCallKind kind) {
+    return kind >= 0 && kind < DRAW_CALL_KINDS ? callNames[kind] : "?";
+}
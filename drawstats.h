@@ -0,0 +1,142 @@
+#ifndef DRAWSTATS_H
+#define DRAWSTATS_H
+
+#include <SDL2/SDL.h>
+
+/*
+            DEFINITIONS
+*/
+// Where the renderer calls come from. A pass lasts until the function that
+// opened it with DRAW_PASS returns, or until the next setDrawPass.
+typedef enum {
+    DRAW_PASS_OTHER,                 // Menus, loading screen, anything unassigned
+    DRAW_PASS_STARFIELD,
+    DRAW_PASS_TRAILS,
+    DRAW_PASS_ASTRAL,
+    DRAW_PASS_SOLAR_SYSTEM,
+    DRAW_PASS_SPRITES,               // Particles, thrusters, fighter, bullets
+    DRAW_PASS_HUD,
+    DRAW_PASSES
+} DrawPass;
+
+typedef enum {
+    DRAW_COPY,
+    DRAW_COPY_EX,
+    DRAW_LINE,
+    DRAW_FILL_RECT,
+    DRAW_GEOMETRY,
+    DRAW_ALPHA_MOD,                  // State changes and creations, not draws
+    DRAW_CREATE_TEXTURE,
+    DRAW_CALL_KINDS
+} DrawCallKind;
+
+#define DRAW_FIRST_STATE DRAW_ALPHA_MOD   // Kinds from here on are not draw calls
+
+/*
+            DRAW STATISTICS STRUCTURES
+*/
+typedef struct {
+    int calls[DRAW_CALL_KINDS];
+    int draw_calls;                  // Copies, lines, fills and geometry batches
+    int texture_switches;            // Textured draws with another texture than the last one
+} PassStats;
+
+// What the current frame sent to the renderer, cleared by renderGameScreen
+typedef struct {
+    PassStats passes[DRAW_PASSES];
+    DrawPass pass;
+    SDL_Texture* last_texture;
+
+    int draw_calls;                  // All passes
+    int stars_drawn, stars_total;
+    int objects_drawn, objects_total;
+    float render_ms;                 // renderGameScreen up to the present
+} DrawStats;
+
+extern DrawStats drawStats;
+
+#define DRAW_PASS(pass) DrawPass draw_pass_ __attribute__((cleanup(restoreDrawPass))) = setDrawPass(pass)
+
+
+/*
+            DECLARATIONS
+*/
+void resetDrawStats();
+const char* drawPassName(DrawPass pass);
+const char* drawCallName(DrawCallKind kind);
+
+// Returns the pass it replaces
+static inline DrawPass setDrawPass(DrawPass pass) {
+    DrawPass previous = drawStats.pass;
+    drawStats.pass = pass;
+    return previous;
+}
+
+static inline void restoreDrawPass(DrawPass* previous) {
+    drawStats.pass = *previous;
+}
+
+static inline void countDrawCall(DrawCallKind kind, SDL_Texture* texture) {
+    PassStats* pass = &drawStats.passes[drawStats.pass];
+    pass->calls[kind]++;
+    if (kind >= DRAW_FIRST_STATE) return;
+
+    pass->draw_calls++;
+    drawStats.draw_calls++;
+    if (texture && texture != drawStats.last_texture) {
+        pass->texture_switches++;
+        drawStats.last_texture = texture;
+    }
+}
+
+// render.c and particles.c define DRAWSTATS_COUNT before including this:
+// their renderer calls then go through the counters. Everything else (the
+// overlay itself) calls SDL directly and is not counted.
+#ifdef DRAWSTATS_COUNT
+static inline int countedRenderCopy(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst) {
+    countDrawCall(DRAW_COPY, texture);
+    return SDL_RenderCopy(renderer, texture, src, dst);
+}
+
+static inline int countedRenderCopyEx(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+                                      double angle, const SDL_Point* center, SDL_RendererFlip flip) {
+    countDrawCall(DRAW_COPY_EX, texture);
+    return SDL_RenderCopyEx(renderer, texture, src, dst, angle, center, flip);
+}
+
+static inline int countedRenderDrawLine(SDL_Renderer* renderer, int x1, int y1, int x2, int y2) {
+    countDrawCall(DRAW_LINE, NULL);
+    return SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
+}
+
+static inline int countedRenderFillRect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+    countDrawCall(DRAW_FILL_RECT, NULL);
+    return SDL_RenderFillRect(renderer, rect);
+}
+
+static inline int countedRenderGeometry(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Vertex* vertices, int num_vertices,
+                                        const int* indices, int num_indices) {
+    countDrawCall(DRAW_GEOMETRY, texture);
+    return SDL_RenderGeometry(renderer, texture, vertices, num_vertices, indices, num_indices);
+}
+
+static inline int countedSetTextureAlphaMod(SDL_Texture* texture, Uint8 alpha) {
+    countDrawCall(DRAW_ALPHA_MOD, texture);
+    return SDL_SetTextureAlphaMod(texture, alpha);
+}
+
+static inline SDL_Texture* countedCreateTextureFromSurface(SDL_Renderer* renderer, SDL_Surface* surface) {
+    countDrawCall(DRAW_CREATE_TEXTURE, NULL);
+    return SDL_CreateTextureFromSurface(renderer, surface);
+}
+
+#define SDL_RenderCopy countedRenderCopy
+#define SDL_RenderCopyEx countedRenderCopyEx
+#define SDL_RenderDrawLine countedRenderDrawLine
+#define SDL_RenderFillRect countedRenderFillRect
+#define SDL_RenderGeometry countedRenderGeometry
+#define SDL_SetTextureAlphaMod countedSetTextureAlphaMod
+#define SDL_CreateTextureFromSurface countedCreateTextureFromSurface
+#endif
+
+#endif
@@ -1,143 +1,74 @@
 #include "game.h"
 #include "init.h"  // For GameResources
 #include "sounds.h"
+#include "profiler.h"
+#include "netgame.h"
 #include <math.h>
 #include <stdio.h>
 #include <SDL2/SDL_mixer.h>
 
+// The client side of a tick: steps the player with the controls of this
+// frame, then adds what the rules leave out (camera, exhaust, bursts, sounds)
 void updateGameState(Game* game, Fighter* fighter, GameResources* resources, BackgroundEffects* bg_effects) {
+    PROFILE_FUNCTION();
     if (game->screen == GAME) {
-        /*
-        // Move bullets
-        for (int i = 0; i < game->numBullets; i++) {
-            game->bullets[i].x += 7; // Move bullet 1 pixel to the right
-
-            // Remove bullets that move off-screen
-            if (game->bullets[i].x > resources->windowWidth) {
-                for (int j = i; j < game->numBullets - 1; j++) {
-                    game->bullets[j] = game->bullets[j + 1];
-                }
-                game->numBullets--;
-                i--; // Recheck the current index
-            }
+        // Move bullets 7 px per frame to the right. One that leaves the screen
+        // takes the last one's slot, the order does not matter.
+        for (int i = 0; i < game->numBullets; ) {
+            game->bullets[i].x += 7;
+            if (game->bullets[i].x > resources->windowWidth) game->bullets[i] = game->bullets[--game->numBullets];
+            else i++;
         }
-        */
-
-        // Apply speed limit after all movement calculations
-        limitFighterSpeed(fighter, FIGHTER_MAX_SPEED);
 
         updateSolarSystem(bg_effects);
-        
-        // calculateGravityForces(fighter, bg_effects, resources);
 
-        // Update background position
-        resources->bg_x += fighter->speed_x;
-        resources->bg_y += fighter->speed_y;
+        // Online the server has the last word, the tick is a prediction
+        SimEvents events;
+        if (game->net) stepNetClient(game->net, &game->player, &game->controls, &events);
+        else stepSimPlayer(&game->player, &game->controls, bg_effects, &events);
+        followPlayer(resources, fighter, &game->player);
+        updateThruster(&fighter->thruster, game->player.thrusting);
 
-        // Check for astral object discovery
-        if (!game->objectivesFinished) {
-            int new_discoveries = checkAstralObjectDiscovery(fighter, bg_effects, resources, game);
-            
-            if (new_discoveries > 0) {
-                // Add score or other rewards for discovery
-                game->score += new_discoveries * 100;
-                
-                if (resources->discoverySound) {
-                    playSound(resources->discoverySound, resources); // Medium volume
-                }
-            }
-            
-            // Update fighter rectangle
-            fighter->rect = (SDL_Rect){ fighter->x, fighter->y, FIGHTER_WIDTH, FIGHTER_HEIGHT };
+        // Exhaust is spawned before the update so it starts moving this frame
+        if (fighter->thruster.is_visible) {
+            emitThrusterParticles(fighter, &game->player, &bg_effects->particles);
         }
-    }
-}
-
-void updateSolarSystem(BackgroundEffects* bg_effects) {
-    for (int i = 0; i < NUM_PLANETS; i++) {
-        Planet* planet = &bg_effects->planets[i];
+        updateParticles(&bg_effects->particles, 1.0f / FPS);
 
-        // Skip the sun (index 0) as it's stationary
-        if (i > 0) {
-            // Update orbit angle
-            planet->orbit_angle += planet->orbit_speed * SPEED_MULTIPLICATOR;
-            if (planet->orbit_angle > 2 * M_PI) {
-                planet->orbit_angle -= 2 * M_PI;
-            }
-        }
+        playSimEvents(&events, &game->player, bg_effects, resources);
 
-        // Update world position (sun at 0,0, planets orbit around it)
-        if (i == 0) {
-            planet->world_pos.x = 0;
-            planet->world_pos.y = 0;
-        } else {
-            planet->world_pos.x = cos(planet->orbit_angle) * planet->orbit_radius;
-            planet->world_pos.y = sin(planet->orbit_angle) * planet->orbit_radius;
-        }
+        // Update fighter rectangle
+        fighter->rect = (SDL_Rect){ fighter->x, fighter->y, FIGHTER_WIDTH, FIGHTER_HEIGHT };
+    } else if (game->net) {
+        pollNetClient(game->net, &game->player);
     }
 }
 
-// Helper function to find the shortest rotation direction movement direction and facing direction of the fighter
-int getShortestRotationDirection(Fighter* fighter) {
-    int currentAngle = fighter->angle;
-    int targetAngle = ((int) getFighterMovementDirection(fighter) + 180) % 360; // [0, 360]
-    
-    currentAngle = currentAngle % 360; // [-360, 360]
-    if (currentAngle < 0) currentAngle += 360; // [0, 360]
-
-    if (abs(currentAngle - targetAngle) < ANGLES_PER_FRAME + 0.01f) {
-        fighter->angle = targetAngle;
-        if (getFighterMovementSpeed(fighter) < 0.2) {
-            fighter->speed_x = 0;
-            fighter->speed_y = 0;
-            return DO_NOTHING;
-        } else {
-            return THRUST;
-        }
-    } else if (currentAngle < targetAngle) {
-        return abs(targetAngle - currentAngle) < 180 ? TURN_RIGHT : TURN_LEFT;
-    } else { // reverse direction if fighter angle > target angle
-        return abs(targetAngle - currentAngle) < 180 ? TURN_LEFT : TURN_RIGHT;
-    }
+// The fighter stays where it is on screen, the background scrolls under it
+void followPlayer(GameResources* resources, const Fighter* fighter, const SimPlayer* player) {
+    resources->bg_x = player->x - (fighter->x + fighter->rect.w / 2);
+    resources->bg_y = player->y - (fighter->y + fighter->rect.h / 2);
 }
 
-// Calculate the direction (angle) the fighter is moving based on velocity
-float getFighterMovementDirection(Fighter* fighter) {
-    // If the fighter is not moving, return current angle
-    if (fabs(fighter->speed_x) < 0.01f && fabs(fighter->speed_y) < 0.01f) {
-        return fighter->angle - 180;
+// Bursts and sounds for what the tick discovered
+void playSimEvents(const SimEvents* events, const SimPlayer* player, BackgroundEffects* bg_effects, GameResources* resources) {
+    // Burst colored by object type
+    const SDL_Color burst_colors[ASTRAL_TYPES] = {
+        {150, 200, 255, 255}, {200, 120, 255, 255}, {255, 200, 120, 255}, {120, 255, 200, 255}
+    };
+    for (int i = 0; i < events->num_discovered; i++) {
+        const AstralObject* obj = &bg_effects->astral_objects[events->discovered[i]];
+        float x = obj->world_position.x + (int)(obj->w * obj->scale / 10) / 2;
+        float y = obj->world_position.y + (int)(obj->h * obj->scale / 10) / 2;
+        emitParticleBurst(&bg_effects->particles, x, y, 400, 220.0f, 1.5f, burst_colors[obj->texture_index]);
+        playSoundAt(resources, resources->discoverySfx, x, y);
     }
-    
-    // Calculate angle from velocity vector using atan2
-    // atan2(y, x) gives angle in radians, convert to degrees
-    float direction = atan2f(fighter->speed_y, fighter->speed_x) * (180.0f / M_PI) +90;
-    
-    // Convert from [-180, 180] range to [0, 360] range
-    if (direction < 0) {
-        direction += 360;
-    }
-    // printf("target angle: %f\n", direction);
-    return direction;
-}
-
-/*
-atan2: 
-         270°
-    180°      0°
-          90°
 
-my system:
-          0°
-    270°      90°
-         180°
-
-so +90°
-*/
-
-// out: speed > 0
-float getFighterMovementSpeed(Fighter* fighter) {
-    float sqrSpeed = fighter->speed_x*fighter->speed_x + fighter->speed_y*fighter->speed_y;
-    return sqrtf(sqrSpeed);
+    if (events->finished) {
+        emitParticleBurst(&bg_effects->particles, player->x, player->y, 5000, 600.0f, 3.0f, (SDL_Color){255, 230, 0, 255});
+        if (rand()%3 < 2) playSound(resources, resources->aceSfx);
+        else              playSound(resources, resources->wowSfx);
+    }
 }
 
 void updateThruster(ThrusterState* thruster, int is_thrusting) {
@@ -158,104 +89,28 @@ void updateThruster(ThrusterState* thruster, int is_thrusting) {
     }
 }
 
-void limitFighterSpeed(Fighter* fighter, float max_speed) {
-    float current_speed = getFighterMovementSpeed(fighter);
-    
-    if (current_speed > max_speed) {
-        // Normalize the velocity vector and scale to max speed
-        float ratio = max_speed / current_speed;
-        fighter->speed_x *= ratio;
-        fighter->speed_y *= ratio;
-    }
-}
-
-void calculateGravityForces(Fighter* fighter, BackgroundEffects* bg_effects, GameResources* resources) {
-    const float G = 6.67e-11;
-    
-    // Reset acceleration
-    float accel_x = 0;
-    float accel_y = 0;
-    
-    // Fighter position in world coordinates
-    float fighter_x = resources->bg_x + fighter->x + fighter->rect.w / 2;
-    float fighter_y = resources->bg_y + fighter->y + fighter->rect.h / 2;
-    
-    for (int i = 0; i < NUM_PLANETS; i++) {
-        Planet* planet = &bg_effects->planets[i];
-        
-        // Calculate distance between fighter and planet
-        float dx = planet->world_pos.x - fighter_x;
-        float dy = planet->world_pos.y - fighter_y;
-        float distance_squared = dx * dx + dy * dy;
-        float distance = sqrtf(distance_squared);
-        float force_magnitude, acceleration;
-        
-        // sun: 4000/27.4 = 146.00
-        if (distance < 146*planet->mass) {
-            distance = sqrtf(distance_squared + 200*200); // softening
-
-            // Calculate gravitational force (F = G * m1 * m2 / r²)
-            force_magnitude = (G * planet->mass * FIGHTER_MASS) / distance_squared /5;
-            
-            // Convert force to acceleration (a = F / m)
-            acceleration = force_magnitude / FIGHTER_MASS;
-            
-            // Normalize direction vector and apply acceleration
-            accel_x += (dx / distance) * acceleration * GRAVITY_FACTOR;
-            accel_y += (dy / distance) * acceleration * GRAVITY_FACTOR;
-
-            if (distance < 0.05*planet->mass) break; // ignore other plantes gravity if close to the center
-        }
+void emitThrusterParticles(const Fighter* fighter, const SimPlayer* player, ParticleSystem* particles) {
+    float rad_angle = player->angle * M_PI / 180.0f;
+    float cos_a = cos(rad_angle);
+    float sin_a = sin(rad_angle);
+
+    // Ship center in world coordinates
+    float center_x = player->x;
+    float center_y = player->y;
+
+    // Exhaust leaves opposite to the nose, inheriting the ship velocity (px/frame -> px/s)
+    float direction = atan2f(cos_a, -sin_a);
+    float base_vx = player->speed_x * FPS;
+    float base_vy = player->speed_y * FPS;
+    SDL_Color exhaust = {255, 140, 40, 255};
+
+    SDL_Point offsets[2] = {fighter->thruster.left_offset, fighter->thruster.right_offset};
+    for (int i = 0; i < 2; i++) {
+        // Same rotation as renderSingleThruster
+        float x = center_x + offsets[i].x * cos_a - offsets[i].y * sin_a;
+        float y = center_y + offsets[i].x * sin_a + offsets[i].y * cos_a;
+
+        emitParticleCone(particles, x, y, base_vx, base_vy, direction, 0.25f,
+                         EXHAUST_SPEED, EXHAUST_PARTICLES_PER_FRAME / 2, 0.35f, 4.0f, exhaust);
     }
-
-    // Apply acceleration to fighter velocity
-    fighter->speed_x += accel_x;
-    fighter->speed_y += accel_y;
 }
-
-int checkAstralObjectDiscovery(Fighter* fighter, BackgroundEffects* bg_effects, GameResources* resources, Game* game) {
-    int new_discoveries = 0;
-    
-    // Fighter center in world coordinates
-    float fighter_center_x = resources->bg_x + fighter->x + fighter->rect.w / 2;
-    float fighter_center_y = resources->bg_y + fighter->y + fighter->rect.h / 2;
-    
-    for (int i = 0; i < TOTAL_ASTRAL_OBJECTS; i++) {
-        AstralObject* obj = &bg_effects->astral_objects[i];
-
-        // Skip already discovered objects
-        if (obj->discovered) continue;
-
-        int scaled_w = obj->w * obj->scale /10;
-        int scaled_h = obj->h * obj->scale /10;
-        
-        // Calculate distance between centers
-        float dx = obj->world_position.x + scaled_w/2 - fighter_center_x;
-        float dy = obj->world_position.y + scaled_h/2 - fighter_center_y;
-        float distance = sqrtf(dx * dx + dy * dy);
-        
-        // Check if fighter is close enough (within 100px)
-        if (distance < fminf(obj->w, obj->h) * obj->scale * 0.8f /10) {
-            // Mark as discovered and update scores
-            obj->discovered = 1;
-            int type = obj->texture_index;
-            
-            game->discovery.discovered_count[type]++;
-            game->discovery.total_score[type] += obj->score_value;
-            game->discovery.total_discovered++;
-            game->discovery.total_score_earned += obj->score_value;
-            game->score += obj->score_value;
-            
-            new_discoveries++;
-        }
-    }
-
-    if (game->discovery.total_discovered == TOTAL_ASTRAL_OBJECTS) {
-        if (rand()%3 < 2) playSound(resources->aceSound, resources);
-        else              playSound(resources->wowSound, resources);
-        game->objectivesFinished = 1;
-    }
-    
-    return new_discoveries;
-}
-
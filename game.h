@@ -4,23 +4,17 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include "init.h"
+#include "sim.h"
 
-#define ANGLES_PER_FRAME 5
-#define SPEED_MULTIPLICATOR 0.00008
-
-enum {TURN_LEFT, TURN_RIGHT, THRUST, DO_NOTHING};
+#define EXHAUST_PARTICLES_PER_FRAME 6
+#define EXHAUST_SPEED 260.0f
 
 // Function declarations
 void updateGameState(Game* game, Fighter* fighter, GameResources* resources, BackgroundEffects* bg_effects);
 //int addBullets(SDL_Rect* bullets, SDL_Rect spaceshipRect, int numBullets, int shipLevel);
-void updateSolarSystem(BackgroundEffects* bg_effects);
+void followPlayer(GameResources* resources, const Fighter* fighter, const SimPlayer* player);
 void updateThruster(ThrusterState* thruster, int is_thrusting);
+void emitThrusterParticles(const Fighter* fighter, const SimPlayer* player, ParticleSystem* particles);
+void playSimEvents(const SimEvents* events, const SimPlayer* player, BackgroundEffects* bg_effects, GameResources* resources);
 
-int getShortestRotationDirection(Fighter* fighter);
-float getFighterMovementDirection(Fighter* fighter);
-float getFighterMovementSpeed(Fighter* fighter);
-void limitFighterSpeed(Fighter* fighter, float max_speed);
-void calculateGravityForces(Fighter* fighter, BackgroundEffects* bg_effects, GameResources* resources);
-int checkAstralObjectDiscovery(Fighter* fighter, BackgroundEffects* bg_effects, GameResources* resources, Game* game);
-
-#endif
\ No newline at end of file
+#endif
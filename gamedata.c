@@ -0,0 +1,339 @@
+#include "gamedata.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define DATA_MAX_TOKENS 40
+
+static const char* dataSources[DATA_SOURCES] = {
+    DATA_PHYSICS_PATH, DATA_SHIPS_PATH, DATA_HITBOXES_PATH, DATA_LEVEL_PATH
+};
+
+static DataSourceStamp stampSource(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) return (DataSourceStamp){ 0, 0, -1 };
+    return (DataSourceStamp){ (long long)st.st_mtim.tv_sec, (long long)st.st_mtim.tv_nsec, (long long)st.st_size };
+}
+
+// Cuts the line at '#' and splits it on whitespace, returns the token count
+static int splitLine(char* line, char* tokens[], int max_tokens) {
+    line[strcspn(line, "#\r\n")] = '\0';
+
+    int count = 0;
+    for (char* token = strtok(line, " \t"); token && count < max_tokens; token = strtok(NULL, " \t")) {
+        tokens[count++] = token;
+    }
+    return count;
+}
+
+// "N/A" reads as 0
+static int parseFloat(const char* text, float* out) {
+    if (strcmp(text, "N/A") == 0) {
+        *out = 0.0f;
+        return 1;
+    }
+
+    char* end;
+    *out = strtof(text, &end);
+    return end != text && *end == '\0';
+}
+
+static void copyName(char* dst, const char* src) {
+    strncpy(dst, src, DATA_NAME_LENGTH - 1);
+    dst[DATA_NAME_LENGTH - 1] = '\0';
+}
+
+static BodyRecord* findOrAddBody(GameData* data, const char* name) {
+    for (int i = 0; i < data->num_bodies; i++) {
+        if (strcmp(data->bodies[i].name, name) == 0) return &data->bodies[i];
+    }
+    if (data->num_bodies == DATA_MAX_BODIES) return NULL;
+
+    BodyRecord* body = &data->bodies[data->num_bodies++];
+    copyName(body->name, name);
+    copyName(body->label, name);
+    return body;
+}
+
+/*
+    physics.info: a table (header row, one row per body) ended by a blank line,
+    free-form notes, then a "[game]" section with the in-game values:
+        name label orbit_radius start_angle orbit_speed width mass
+*/
+static void parsePhysics(GameData* data, FILE* file) {
+    enum { TABLE_HEADER, TABLE, NOTES, GAME } section = TABLE_HEADER;
+    char line[512];
+    int line_number = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* tokens[DATA_MAX_TOKENS];
+        int count = splitLine(line, tokens, DATA_MAX_TOKENS);
+
+        if (count == 1 && strcmp(tokens[0], "[game]") == 0) {
+            section = GAME;
+            continue;
+        }
+        if (section == TABLE_HEADER) {
+            if (count > 0) section = TABLE;
+            continue;
+        }
+        if (section == TABLE && count == 0) {
+            section = NOTES;
+            continue;
+        }
+        if (section == NOTES || count == 0) continue;
+
+        if (section == TABLE) {
+            BodyRecord* body = count == 4 + PHYSICS_SCALED_DIAMETERS + 1 ? findOrAddBody(data, tokens[0]) : NULL;
+            int ok = body != NULL;
+            if (ok) {
+                ok &= parseFloat(tokens[1], &body->diameter);
+                ok &= parseFloat(tokens[2], &body->speed);
+                ok &= parseFloat(tokens[3], &body->relative_speed);
+                for (int i = 0; i < PHYSICS_SCALED_DIAMETERS; i++) ok &= parseFloat(tokens[4 + i], &body->scaled_diameter[i]);
+                ok &= parseFloat(tokens[4 + PHYSICS_SCALED_DIAMETERS], &body->surface_gravity);
+            }
+            if (!ok) printf("Warning: %s:%d: bad body row\n", DATA_PHYSICS_PATH, line_number);
+        } else {
+            BodyRecord* body = count == 7 ? findOrAddBody(data, tokens[0]) : NULL;
+            int ok = body != NULL && !body->in_game;
+            if (ok) {
+                copyName(body->label, tokens[1]);
+                ok &= parseFloat(tokens[2], &body->orbit_radius);
+                ok &= parseFloat(tokens[3], &body->start_angle);
+                ok &= parseFloat(tokens[4], &body->orbit_speed);
+                ok &= parseFloat(tokens[5], &body->width);
+                ok &= parseFloat(tokens[6], &body->mass);
+            }
+            if (ok) {
+                body->in_game = 1;
+                data->game_bodies[data->num_game_bodies++] = body - data->bodies;
+            } else {
+                printf("Warning: %s:%d: bad [game] row\n", DATA_PHYSICS_PATH, line_number);
+            }
+        }
+    }
+}
+
+/*
+    ships.data: "ship:" opens a ship, each following indented line is one level:
+        bullet_name size damage xpos ypos xspeed yspeed
+*/
+static void parseShips(GameData* data, FILE* file) {
+    char line[512];
+    char ship[DATA_NAME_LENGTH] = "";
+    int level = 0;
+    int line_number = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* tokens[DATA_MAX_TOKENS];
+        int count = splitLine(line, tokens, DATA_MAX_TOKENS);
+        if (count == 0) continue;
+
+        size_t length = strlen(tokens[0]);
+        if (count == 1 && tokens[0][length - 1] == ':') {
+            tokens[0][length - 1] = '\0';
+            copyName(ship, tokens[0]);
+            level = 0;
+            continue;
+        }
+
+        int ok = count == 7 && ship[0] != '\0' && data->num_guns < DATA_MAX_GUNS;
+        ShipGun* gun = &data->guns[data->num_guns];
+        if (ok) {
+            memset(gun, 0, sizeof(*gun));
+            copyName(gun->ship, ship);
+            copyName(gun->bullet, tokens[0]);
+            gun->level = level;
+            ok &= parseFloat(tokens[1], &gun->size);
+            ok &= parseFloat(tokens[2], &gun->damage);
+            ok &= parseFloat(tokens[3], &gun->x);
+            ok &= parseFloat(tokens[4], &gun->y);
+            ok &= parseFloat(tokens[5], &gun->speed_x);
+            ok &= parseFloat(tokens[6], &gun->speed_y);
+        }
+        if (ok) {
+            data->num_guns++;
+            level++;
+        } else {
+            printf("Warning: %s:%d: bad ship line\n", DATA_SHIPS_PATH, line_number);
+        }
+    }
+}
+
+/*
+    hitboxes.data, coordinates relative to the sprite:
+        object_id circle x_center y_center radius
+        object_id poly x1 y1 x2 y2 ...
+*/
+static void parseHitboxes(GameData* data, FILE* file) {
+    char line[1024];
+    int line_number = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* tokens[DATA_MAX_TOKENS];
+        int count = splitLine(line, tokens, DATA_MAX_TOKENS);
+        if (count == 0) continue;
+
+        int ok = count >= 2 && data->num_hitboxes < DATA_MAX_HITBOXES;
+        Hitbox* hitbox = &data->hitboxes[data->num_hitboxes];
+        if (ok) {
+            memset(hitbox, 0, sizeof(*hitbox));
+            copyName(hitbox->name, tokens[0]);
+
+            int values = count - 2;
+            if (strcmp(tokens[1], "circle") == 0 && values == 3) {
+                hitbox->type = HITBOX_CIRCLE;
+                hitbox->num_points = 1;
+                ok &= parseFloat(tokens[4], &hitbox->radius);
+            } else if (strcmp(tokens[1], "poly") == 0 && values >= 6 && values % 2 == 0 && values <= HITBOX_MAX_POINTS * 2) {
+                hitbox->type = HITBOX_POLY;
+                hitbox->num_points = values / 2;
+            } else {
+                ok = 0;
+            }
+            for (int i = 0; ok && i < hitbox->num_points * 2; i++) {
+                ok &= parseFloat(tokens[2 + i], &hitbox->points[i]);
+            }
+        }
+        if (ok) data->num_hitboxes++;
+        else printf("Warning: %s:%d: bad hitbox\n", DATA_HITBOXES_PATH, line_number);
+    }
+}
+
+/*
+    level1.data:
+        spawn_time object_id x y speed
+*/
+static void parseLevel(GameData* data, FILE* file) {
+    char line[512];
+    int line_number = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* tokens[DATA_MAX_TOKENS];
+        int count = splitLine(line, tokens, DATA_MAX_TOKENS);
+        if (count == 0) continue;
+
+        int ok = count == 5 && data->num_spawns < DATA_MAX_SPAWNS;
+        LevelSpawn* spawn = &data->spawns[data->num_spawns];
+        if (ok) {
+            memset(spawn, 0, sizeof(*spawn));
+            copyName(spawn->object, tokens[1]);
+            ok &= parseFloat(tokens[0], &spawn->time);
+            ok &= parseFloat(tokens[2], &spawn->x);
+            ok &= parseFloat(tokens[3], &spawn->y);
+            ok &= parseFloat(tokens[4], &spawn->speed);
+        }
+        if (ok) data->num_spawns++;
+        else printf("Warning: %s:%d: bad spawn\n", DATA_LEVEL_PATH, line_number);
+    }
+}
+
+// Parses every text source into data. Missing files leave their table empty.
+int compileGameData(GameData* data) {
+    static void (*const parsers[DATA_SOURCES])(GameData*, FILE*) = {
+        parsePhysics, parseShips, parseHitboxes, parseLevel
+    };
+
+    memset(data, 0, sizeof(*data));
+    memcpy(data->header.magic, DATA_MAGIC, 4);
+    data->header.version = DATA_VERSION;
+    data->header.struct_size = sizeof(GameData);
+
+    for (int i = 0; i < DATA_SOURCES; i++) {
+        // Stamp before reading, so an edit during the parse triggers another rebuild
+        data->header.sources[i] = stampSource(dataSources[i]);
+
+        FILE* file = fopen(dataSources[i], "r");
+        if (!file) {
+            printf("Warning: Missing data file %s\n", dataSources[i]);
+            continue;
+        }
+        parsers[i](data, file);
+        fclose(file);
+    }
+    return 1;
+}
+
+// Written to a temporary file first so a crash never leaves half a cache
+int writeGameDataCache(GameData* data, const char* path) {
+    char temp_path[256];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) return 0;
+
+    int ok = fwrite(data, sizeof(*data), 1, file) == 1;
+    ok &= fclose(file) == 0;
+    if (ok) ok = rename(temp_path, path) == 0;
+    if (!ok) remove(temp_path);
+    return ok;
+}
+
+static int readGameDataCache(GameData* data, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+
+    int ok = fread(data, sizeof(*data), 1, file) == 1;
+    fclose(file);
+
+    ok = ok && memcmp(data->header.magic, DATA_MAGIC, 4) == 0
+            && data->header.version == DATA_VERSION
+            && data->header.struct_size == (int)sizeof(GameData);
+
+    for (int i = 0; ok && i < DATA_SOURCES; i++) {
+        DataSourceStamp stamp = stampSource(dataSources[i]);
+        const DataSourceStamp* cached = &data->header.sources[i];
+        ok = stamp.mtime == cached->mtime && stamp.mtime_ns == cached->mtime_ns && stamp.size == cached->size;
+    }
+    return ok;
+}
+
+// Loads the binary cache, recompiling it from the text sources when stale
+int loadGameData(GameData* data) {
+    if (readGameDataCache(data, DATA_CACHE_PATH)) {
+        printf("Game data: %d bodies, %d guns, %d hitboxes, %d spawns (cache)\n",
+               data->num_bodies, data->num_guns, data->num_hitboxes, data->num_spawns);
+        return 1;
+    }
+
+    compileGameData(data);
+    if (!writeGameDataCache(data, DATA_CACHE_PATH)) {
+        printf("Warning: Could not write %s\n", DATA_CACHE_PATH);
+    }
+    printf("Game data: %d bodies, %d guns, %d hitboxes, %d spawns (compiled)\n",
+           data->num_bodies, data->num_guns, data->num_hitboxes, data->num_spawns);
+    return 1;
+}
+
+// index-th body of the [game] section (0 is the sun)
+const BodyRecord* gameBody(const GameData* data, int index) {
+    if (index < 0 || index >= data->num_game_bodies) return NULL;
+    return &data->bodies[data->game_bodies[index]];
+}
+
+const BodyRecord* findBody(const GameData* data, const char* name) {
+    for (int i = 0; i < data->num_bodies; i++) {
+        if (strcmp(data->bodies[i].name, name) == 0) return &data->bodies[i];
+    }
+    return NULL;
+}
+
+const ShipGun* findShipGun(const GameData* data, const char* ship, int level) {
+    for (int i = 0; i < data->num_guns; i++) {
+        if (data->guns[i].level == level && strcmp(data->guns[i].ship, ship) == 0) return &data->guns[i];
+    }
+    return NULL;
+}
+
+const Hitbox* findHitbox(const GameData* data, const char* name) {
+    for (int i = 0; i < data->num_hitboxes; i++) {
+        if (strcmp(data->hitboxes[i].name, name) == 0) return &data->hitboxes[i];
+    }
+    return NULL;
+}
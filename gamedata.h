@@ -0,0 +1,128 @@
+#ifndef GAMEDATA_H
+#define GAMEDATA_H
+
+/*
+            DEFINITIONS
+*/
+// Text sources (hand-written) and the binary cache built from them.
+// The cache is the GameData struct written as-is: one fread loads it, and it
+// is rebuilt whenever a source's mtime or size no longer matches the header.
+#define DATA_PHYSICS_PATH "data/physics.info"
+#define DATA_SHIPS_PATH "data/ships.data"
+#define DATA_HITBOXES_PATH "data/hitboxes.data"
+#define DATA_LEVEL_PATH "data/level1.data"
+#define DATA_CACHE_PATH "data/gamedata.cache"
+
+#define DATA_MAGIC "FDAT"
+#define DATA_VERSION 2
+#define DATA_SOURCES 4
+
+#define DATA_NAME_LENGTH 24
+#define DATA_MAX_BODIES 16
+#define DATA_MAX_GUNS 64
+#define DATA_MAX_HITBOXES 64
+#define DATA_MAX_SPAWNS 256
+#define HITBOX_MAX_POINTS 16
+#define PHYSICS_SCALED_DIAMETERS 5
+
+typedef enum {
+    HITBOX_CIRCLE,   // points[0..1] center, radius
+    HITBOX_POLY      // num_points (x, y) pairs
+} HitboxType;
+
+/*
+            TABLE RECORDS
+*/
+// One row of physics.info: real values, the scaled diameters tried so far,
+// and the in-game parameters from its [game] section
+typedef struct {
+    char name[DATA_NAME_LENGTH];         // Key (english, lowercase)
+    char label[DATA_NAME_LENGTH];        // Displayed name
+    float diameter;                      // km
+    float speed;                         // km/s (0: N/A)
+    float relative_speed;
+    float scaled_diameter[PHYSICS_SCALED_DIAMETERS];
+    float surface_gravity;               // m/s²
+
+    int in_game;                         // Listed in the [game] section
+    float orbit_radius;                  // px from the sun
+    float start_angle;                   // radians
+    float orbit_speed;
+    float width;                         // Sprite width before the /10 render scale
+    float mass;                          // Gravity strength
+} BodyRecord;
+
+// One upgrade level of a ship's gun (ships.data)
+typedef struct {
+    char ship[DATA_NAME_LENGTH];
+    int level;                           // 0 for the first line under the ship
+    char bullet[DATA_NAME_LENGTH];
+    float size;
+    float damage;
+    float x, y;                          // Muzzle offset
+    float speed_x, speed_y;
+} ShipGun;
+
+// Collision shape, coordinates are relative to the sprite size (hitboxes.data)
+typedef struct {
+    char name[DATA_NAME_LENGTH];
+    HitboxType type;
+    int num_points;
+    float points[HITBOX_MAX_POINTS * 2];
+    float radius;
+} Hitbox;
+
+// Level script entry (level1.data)
+typedef struct {
+    float time;                          // Seconds after the level starts
+    char object[DATA_NAME_LENGTH];
+    float x, y;
+    float speed;
+} LevelSpawn;
+
+typedef struct {
+    long long mtime;
+    long long mtime_ns;                  // An edit in the same second as the cache must still show
+    long long size;                      // -1: file missing
+} DataSourceStamp;
+
+typedef struct {
+    char magic[4];
+    int version;
+    int struct_size;                     // sizeof(GameData) that wrote the cache
+    DataSourceStamp sources[DATA_SOURCES];
+} GameDataHeader;
+
+// Fixed layout, no pointers: the cache is a raw copy of this struct
+typedef struct {
+    GameDataHeader header;
+
+    BodyRecord bodies[DATA_MAX_BODIES];
+    int num_bodies;
+    int game_bodies[DATA_MAX_BODIES];    // Indices into bodies, [game] section order (sun first)
+    int num_game_bodies;
+
+    ShipGun guns[DATA_MAX_GUNS];
+    int num_guns;
+
+    Hitbox hitboxes[DATA_MAX_HITBOXES];
+    int num_hitboxes;
+
+    LevelSpawn spawns[DATA_MAX_SPAWNS];
+    int num_spawns;
+} GameData;
+
+
+/*
+            DECLARATIONS
+*/
+int loadGameData(GameData* data);
+int compileGameData(GameData* data);
+int writeGameDataCache(GameData* data, const char* path);
+
+const BodyRecord* gameBody(const GameData* data, int index);
+const BodyRecord* findBody(const GameData* data, const char* name);
+const ShipGun* findShipGun(const GameData* data, const char* ship, int level);
+const Hitbox* findHitbox(const GameData* data, const char* name);
+
+#endif
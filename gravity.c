@@ -0,0 +1,323 @@
+#include "gravity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// --gravity[=exact|grid|validate] puts gravity in the rules, the grid when no
+// mode is given. --gravity-cell=px sets the grid accuracy. Returns 1 if arg
+// was one of them.
+int parseGravityArgument(const char* arg, WorldConfig* config) {
+    if (strcmp(arg, "--gravity") == 0) {
+        config->gravity = GRAVITY_GRID;
+        return 1;
+    }
+    if (strncmp(arg, "--gravity=", 10) == 0) {
+        const char* mode = arg + 10;
+        if (strcmp(mode, "exact") == 0) config->gravity = GRAVITY_EXACT;
+        else if (strcmp(mode, "grid") == 0) config->gravity = GRAVITY_GRID;
+        else if (strcmp(mode, "validate") == 0) config->gravity = GRAVITY_VALIDATE;
+        else printf("Warning: --gravity needs exact, grid or validate, got %s\n", mode);
+        return 1;
+    }
+    if (strncmp(arg, "--gravity-cell=", 15) == 0) {
+        int cell = atoi(arg + 15);
+        if (cell < GRAVITY_MIN_CELL_SIZE || cell > GRAVITY_FIELD_EXTENT) {
+            printf("Warning: --gravity-cell needs %d to %d px, got %s\n", GRAVITY_MIN_CELL_SIZE, GRAVITY_FIELD_EXTENT, arg + 15);
+        } else {
+            config->gravity_cell = cell;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// Adds the pull of one body at offset (dx, dy) from the sampled point.
+// Returns 1 when the point is inside the body's core (other bodies should be ignored).
+int accumulateBodyGravity(float mass, float dx, float dy, float* accel_x, float* accel_y) {
+    float distance_squared = dx * dx + dy * dy;
+    if (distance_squared <= 0) return 1; // exactly at the center: no direction
+
+    float distance = sqrtf(distance_squared);
+    if (distance >= GRAVITY_RANGE_FACTOR * mass) return 0;
+
+    distance = sqrtf(distance_squared + GRAVITY_SOFTENING * GRAVITY_SOFTENING); // softening
+
+    // Calculate gravitational force (F = G * m1 * m2 / r²)
+    float force_magnitude = (GRAVITY_CONSTANT * mass * FIGHTER_MASS) / distance_squared / 5;
+
+    // Convert force to acceleration (a = F / m)
+    float acceleration = force_magnitude / FIGHTER_MASS;
+
+    // Normalize direction vector and apply acceleration
+    *accel_x += (dx / distance) * acceleration * GRAVITY_FACTOR;
+    *accel_y += (dy / distance) * acceleration * GRAVITY_FACTOR;
+
+    return distance < GRAVITY_CORE_FACTOR * mass;
+}
+
+void exactGravity(const BackgroundEffects* bg_effects, float x, float y, float* accel_x, float* accel_y) {
+    *accel_x = 0;
+    *accel_y = 0;
+
+    for (int i = 0; i < NUM_PLANETS; i++) {
+        const Planet* planet = &bg_effects->planets[i];
+        float dx = planet->world_pos.x - x;
+        float dy = planet->world_pos.y - y;
+
+        // ignore other planets gravity if close to the center
+        if (accumulateBodyGravity(planet->mass, dx, dy, accel_x, accel_y)) break;
+    }
+}
+
+static void planetPosition(Planet* planet, int index, float* x, float* y) {
+    if (index == 0) {
+        *x = 0;
+        *y = 0;
+    } else {
+        *x = cos(planet->orbit_angle) * planet->orbit_radius;
+        *y = sin(planet->orbit_angle) * planet->orbit_radius;
+    }
+}
+
+static SDL_Point worldToCell(GravityField* field, float x, float y) {
+    return (SDL_Point){
+        (int)floorf((x - field->origin) / field->cell_size + 0.5f),
+        (int)floorf((y - field->origin) / field->cell_size + 0.5f)
+    };
+}
+
+// Node range touched by a body stamped at (x, y)
+static void bodyBox(GravityField* field, SDL_FPoint body, float mass, SDL_Rect* box) {
+    SDL_Point c = worldToCell(field, body.x, body.y);
+    int reach = (int)ceilf(GRAVITY_RANGE_FACTOR * mass / field->cell_size) + 1;
+    int x0 = max(c.x - reach, 0);
+    int y0 = max(c.y - reach, 0);
+    int x1 = min(c.x + reach, field->size - 1);
+    int y1 = min(c.y + reach, field->size - 1);
+    *box = (SDL_Rect){ x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+}
+
+static void stampLayer(GravityField* field, int index, float mass, SDL_FPoint body) {
+    float* ax = field->layer_ax[index];
+    float* ay = field->layer_ay[index];
+    SDL_Rect box;
+    bodyBox(field, body, mass, &box);
+
+    for (int v = box.y; v < box.y + box.h; v++) {
+        float node_y = field->origin + v * field->cell_size;
+        for (int u = box.x; u < box.x + box.w; u++) {
+            float node_x = field->origin + u * field->cell_size;
+            int n = v * field->size + u;
+            ax[n] = 0;
+            ay[n] = 0;
+            accumulateBodyGravity(mass, body.x - node_x, body.y - node_y, &ax[n], &ay[n]);
+        }
+    }
+}
+
+static void clearLayer(GravityField* field, int index, float mass, SDL_FPoint body) {
+    SDL_Rect box;
+    bodyBox(field, body, mass, &box);
+    for (int v = box.y; v < box.y + box.h; v++) {
+        for (int u = box.x; u < box.x + box.w; u++) {
+            field->layer_ax[index][v * field->size + u] = 0;
+            field->layer_ay[index][v * field->size + u] = 0;
+        }
+    }
+}
+
+// Rebuilds the sum inside box from the layers (no accumulated rounding drift)
+static void sumLayers(GravityField* field, SDL_Rect box) {
+    for (int v = box.y; v < box.y + box.h; v++) {
+        for (int u = box.x; u < box.x + box.w; u++) {
+            int n = v * field->size + u;
+            float ax = 0, ay = 0;
+            for (int i = 0; i < NUM_PLANETS; i++) {
+                ax += field->layer_ax[i][n];
+                ay += field->layer_ay[i][n];
+            }
+            field->total_ax[n] = ax;
+            field->total_ay[n] = ay;
+        }
+    }
+}
+
+// Stamps every body at its current position into zeroed layers
+static void stampAllLayers(BackgroundEffects* bg_effects, GravityField* field) {
+    for (int i = 0; i < NUM_PLANETS; i++) {
+        Planet* planet = &bg_effects->planets[i];
+        planetPosition(planet, i, &field->stamped[i].x, &field->stamped[i].y);
+        field->stamped_mass[i] = planet->mass;
+        stampLayer(field, i, planet->mass, field->stamped[i]);
+    }
+    sumLayers(field, (SDL_Rect){ 0, 0, field->size, field->size });
+}
+
+// Moves one body's layer to (body, mass): clears its old footprint, stamps
+// the new one and re-sums the nodes either of them covers
+static void restampLayer(GravityField* field, int index, float mass, SDL_FPoint body) {
+    SDL_FPoint old = field->stamped[index];
+    float old_mass = field->stamped_mass[index];
+
+    SDL_Rect old_box, new_box, dirty;
+    bodyBox(field, old, old_mass, &old_box);
+    bodyBox(field, body, mass, &new_box);
+    SDL_UnionRect(&old_box, &new_box, &dirty);
+
+    clearLayer(field, index, old_mass, old);
+    stampLayer(field, index, mass, body);
+    sumLayers(field, dirty);
+
+    field->stamped[index] = body;
+    field->stamped_mass[index] = mass;
+    field->restamps++;
+}
+
+int initGravityField(BackgroundEffects* bg_effects, float cell_size, GravityMode mode) {
+    GravityField* field = memCalloc(1, sizeof(GravityField), MEM_GRAVITY);
+    checkInit(!field, "Failed to allocate gravity field");
+
+    field->mode = mode;
+    field->cell_size = cell_size;
+    field->restamp_distance = cell_size * GRAVITY_RESTAMP_FRACTION;
+    field->origin = -GRAVITY_FIELD_EXTENT;
+    field->size = (int)ceilf(2 * GRAVITY_FIELD_EXTENT / cell_size) + 1;
+
+    size_t nodes = (size_t)field->size * field->size;
+    for (int i = 0; i < NUM_PLANETS; i++) {
+        field->layer_ax[i] = memCalloc(nodes, sizeof(float), MEM_GRAVITY);
+        field->layer_ay[i] = memCalloc(nodes, sizeof(float), MEM_GRAVITY);
+        checkInit(!field->layer_ax[i] || !field->layer_ay[i], "Failed to allocate gravity field layers");
+    }
+    field->total_ax = memCalloc(nodes, sizeof(float), MEM_GRAVITY);
+    field->total_ay = memCalloc(nodes, sizeof(float), MEM_GRAVITY);
+    checkInit(!field->total_ax || !field->total_ay, "Failed to allocate gravity field");
+
+    bg_effects->gravity_field = field;
+
+    // Sun layer is static, planet layers start at their initial orbit angle
+    stampAllLayers(bg_effects, field);
+
+    printf("Gravity field: %dx%d nodes, %.0f px cells, %.1f MB\n", field->size, field->size, cell_size,
+           nodes * sizeof(float) * 2 * (NUM_PLANETS + 1) / (1024.0 * 1024.0));
+    return 1;
+}
+
+// The field the world config asks for: none without gravity, or with the
+// exact sum which does not sample it
+void initWorldGravity(BackgroundEffects* bg_effects) {
+    const WorldConfig* config = &bg_effects->config;
+    if (config->gravity == GRAVITY_OFF || config->gravity == GRAVITY_EXACT) return;
+    initGravityField(bg_effects, config->gravity_cell, config->gravity);
+}
+
+void destroyGravityField(BackgroundEffects* bg_effects) {
+    GravityField* field = bg_effects->gravity_field;
+    if (!field) return;
+
+    if (field->mode == GRAVITY_VALIDATE && field->samples > 0) {
+        printf("Gravity field error: max %g, mean %g over %d samples\n",
+               field->max_error, field->sum_error / field->samples, field->samples);
+    }
+
+    for (int i = 0; i < NUM_PLANETS; i++) {
+        memFree(field->layer_ax[i]);
+        memFree(field->layer_ay[i]);
+    }
+    memFree(field->total_ax);
+    memFree(field->total_ay);
+    memFree(field);
+    bg_effects->gravity_field = NULL;
+}
+
+// Data reload: re-stamps only the bodies whose mass changed or whose new
+// orbit moved them, the others keep their layer
+void reloadGravityField(BackgroundEffects* bg_effects) {
+    GravityField* field = bg_effects->gravity_field;
+    if (!field) return;
+
+    for (int i = 0; i < NUM_PLANETS; i++) {
+        Planet* planet = &bg_effects->planets[i];
+        SDL_FPoint body;
+        planetPosition(planet, i, &body.x, &body.y);
+
+        SDL_FPoint old = field->stamped[i];
+        if (planet->mass == field->stamped_mass[i] && hypotf(body.x - old.x, body.y - old.y) < field->restamp_distance) continue;
+        restampLayer(field, i, planet->mass, body);
+    }
+}
+
+// Re-stamps the planets that moved restamp_distance since their last stamp
+void updateGravityField(BackgroundEffects* bg_effects) {
+    GravityField* field = bg_effects->gravity_field;
+    if (!field || field->mode == GRAVITY_EXACT) return;
+
+    for (int i = 1; i < NUM_PLANETS; i++) { // Skip the sun, its layer never changes
+        Planet* planet = &bg_effects->planets[i];
+        SDL_FPoint body;
+        planetPosition(planet, i, &body.x, &body.y);
+
+        SDL_FPoint old = field->stamped[i];
+        if (hypotf(body.x - old.x, body.y - old.y) < field->restamp_distance) continue;
+        restampLayer(field, i, planet->mass, body);
+    }
+}
+
+// Bilinear lookup. Returns 0 when (x, y) is outside the grid.
+int sampleGravityField(const GravityField* field, float x, float y, float* accel_x, float* accel_y) {
+    float fx = (x - field->origin) / field->cell_size;
+    float fy = (y - field->origin) / field->cell_size;
+    int u = (int)floorf(fx);
+    int v = (int)floorf(fy);
+    if (u < 0 || v < 0 || u >= field->size - 1 || v >= field->size - 1) return 0;
+
+    float tx = fx - u;
+    float ty = fy - v;
+    int n = v * field->size + u;
+    int s = field->size;
+
+    const float* ax = field->total_ax;
+    const float* ay = field->total_ay;
+    float top_x = ax[n] + (ax[n + 1] - ax[n]) * tx;
+    float bottom_x = ax[n + s] + (ax[n + s + 1] - ax[n + s]) * tx;
+    float top_y = ay[n] + (ay[n + 1] - ay[n]) * tx;
+    float bottom_y = ay[n + s] + (ay[n + s + 1] - ay[n + s]) * tx;
+
+    *accel_x = top_x + (bottom_x - top_x) * ty;
+    *accel_y = top_y + (bottom_y - top_y) * ty;
+    return 1;
+}
+
+void computeGravity(const BackgroundEffects* bg_effects, float x, float y, float* accel_x, float* accel_y) {
+    GravityField* field = bg_effects->gravity_field;
+
+    if (!field || field->mode == GRAVITY_EXACT) {
+        exactGravity(bg_effects, x, y, accel_x, accel_y);
+        return;
+    }
+
+    if (field->mode == GRAVITY_GRID) {
+        // Outside the grid there is nothing cached, fall back to the exact path
+        if (!sampleGravityField(field, x, y, accel_x, accel_y)) {
+            exactGravity(bg_effects, x, y, accel_x, accel_y);
+        }
+        return;
+    }
+
+    // GRAVITY_VALIDATE: the exact value drives the game, the grid is only measured
+    exactGravity(bg_effects, x, y, accel_x, accel_y);
+
+    float grid_x, grid_y;
+    if (sampleGravityField(field, x, y, &grid_x, &grid_y)) {
+        float error = hypotf(grid_x - *accel_x, grid_y - *accel_y);
+        field->sum_error += error;
+        field->max_error = fmaxf(field->max_error, error);
+        field->samples++;
+
+        if (field->samples % GRAVITY_VALIDATE_REPORT == 0) {
+            printf("Gravity field error: max %g, mean %g over %d samples (%d restamps)\n",
+                   field->max_error, field->sum_error / field->samples, field->samples, field->restamps);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef GRAVITY_H
+#define GRAVITY_H
+
+#include <SDL2/SDL.h>
+#include "init.h"
+
+/*
+            DEFINITIONS
+*/
+#define GRAVITY_CONSTANT 6.67e-11f
+#define GRAVITY_SOFTENING 200.0f      // px, added to the distance before normalizing
+#define GRAVITY_RANGE_FACTOR 146.0f   // bodies pull within 146*mass px (sun: 4000/27.4)
+#define GRAVITY_CORE_FACTOR 0.05f     // inside 0.05*mass px other bodies are ignored
+
+#define GRAVITY_FIELD_EXTENT 4800     // Grid covers [-extent, extent] on both axes
+#define GRAVITY_CELL_SIZE 32          // Default spacing between grid nodes (px), --gravity-cell
+#define GRAVITY_MIN_CELL_SIZE 8       // 1201x1201 nodes, 110 MB of layers
+#define GRAVITY_RESTAMP_FRACTION 0.5f     // Of a cell, how far a planet moves before it is re-stamped
+#define GRAVITY_VALIDATE_REPORT 600   // Samples between two error reports
+
+// WorldConfig.gravity, --gravity[=exact|grid|validate]
+typedef enum {
+    GRAVITY_OFF,       // No gravity in the rules, no field (the default)
+    GRAVITY_EXACT,     // Loop over every body (reference path)
+    GRAVITY_GRID,      // Bilinear lookup in the precomputed field
+    GRAVITY_VALIDATE   // Apply the exact value, measure the grid error against it
+} GravityMode;
+
+/*
+            FIELD STRUCTURE
+*/
+// Acceleration grid. Each body has its own layer holding only its contribution
+// around its last stamped position; total_* is the sum of all layers. The sun
+// never moves so its layer is built once, planets are stamped at their true
+// position and re-stamped once they moved restamp_distance from it. A data
+// reload only re-stamps the bodies it changed.
+typedef struct GravityField {
+    GravityMode mode;
+    float cell_size;
+    float restamp_distance;             // px
+    float origin;                       // World coordinate of node (0, 0)
+    int size;                           // Nodes per side
+    float* layer_ax[NUM_PLANETS];
+    float* layer_ay[NUM_PLANETS];
+    float* total_ax;
+    float* total_ay;
+    SDL_FPoint stamped[NUM_PLANETS];    // World position of each layer's body
+    float stamped_mass[NUM_PLANETS];    // And its mass when it was stamped
+    int restamps;                       // Number of planet layer rebuilds
+
+    // Validation statistics, counted without locks: approximate when the
+    // server steps sessions on several threads
+    int samples;
+    double sum_error;
+    float max_error;
+} GravityField;
+
+
+/*
+            DECLARATIONS
+*/
+int parseGravityArgument(const char* arg, WorldConfig* config);
+int initGravityField(BackgroundEffects* bg_effects, float cell_size, GravityMode mode);
+void initWorldGravity(BackgroundEffects* bg_effects);
+void destroyGravityField(BackgroundEffects* bg_effects);
+void updateGravityField(BackgroundEffects* bg_effects);
+void reloadGravityField(BackgroundEffects* bg_effects);
+
+int accumulateBodyGravity(float mass, float dx, float dy, float* accel_x, float* accel_y);
+void exactGravity(const BackgroundEffects* bg_effects, float x, float y, float* accel_x, float* accel_y);
+int sampleGravityField(const GravityField* field, float x, float y, float* accel_x, float* accel_y);
+void computeGravity(const BackgroundEffects* bg_effects, float x, float y, float* accel_x, float* accel_y);
+
+#endif
@@ -0,0 +1,225 @@
+#include "hotreload.h"
+#include "gravity.h"
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#define HOTRELOAD_EVENT_BUFFER 4096
+#define HOTRELOAD_DIR_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+
+static int isDataSource(const char* path) {
+    return strcmp(path, DATA_PHYSICS_PATH) == 0 || strcmp(path, DATA_SHIPS_PATH) == 0 ||
+           strcmp(path, DATA_HITBOXES_PATH) == 0 || strcmp(path, DATA_LEVEL_PATH) == 0;
+}
+
+// Watches dir and every directory below it
+static void addWatchTree(HotReload* hr, const char* dir) {
+    if (hr->num_watches == HOTRELOAD_MAX_WATCHES) {
+        printf("Warning: Hot reload is not watching %s (raise HOTRELOAD_MAX_WATCHES)\n", dir);
+        return;
+    }
+
+    int wd = inotify_add_watch(hr->fd, dir, HOTRELOAD_DIR_EVENTS);
+    if (wd < 0) return;
+
+    hr->watches[hr->num_watches] = wd;
+    snprintf(hr->dirs[hr->num_watches], PAK_PATH_LENGTH, "%s", dir);
+    hr->num_watches++;
+
+    DIR* handle = opendir(dir);
+    if (!handle) return;
+
+    struct dirent* item;
+    while ((item = readdir(handle))) {
+        if (item->d_name[0] == '.') continue;
+
+        char path[PAK_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%s/%s", dir, item->d_name);
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) addWatchTree(hr, path);
+    }
+    closedir(handle);
+}
+
+static const char* watchedDir(HotReload* hr, int wd) {
+    for (int i = 0; i < hr->num_watches; i++) {
+        if (hr->watches[i] == wd) return hr->dirs[i];
+    }
+    return NULL;
+}
+
+static void addChange(char list[][PAK_PATH_LENGTH], int* count, const char* path) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(list[i], path) == 0) return;
+    }
+    if (*count == HOTRELOAD_MAX_CHANGES) return;
+    snprintf(list[(*count)++], PAK_PATH_LENGTH, "%s", path);
+}
+
+// Returns 1 if something relevant happened
+static int readEvents(HotReload* hr) {
+    char buffer[HOTRELOAD_EVENT_BUFFER] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length = read(hr->fd, buffer, sizeof(buffer));
+    int relevant = 0;
+
+    for (char* p = buffer; length > 0 && p < buffer + length; ) {
+        const struct inotify_event* event = (const struct inotify_event*)p;
+        p += sizeof(struct inotify_event) + event->len;
+
+        const char* dir = watchedDir(hr, event->wd);
+        if (!dir || event->len == 0 || event->name[0] == '.') continue;
+
+        char path[PAK_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%s/%s", dir, event->name);
+
+        if (event->mask & IN_ISDIR) {
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) addWatchTree(hr, path);
+            continue;
+        }
+        if (!(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) continue;
+
+        if (isDataSource(path)) {
+            hr->data_changed = 1;
+        } else if (strncmp(path, "data/", 5) == 0) {
+            continue; // our own cache and archive
+        } else {
+            addChange(hr->collecting, &hr->num_collecting, path);
+        }
+        relevant = 1;
+    }
+    return relevant;
+}
+
+// Watcher thread: debounce, recompile data files, hand the batch to the main thread
+static int hotReloadWorker(void* data) {
+    HotReload* hr = data;
+    static GameData compiled; // only this thread touches it
+    Uint32 last_event = 0;
+
+    while (!SDL_AtomicGet(&hr->quit)) {
+        struct pollfd pfd = { hr->fd, POLLIN, 0 };
+        if (poll(&pfd, 1, HOTRELOAD_POLL_MS) > 0 && readEvents(hr)) {
+            last_event = SDL_GetTicks();
+        }
+
+        if (hr->num_collecting == 0 && !hr->data_changed) continue;
+        if (SDL_GetTicks() - last_event < HOTRELOAD_DEBOUNCE_MS) continue;
+
+        if (hr->data_changed) {
+            compileGameData(&compiled);
+            if (!writeGameDataCache(&compiled, DATA_CACHE_PATH)) {
+                printf("Warning: Could not write %s\n", DATA_CACHE_PATH);
+            }
+        }
+
+        SDL_LockMutex(hr->lock);
+        for (int i = 0; i < hr->num_collecting; i++) {
+            addChange(hr->changed, &hr->num_changed, hr->collecting[i]);
+        }
+        if (hr->data_changed) {
+            hr->staged_data = compiled;
+            hr->data_ready = 1;
+        }
+        SDL_UnlockMutex(hr->lock);
+
+        hr->num_collecting = 0;
+        hr->data_changed = 0;
+    }
+    return 0;
+}
+
+// Returns 0 (and the game runs without hot reload) if inotify is unavailable
+int initHotReload(HotReload* hr) {
+    memset(hr, 0, sizeof(*hr));
+    hr->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (hr->fd < 0) {
+        printf("Warning: Hot reload disabled, inotify unavailable\n");
+        return 0;
+    }
+
+    addWatchTree(hr, "img");
+    addWatchTree(hr, "data");
+    addWatchTree(hr, "music");
+
+    hr->lock = SDL_CreateMutex();
+    hr->thread = SDL_CreateThread(hotReloadWorker, "hotreload", hr);
+    if (!hr->lock || !hr->thread) {
+        printf("Warning: Hot reload disabled, %s\n", SDL_GetError());
+        shutdownHotReload(hr);
+        return 0;
+    }
+
+    printf("Hot reload: watching %d directories\n", hr->num_watches);
+    return 1;
+}
+
+void shutdownHotReload(HotReload* hr) {
+    SDL_AtomicSet(&hr->quit, 1);
+    if (hr->thread) SDL_WaitThread(hr->thread, NULL);
+    if (hr->lock) SDL_DestroyMutex(hr->lock);
+    if (hr->fd >= 0) close(hr->fd);
+
+    hr->thread = NULL;
+    hr->lock = NULL;
+    hr->fd = -1;
+}
+
+// Main thread, once per frame before the decoded assets are uploaded. Textures,
+// music and sound effects are only queued for decoding here, the swap happens
+// when they come back.
+void processHotReload(HotReload* hr, GameResources* resources, GameData* data, BackgroundEffects* bg_effects) {
+    if (!hr->thread) return;
+
+    char changed[HOTRELOAD_MAX_CHANGES][PAK_PATH_LENGTH];
+    int num_changed = 0;
+    int data_ready = 0;
+
+    SDL_LockMutex(hr->lock);
+    if (hr->num_changed > 0) {
+        num_changed = hr->num_changed;
+        memcpy(changed, hr->changed, sizeof(changed[0]) * num_changed);
+        hr->num_changed = 0;
+    }
+    if (hr->data_ready) {
+        *data = hr->staged_data;
+        hr->data_ready = 0;
+        data_ready = 1;
+    }
+    SDL_UnlockMutex(hr->lock);
+
+    if (data_ready) {
+        applySolarSystemData(bg_effects, data);
+        reloadGravityField(bg_effects);
+        hr->reloads++;
+        printf("Hot reload: data files\n");
+    }
+
+    for (int i = 0; i < num_changed; i++) {
+        TextureHandle handle = findTexture(&resources->textures, changed[i]);
+        if (handle) {
+            reloadTexture(&resources->textures, handle);
+            hr->reloads++;
+            printf("Hot reload: %s\n", changed[i]);
+            continue;
+        }
+
+        int track = findMusicTrack(&resources->music, changed[i]);
+        if (track >= 0) {
+            reloadMusicTrack(&resources->music, track);
+            hr->reloads++;
+            printf("Hot reload: %s\n", changed[i]);
+            continue;
+        }
+
+        int sound = findSound(&resources->voices, changed[i]);
+        if (sound >= 0) {
+            reloadSound(&resources->voices, &resources->loader, sound);
+            hr->reloads++;
+            printf("Hot reload: %s\n", changed[i]);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef HOTRELOAD_H
+#define HOTRELOAD_H
+
+#include <SDL2/SDL.h>
+#include "init.h"
+
+/*
+            DEFINITIONS
+*/
+#define HOTRELOAD_MAX_WATCHES 128     // Watched directories (img/ is watched recursively)
+#define HOTRELOAD_MAX_CHANGES 64      // Distinct files changed between two frames
+#define HOTRELOAD_DEBOUNCE_MS 100     // Quiet time before a burst of writes is handled
+#define HOTRELOAD_POLL_MS 50          // Watcher wake-up period (checks for quit)
+
+/*
+            WATCHER STRUCTURE
+*/
+// The watcher thread collects changed paths until the directories have been
+// quiet for HOTRELOAD_DEBOUNCE_MS (editors write in several steps), recompiles
+// the data files itself, then publishes the batch. The main thread picks it
+// up at a frame boundary in processHotReload.
+typedef struct {
+    int fd;                                              // inotify, -1 when disabled
+    int watches[HOTRELOAD_MAX_WATCHES];
+    char dirs[HOTRELOAD_MAX_WATCHES][PAK_PATH_LENGTH];
+    int num_watches;
+
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    SDL_atomic_t quit;
+
+    // Watcher thread only
+    char collecting[HOTRELOAD_MAX_CHANGES][PAK_PATH_LENGTH];
+    int num_collecting;
+    int data_changed;
+
+    // Published, under lock
+    char changed[HOTRELOAD_MAX_CHANGES][PAK_PATH_LENGTH];
+    int num_changed;
+    GameData staged_data;                                // Recompiled data files
+    int data_ready;
+
+    int reloads;
+} HotReload;
+
+
+/*
+            DECLARATIONS
+*/
+int initHotReload(HotReload* hr);
+void shutdownHotReload(HotReload* hr);
+void processHotReload(HotReload* hr, GameResources* resources, GameData* data, BackgroundEffects* bg_effects);
+
+#endif
@@ -1,6 +1,20 @@
 #include "init.h"
+#include "render.h" // Loading screen
+#include "startup.h"
+#include "ui.h"
+#include "sim.h"
+#include "gravity.h"
 #include <stdio.h>
 #include <math.h>
+#include <unistd.h>
+
+// Astral object textures, in type order. The server reads the image sizes.
+const char* const astralTexturePaths[ASTRAL_TYPES] = {
+    "img/stars/astral-objects/cloud.png",
+    "img/stars/astral-objects/nebula.png", 
+    "img/stars/astral-objects/nova.png",
+    "img/stars/astral-objects/vortex.png"
+};
 
 // Helper function for error checking
 void checkInit(int condition, const char* message) {
@@ -19,17 +33,25 @@ void checkInitMix(int condition, const char* message) {
 
 void initSDLSystems() {
     // Initialize SDL
+    int span = beginStartupSpan("SDL_Init");
     checkInit(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0, "SDL could not initialize!");
+    endStartupSpan(span);
     
     // Initialize SDL_ttf
+    span = beginStartupSpan("TTF_Init");
     checkInit(TTF_Init() == -1, "SDL_ttf could not initialize!");
+    endStartupSpan(span);
     
     // Initialize SDL_image
+    span = beginStartupSpan("IMG_Init");
     int imgFlags = IMG_INIT_PNG;
     checkInit(!(IMG_Init(imgFlags) & imgFlags), "SDL_image could not initialize!");
+    endStartupSpan(span);
     
     // Initialize SDL_mixer
+    span = beginStartupSpan("Mix_OpenAudio");
     checkInitMix(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0, "SDL_mixer could not initialize!");
+    endStartupSpan(span);
 }
 
 void initWindow(const char* title, GameResources* resources) {
@@ -59,63 +81,53 @@ SDL_Renderer* initRenderer(SDL_Window* window) {
 }
 
 TTF_Font* initFont(const char* fontPath, int size) {
+    char name[STARTUP_NAME_LENGTH];
+    snprintf(name, sizeof(name), "TTF_OpenFont %s %d", fontPath, size);
+    int span = beginStartupSpan(name);
     TTF_Font* font = TTF_OpenFont(fontPath, size);
+    endStartupSpan(span);
     checkInit(!font, "Failed to load font!");
     return font;
 }
 
 void initGameResources(SDL_Renderer* renderer, GameResources* resources) {
-    // Load checkbox images
-    SDL_Surface* checkboxCheckedSurface = IMG_Load("img/menus/checkbox_checked.png");
-    SDL_Surface* checkboxUncheckedSurface = IMG_Load("img/menus/checkbox_unchecked.png");
-    SDL_Surface* checkboxCheckedSurface2 = IMG_Load("img/menus/checkbox_checked2.png");
-    SDL_Surface* checkboxUncheckedSurface2 = IMG_Load("img/menus/checkbox_unchecked2.png");
-    checkInit(!checkboxCheckedSurface || !checkboxUncheckedSurface, "Failed to load checkbox images");
-    checkInit(!checkboxCheckedSurface2 || !checkboxUncheckedSurface2, "Failed to load checkbox images 2");
-
-    resources->checkboxCheckedTexture = SDL_CreateTextureFromSurface(renderer, checkboxCheckedSurface);
-    resources->checkboxUncheckedTexture = SDL_CreateTextureFromSurface(renderer, checkboxUncheckedSurface);
-    resources->checkboxCheckedTexture2 = SDL_CreateTextureFromSurface(renderer, checkboxCheckedSurface2);
-    resources->checkboxUncheckedTexture2 = SDL_CreateTextureFromSurface(renderer, checkboxUncheckedSurface2);
-    SDL_FreeSurface(checkboxCheckedSurface);
-    SDL_FreeSurface(checkboxUncheckedSurface);
-    SDL_FreeSurface(checkboxCheckedSurface2);
-    SDL_FreeSurface(checkboxUncheckedSurface2);
-    checkInit(!resources->checkboxCheckedTexture || !resources->checkboxUncheckedTexture, "Failed to create checkbox textures");
-    checkInit(!resources->checkboxCheckedTexture2 || !resources->checkboxUncheckedTexture2, "Failed to create checkbox textures 2");
-
-    SDL_Surface* checkmarkSurface = IMG_Load("img/menus/checkmark2.png");
-    checkInit(!checkmarkSurface, "Failed to load checkmark image");
-    resources->checkmarkTexture = SDL_CreateTextureFromSurface(renderer, checkmarkSurface);
-    SDL_FreeSurface(checkmarkSurface);
-    checkInit(!resources->checkmarkTexture, "Failed to create checkmark texture");
+    // Initialize fonts first, the loading screen needs them
+    int span = beginStartupSpan("fonts");
+    resources->uiFont = initFont("fonts/sft.ttf", 20);
+    resources->font = initFont("fonts/sft.ttf", 40);
+    resources->titleFont = initFont("fonts/sft.ttf", 48);
+    endStartupSpan(span);
+
+    span = beginStartupSpan("queue assets");
+
+    // Every image and sound is decoded on the worker threads, textures are
+    // created here on the render thread as they come back
+    AssetLoader* loader = &resources->loader;
+    initAssetLoader(loader, renderer);
+
+    // Images go through the texture manager: it loads them through the same
+    // workers, keeps them under a VRAM budget and reloads evicted ones on demand
+    TextureManager* tm = &resources->textures;
+    initTextureManager(tm, loader, TEXMGR_DEFAULT_BUDGET);
+
+    // Load checkbox images (UI is always on screen: pinned)
+    const int ui = TEXTURE_REQUIRED | TEXTURE_PINNED;
+    resources->checkboxCheckedTexture = registerTexture(tm, (TextureDesc){ .path = "img/menus/checkbox_checked.png", .flags = ui, .category = TEXCAT_UI });
+    resources->checkboxUncheckedTexture = registerTexture(tm, (TextureDesc){ .path = "img/menus/checkbox_unchecked.png", .flags = ui, .category = TEXCAT_UI });
+    resources->checkboxCheckedTexture2 = registerTexture(tm, (TextureDesc){ .path = "img/menus/checkbox_checked2.png", .flags = ui, .category = TEXCAT_UI });
+    resources->checkboxUncheckedTexture2 = registerTexture(tm, (TextureDesc){ .path = "img/menus/checkbox_unchecked2.png", .flags = ui, .category = TEXCAT_UI });
+    resources->checkmarkTexture = registerTexture(tm, (TextureDesc){ .path = "img/menus/checkmark2.png", .flags = ui, .category = TEXCAT_UI });
 
     // Load fighter image
-    SDL_Surface* fighterSurface = IMG_Load("img/topdownfighter.png");
-    checkInit(!fighterSurface, "Failed to load fighter image");
-    resources->fighterTexture = SDL_CreateTextureFromSurface(renderer, fighterSurface);
-    SDL_FreeSurface(fighterSurface);
-    checkInit(!resources->fighterTexture, "Failed to create fighter texture");
+    resources->fighterTexture = registerTexture(tm, (TextureDesc){ .path = "img/topdownfighter.png", .flags = ui });
 
     // Load pause button
-    SDL_Surface* pauseSurface = IMG_Load("img/menus/pause.png");
-    SDL_Surface* pauseSurface2 = IMG_Load("img/menus/pause2.png");
-    checkInit(!pauseSurface, "Failed to load pause button image");
-    checkInit(!pauseSurface2, "Failed to load pause button image 2");
-    resources->pauseTexture = SDL_CreateTextureFromSurface(renderer, pauseSurface);
-    resources->pauseTexture2 = SDL_CreateTextureFromSurface(renderer, pauseSurface2);
-    SDL_FreeSurface(pauseSurface);
-    SDL_FreeSurface(pauseSurface2);
-    checkInit(!resources->pauseTexture, "Failed to create pause texture");
-    checkInit(!resources->pauseTexture2, "Failed to create pause texture 2");
+    resources->pauseTexture = registerTexture(tm, (TextureDesc){ .path = "img/menus/pause.png", .flags = ui, .category = TEXCAT_UI });
+    resources->pauseTexture2 = registerTexture(tm, (TextureDesc){ .path = "img/menus/pause2.png", .flags = ui, .category = TEXCAT_UI });
     resources->isHoveringPause = 0;
 
     // Load bullet image
-    SDL_Surface* bulletSurface = IMG_Load("img/bullets/sprites_-_lasers_bullets_1_66v2.5/bullets_full/10.png");
-    checkInit(!bulletSurface, "Failed to load bullet image");
-    resources->bulletTexture = SDL_CreateTextureFromSurface(renderer, bulletSurface);
-    SDL_FreeSurface(bulletSurface);
-    checkInit(!resources->bulletTexture, "Failed to create bullet texture");
+    resources->bulletTexture = registerTexture(tm, (TextureDesc){ .path = "img/bullets/sprites_-_lasers_bullets_1_66v2.5/bullets_full/10.png", .flags = TEXTURE_REQUIRED });
 
     // Load thruster textures
     const int numberImages = 4;
@@ -127,71 +139,48 @@ void initGameResources(SDL_Renderer* renderer, GameResources* resources) {
     };
     
     for (int i = 0; i < numberImages; i++) {
-        SDL_Surface* thrusterSurface = IMG_Load(thrusterPaths[i]);
-        if (!thrusterSurface) {
-            printf("Warning: Failed to load thruster image %s\n", thrusterPaths[i]);
-            // Create a placeholder texture
-            thrusterSurface = SDL_CreateRGBSurface(0, 20, 20, 32, 0, 0, 0, 0);
-            SDL_FillRect(thrusterSurface, NULL, SDL_MapRGB(thrusterSurface->format, 255, 100, 0));
-        }
-        resources->thrusterTextures[i] = SDL_CreateTextureFromSurface(renderer, thrusterSurface);
-        SDL_FreeSurface(thrusterSurface);
-        checkInit(!resources->thrusterTextures[i], "Failed to create thruster texture");
+        resources->thrusterTextures[i] = registerTexture(tm, (TextureDesc){
+            .path = thrusterPaths[i],
+            .flags = TEXTURE_REQUIRED,
+            .fallback_w = 20, .fallback_h = 20,
+            .fallback_color = {255, 100, 0, 255}
+        });
     }
 
     // Load star textures
-    const char* starPaths[4] = {
+    const char* starPaths[STAR_TEXTURES] = {
         "img/stars/star1.png", "img/stars/star2.png", "img/stars/star4.png", "img/stars/star5.png"
     };
     
-    resources->num_star_textures = 4;
+    resources->num_star_textures = STAR_TEXTURES;
     
     for (int i = 0; i < resources->num_star_textures; i++) {
-        SDL_Surface* starSurface = IMG_Load(starPaths[i]);
-        if (!starSurface) {
-            printf("Warning: Failed to load star image %s\n", starPaths[i]);
-            // Create a placeholder star
-            starSurface = SDL_CreateRGBSurface(0, 16, 16, 32, 0, 0, 0, 0);
-            SDL_FillRect(starSurface, NULL, SDL_MapRGBA(starSurface->format, 255, 255, 255, 255));
-            // Draw a simple star shape
-            SDL_Rect center = {6, 6, 4, 4};
-            SDL_FillRect(starSurface, &center, SDL_MapRGBA(starSurface->format, 200, 200, 100, 255));
-        }
-        resources->starTextures[i] = SDL_CreateTextureFromSurface(renderer, starSurface);
-        SDL_SetTextureBlendMode(resources->starTextures[i], SDL_BLENDMODE_BLEND);
-        SDL_FreeSurface(starSurface);
-        checkInit(!resources->starTextures[i], "Failed to create star texture");
+        resources->starTextures[i] = registerTexture(tm, (TextureDesc){
+            .path = starPaths[i],
+            .flags = TEXTURE_REQUIRED | TEXTURE_BLEND,
+            .category = TEXCAT_STARS,
+            .fallback_w = 16, .fallback_h = 16,
+            .fallback_color = {255, 255, 255, 255}
+        });
     }
 
-    // Load menu background
-    SDL_Surface* menuBgSurface = IMG_Load("img/menus/2.jpg");
-    if (!menuBgSurface) {
-        printf("Warning: Failed to load menu background image\n");
-        // Create a fallback background
-        menuBgSurface = SDL_CreateRGBSurface(0, resources->windowWidth, resources->windowHeight, 32, 0, 0, 0, 0);
-        SDL_FillRect(menuBgSurface, NULL, SDL_MapRGB(menuBgSurface->format, 30, 30, 60)); // Dark blue
-    }
-    resources->menuBackground = SDL_CreateTextureFromSurface(renderer, menuBgSurface);
-    SDL_FreeSurface(menuBgSurface);
-    
-    // Load options background
-    SDL_Surface* optionsBgSurface = IMG_Load("img/menus/3.jpg");
-    if (!optionsBgSurface) {
-        printf("Warning: Failed to load options background image\n");
-        // Create a fallback background
-        optionsBgSurface = SDL_CreateRGBSurface(0, resources->windowWidth, resources->windowHeight, 32, 0, 0, 0, 0);
-        SDL_FillRect(optionsBgSurface, NULL, SDL_MapRGB(optionsBgSurface->format, 40, 40, 80)); // Slightly lighter blue
-    }
-    resources->optionsBackground = SDL_CreateTextureFromSurface(renderer, optionsBgSurface);
-    SDL_FreeSurface(optionsBgSurface);
-
-    SDL_Surface* menuListBgSurface = IMG_Load("img/menus/menu_bg.png");
-    checkInit(!menuListBgSurface, "Failed to load menu list bg image");
-    resources->menuBgTexture = SDL_CreateTextureFromSurface(renderer, menuListBgSurface);
-    SDL_FreeSurface(menuListBgSurface);
-    checkInit(!resources->menuBgTexture, "Failed to create menu list bg texture");
-
-    // Load planet textures
+    // Load menu and options backgrounds, fall back to plain blue
+    resources->menuBackground = registerTexture(tm, (TextureDesc){
+        .path = "img/menus/2.jpg",
+        .category = TEXCAT_UI,
+        .fallback_w = resources->windowWidth, .fallback_h = resources->windowHeight,
+        .fallback_color = {30, 30, 60, 255} // Dark blue
+    });
+    resources->optionsBackground = registerTexture(tm, (TextureDesc){
+        .path = "img/menus/3.jpg",
+        .category = TEXCAT_UI,
+        .fallback_w = resources->windowWidth, .fallback_h = resources->windowHeight,
+        .fallback_color = {40, 40, 80, 255} // Slightly lighter blue
+    });
+
+    resources->menuBgTexture = registerTexture(tm, (TextureDesc){ .path = "img/menus/menu_bg.png", .flags = ui, .category = TEXCAT_UI });
+
+    // Load planet textures (the biggest images: loaded the first time they are drawn)
     const char* planetPaths[NUM_PLANETS] = {
         "img/solar_system/red_sun.png",      // 0 - Sun
         "img/solar_system/mercury.png",  // 1 - Mercury
@@ -203,77 +192,89 @@ void initGameResources(SDL_Renderer* renderer, GameResources* resources) {
         "img/solar_system/uranus.png",   // 7 - Uranus
         "img/solar_system/neptune.png"   // 8 - Neptune
     };
+    const SDL_Color planetColors[] = {{255, 200, 100, 255}, {200, 150, 100, 255}, {150, 150, 200, 255}};
     
     for (int i = 0; i < NUM_PLANETS; i++) {
-        SDL_Surface* planetSurface = IMG_Load(planetPaths[i]);
-        if (!planetSurface) {
-            printf("Warning: Failed to load planet image %s\n", planetPaths[i]);
-            // Create placeholder
-            planetSurface = SDL_CreateRGBSurface(0, 1000, 1000, 32, 0, 0, 0, 0);
-            #pragma GCC diagnostic push
-            #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
-            SDL_Color colors[] = {{255, 200, 100}, {200, 150, 100}, {150, 150, 200}};
-            #pragma GCC diagnostic pop
-            SDL_FillRect(planetSurface, NULL, SDL_MapRGB(planetSurface->format, 
-                colors[i % 3].r, colors[i % 3].g, colors[i % 3].b));
-        }
-        resources->planetTextures[i] = SDL_CreateTextureFromSurface(renderer, planetSurface);
-        SDL_SetTextureBlendMode(resources->planetTextures[i], SDL_BLENDMODE_BLEND);
-        SDL_FreeSurface(planetSurface);
-        checkInit(!resources->planetTextures[i], "Failed to create planet texture");
+        resources->planetTextures[i] = registerTexture(tm, (TextureDesc){
+            .path = planetPaths[i],
+            .flags = TEXTURE_REQUIRED | TEXTURE_BLEND,
+            .category = TEXCAT_PLANETS,
+            .fallback_w = 1000, .fallback_h = 1000,
+            .fallback_color = planetColors[i % 3]
+        });
     }
 
     // Load astral object textures
-    const char* astralPaths[ASTRAL_TYPES] = {
-        "img/stars/astral-objects/cloud.png",
-        "img/stars/astral-objects/nebula.png", 
-        "img/stars/astral-objects/nova.png",
-        "img/stars/astral-objects/vortex.png"
-    };
+    const SDL_Color astralColors[] = {{100, 50, 150, 255}, {150, 100, 200, 255}, {200, 150, 100, 255}, {100, 200, 150, 255}};
     
     for (int i = 0; i < ASTRAL_TYPES; i++) {
-        SDL_Surface* astralSurface = IMG_Load(astralPaths[i]);
-        if (!astralSurface) {
-            printf("Warning: Failed to load astral image %s\n", astralPaths[i]);
-            // Create placeholder
-            astralSurface = SDL_CreateRGBSurface(0, 1000, 1000, 32, 0, 0, 0, 0);
-            #pragma GCC diagnostic push
-            #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
-            SDL_Color colors[] = {{100, 50, 150}, {150, 100, 200}, {200, 150, 100}, {100, 200, 150}};
-            #pragma GCC diagnostic pop
-            SDL_FillRect(astralSurface, NULL, SDL_MapRGB(astralSurface->format, 
-                colors[i].r, colors[i].g, colors[i].b));
+        resources->astralTextures[i] = registerTexture(tm, (TextureDesc){
+            .path = astralTexturePaths[i],
+            .flags = TEXTURE_REQUIRED | TEXTURE_BLEND,
+            .category = TEXCAT_ASTRAL,
+            .fallback_w = 1000, .fallback_h = 1000,
+            .fallback_color = astralColors[i]
+        });
+    }
+
+    // Preload what the first frames draw, initAstralObjects also needs the astral sizes.
+    // Planets stay on disk until they come into view.
+    for (int i = 1; i < tm->count; i++) {
+        if (tm->entries[i].desc.flags & TEXTURE_PINNED) requestTexture(tm, i);
+    }
+    for (int i = 0; i < numberImages; i++) requestTexture(tm, resources->thrusterTextures[i]);
+    for (int i = 0; i < resources->num_star_textures; i++) requestTexture(tm, resources->starTextures[i]);
+    for (int i = 0; i < ASTRAL_TYPES; i++) requestTexture(tm, resources->astralTextures[i]);
+    requestTexture(tm, resources->bulletTexture);
+    requestTexture(tm, resources->menuBackground);
+    requestTexture(tm, resources->optionsBackground);
+
+    // Load music and sound effects
+    // Music is streamed, tracks are decoded by the loader when first played.
+    // A region without its file plays the theme.
+    initMusicStreamer(&resources->music, loader);
+    resources->menuTrack = addMusicTrack(&resources->music, MUSIC_THEME_PATH);
+    resources->innerTrack = access(MUSIC_INNER_PATH, R_OK) == 0 ? addMusicTrack(&resources->music, MUSIC_INNER_PATH) : resources->menuTrack;
+    resources->outerTrack = access(MUSIC_OUTER_PATH, R_OK) == 0 ? addMusicTrack(&resources->music, MUSIC_OUTER_PATH) : resources->menuTrack;
+
+    // Sound effects play through a fixed channel budget, the discovery chime outranks the rest.
+    // They are short, converted here once into the device format rather than on the workers.
+    initVoiceManager(&resources->voices);
+    resources->discoverySfx = registerSound(&resources->voices, SOUND_DISCOVERY_PATH, SOUND_PRIORITY_HIGH, 2);
+    resources->wowSfx = registerSound(&resources->voices, SOUND_WOW_PATH, SOUND_PRIORITY_NORMAL, 1);
+    resources->aceSfx = registerSound(&resources->voices, SOUND_ACE_PATH, SOUND_PRIORITY_NORMAL, 1);
+    loadSounds(&resources->voices);
+
+    endStartupSpan(span);
+
+    // Keep the window alive and animated while the workers decode
+    span = beginStartupSpan("loading screen");
+    while (!assetLoaderDone(loader)) {
+        SDL_Event e;
+        while (SDL_PollEvent(&e) != 0) {
+            if (e.type == SDL_QUIT) {
+                shutdownAssetLoader(loader);
+                exit(0);
+            }
         }
-        resources->astralTextures[i] = SDL_CreateTextureFromSurface(renderer, astralSurface);
-        SDL_SetTextureBlendMode(resources->astralTextures[i], SDL_BLENDMODE_BLEND);
-        SDL_FreeSurface(astralSurface);
-        checkInit(!resources->astralTextures[i], "Failed to create astral texture");
+
+        uploadDecodedAssets(loader, ASSET_UPLOAD_BUDGET);
+        renderLoadingScreen(renderer, resources, assetLoaderProgress(loader),
+                            loader->last_ready ? loader->last_ready : "");
     }
+    endStartupSpan(span);
+    printAssetTimings(loader);
+
+    // Queued after the loading screen so it does not wait on the decode: the
+    // menu shows right away, the theme starts as soon as it is ready
+    playMusicTrack(&resources->music, resources->menuTrack);
 
     // Initialize volume levels
     resources->musicVolume = 0.5f;        // 30% volume for music
     resources->soundEffectsVolume = 0.5f; // 80% volume for sound effects
     
     // Set initial music volume
-    Mix_VolumeMusic((int)(MIX_MAX_VOLUME * resources->musicVolume));
-
-    // Load music
-    resources->music = Mix_LoadMUS("music/pinball-theme.mp3");
-    checkInitMix(resources->music == NULL, "Failed to load music");
-    checkInitMix(Mix_PlayMusic(resources->music, -1) == -1, "Failed to play music");
-
-    // Load sound effects
-    resources->discoverySound = Mix_LoadWAV("music/effects/ting.wav");
-    resources->wowSound = Mix_LoadWAV("music/effects/wow.wav");
-    resources->aceSound = Mix_LoadWAV("music/effects/ace.wav");
-    if (!resources->discoverySound) printf("Warning: Failed to load discovery sound: %s\n", Mix_GetError());
-    if (!resources->wowSound) printf("Warning: Failed to load wow sound: %s\n", Mix_GetError());
-    if (!resources->aceSound) printf("Warning: Failed to load ace sound: %s\n", Mix_GetError());
-    
-    // Initialize fonts
-    resources->uiFont = initFont("fonts/sft.ttf", 20);
-    resources->font = initFont("fonts/sft.ttf", 40);
-    resources->titleFont = initFont("fonts/sft.ttf", 48);
+    setMusicStreamVolume(&resources->music, resources->musicVolume);
 
     // Initialize background position
     resources->bg_x = 0;
@@ -287,19 +288,17 @@ void initUIElements(UIElements* ui, SDL_Window* window) {
     // GENERAL
     ui->nbMenuButtons = 3;
     ui->nbOptionsButtons = 4;
-    ui->menuButtons = malloc(ui->nbMenuButtons * sizeof(MenuListItem));
-    ui->optionsButtons = malloc(ui->nbOptionsButtons * sizeof(MenuListItem));
+    ui->menuButtons = memAlloc(ui->nbMenuButtons * sizeof(MenuListItem), MEM_UI);
+    ui->optionsButtons = memAlloc(ui->nbOptionsButtons * sizeof(MenuListItem), MEM_UI);
     
     const int BUTTON_WIDTH = 200;
     const int BUTTON_HEIGHT = 60;
 
-    ui->yellow = (SDL_Color){ 255, 230, 0, 0 };
-    ui->white = (SDL_Color){ 255, 255, 255, 0 };
-    ui->darkBlue = (SDL_Color){ 26, 28, 58, 0 };
-    ui->blue = (SDL_Color){ 39, 44, 92, 0 };
-
-    // Title text dimensions
-    ui->titleRect = (SDL_Rect){ (screenWidth - 400) / 2, 30, 400, 60 };
+    // Opaque: the menus are drawn into a transparent texture
+    ui->yellow = (SDL_Color){ 255, 230, 0, 255 };
+    ui->white = (SDL_Color){ 255, 255, 255, 255 };
+    ui->darkBlue = (SDL_Color){ 26, 28, 58, 255 };
+    ui->blue = (SDL_Color){ 39, 44, 92, 255 };
 
     // MAIN MENU UI
     char* names[3] = {"Start", "Options", "Quit"};
@@ -315,7 +314,7 @@ void initUIElements(UIElements* ui, SDL_Window* window) {
             .slider = {{' '}},
             .checkbox = {0},
             .type = TYPE_BUTTON,
-            .text = strdup(names[i]),
+            .text = memStrdup(names[i], MEM_UI),
             .textColor = ui->yellow,
             .hoverColor = ui->white,
             .w = BUTTON_WIDTH,
@@ -341,7 +340,7 @@ void initUIElements(UIElements* ui, SDL_Window* window) {
         .slider = s,
         .checkbox = {0},
         .type = TYPE_SLIDER,
-        .text = strdup("Music"),
+        .text = memStrdup("Music", MEM_UI),
         .textColor = ui->yellow,
         .hoverColor = ui->white,
         .w = MENU_OFFSET+s.length+200, // text + slider + %
@@ -364,7 +363,7 @@ void initUIElements(UIElements* ui, SDL_Window* window) {
         .slider = s2,
         .checkbox = {0},
         .type = TYPE_SLIDER,
-        .text = strdup("Sound FX"),
+        .text = memStrdup("Sound FX", MEM_UI),
         .textColor = ui->yellow,
         .hoverColor = ui->white,
         .w = MENU_OFFSET+s2.length+200,
@@ -384,7 +383,7 @@ void initUIElements(UIElements* ui, SDL_Window* window) {
         .slider = {{' '}},
         .checkbox = c,
         .type = TYPE_CHECKBOX,
-        .text = strdup("Hard mode"),
+        .text = memStrdup("Hard mode", MEM_UI),
         .textColor = ui->yellow,
         .hoverColor = ui->white,
         .w = MENU_OFFSET+100, // text + box
@@ -403,7 +402,7 @@ void initUIElements(UIElements* ui, SDL_Window* window) {
         .slider = {{' '}},
         .checkbox = {0},
         .type = TYPE_BUTTON,
-        .text = strdup("Back"),
+        .text = memStrdup("Back", MEM_UI),
         .textColor = ui->yellow,
         .hoverColor = ui->white,
         .w = BUTTON_WIDTH,
@@ -415,29 +414,117 @@ void initUIElements(UIElements* ui, SDL_Window* window) {
     ui->draggingMusic = 0;
     ui->draggingSfx = 0;
 
-    // Game screen elements
-    ui->pauseButtonRect = (SDL_Rect){ screenWidth - 50 - MENU_MARGIN_RIGHT, 10, 50, 50 };
-    ui->scoreRect = (SDL_Rect){ MENU_MARGIN_RIGHT, 10, MENU_OFFSET, 50 };
+    // Positions of everything above, the menu layer is created on first draw
+    ui->menuLayer = NULL;
+    ui->menuLayerRedraws = 0;
+    ui->menuLayerLoads = 0;
+    ui->background = 0;
+    layoutUI(ui, screenWidth, screenHeight);
+
+    initPerfOverlay(&ui->overlay, 1000.0f / FPS);
+}
+
+void cleanupUIElements(UIElements* ui) {
+    destroyTrackedTexture(ui->menuLayer);
+    ui->menuLayer = NULL;
+    destroyPerfOverlay(&ui->overlay);
+    for (int i = 0; i < ui->nbMenuButtons; i++) memFree(ui->menuButtons[i].text);
+    for (int i = 0; i < ui->nbOptionsButtons; i++) memFree(ui->optionsButtons[i].text);
+    memFree(ui->menuButtons);
+    memFree(ui->optionsButtons);
+    ui->menuButtons = NULL;
+    ui->optionsButtons = NULL;
+    ui->nbMenuButtons = 0;
+    ui->nbOptionsButtons = 0;
 }
 
-void initGame(Game* game) {
+// Fills in what the command line left at 0, with the defaults or the stress sizes
+void initWorldConfig(WorldConfig* config, int stress) {
+    if (config->num_stars <= 0) config->num_stars = stress ? STRESS_STARS : DEFAULT_STARS;
+    if (config->starfield_radius <= 0) config->starfield_radius = DEFAULT_STARFIELD_RADIUS;
+    // Stress objects spread over the whole starfield, not just around the sun
+    if (config->astral_radius <= 0) config->astral_radius = stress ? config->starfield_radius : DEFAULT_ASTRAL_RADIUS;
+    if (config->max_bullets <= 0) config->max_bullets = stress ? STRESS_BULLETS : DEFAULT_BULLETS;
+    if (config->gravity_cell <= 0) config->gravity_cell = GRAVITY_CELL_SIZE;
+
+    int objects = 0;
+    for (int i = 0; i < ASTRAL_TYPES; i++) objects += config->astral_counts[i];
+    if (objects > 0) return;
+    if (stress) {
+        setAstralObjectCount(config, STRESS_ASTRAL_OBJECTS);
+    } else {
+        config->astral_counts[0] = DEFAULT_CLOUDS;
+        config->astral_counts[1] = DEFAULT_NEBULAE;
+        config->astral_counts[2] = DEFAULT_NOVAE;
+        config->astral_counts[3] = DEFAULT_VORTICES;
+    }
+}
+
+// Split in the same proportions as the defaults, clouds take the remainder
+void setAstralObjectCount(WorldConfig* config, int count) {
+    const int defaults[ASTRAL_TYPES] = { DEFAULT_CLOUDS, DEFAULT_NEBULAE, DEFAULT_NOVAE, DEFAULT_VORTICES };
+    const int total = DEFAULT_CLOUDS + DEFAULT_NEBULAE + DEFAULT_NOVAE + DEFAULT_VORTICES;
+    int assigned = 0;
+    for (int i = 1; i < ASTRAL_TYPES; i++) {
+        config->astral_counts[i] = count * defaults[i] / total;
+        assigned += config->astral_counts[i];
+    }
+    config->astral_counts[0] = count - assigned;
+}
+
+void initGame(Game* game, const WorldConfig* config) {
+    game->maxBullets = config->max_bullets;
+    game->bullets = memCalloc(game->maxBullets, sizeof(SDL_Rect), MEM_WORLD);
+    checkInit(!game->bullets, "Failed to allocate the bullets!");
+
     game->screen = MAIN_MENU;
     game->isSound = 1;
     game->isHard = 0;
-    game->score = 0;
     game->shipLevel = 1;
     game->numBullets = 0;
-    game->objectivesFinished = 0;
-    game->keyState = SDL_GetKeyboardState(NULL);
+    memset(&game->controls, 0, sizeof(game->controls));
+    memset(&game->player, 0, sizeof(game->player));  // initSimPlayer once the world exists
+    game->net = NULL;
+    initInput(&game->input);
+    loadInputBindings(&game->input, INPUT_BINDINGS_PATH);
+}
+
+void cleanupGame(Game* game) {
+    memFree(game->bullets);
+    game->bullets = NULL;
+    game->maxBullets = 0;
+    destroySimPlayer(&game->player);
+}
+
+// Stars and astral objects are sized by the config, generateStarfield and
+// initAstralObjects fill them in
+void initWorld(BackgroundEffects* bg_effects, const WorldConfig* config) {
+    bg_effects->config = *config;
+
+    bg_effects->stars = memCalloc(config->num_stars, sizeof(Star), MEM_WORLD);
+    checkInit(!bg_effects->stars, "Failed to allocate the starfield!");
+    bg_effects->num_stars = 0;
+
+    int objects = 0;
+    for (int i = 0; i < ASTRAL_TYPES; i++) objects += config->astral_counts[i];
+    bg_effects->astral_objects = memCalloc(objects, sizeof(AstralObject), MEM_WORLD);
+    checkInit(!bg_effects->astral_objects, "Failed to allocate the astral objects!");
+    bg_effects->num_astral_objects = objects;
+}
+
+void destroyWorld(BackgroundEffects* bg_effects) {
+    memFree(bg_effects->stars);
+    memFree(bg_effects->astral_objects);
+    bg_effects->stars = NULL;
+    bg_effects->astral_objects = NULL;
+    bg_effects->num_stars = bg_effects->num_astral_objects = 0;
 }
 
 void initFighter(Fighter* fighter, int windowWidth, int windowHeight) {
     // Load spaceship image (texture should be loaded separately)
-    fighter->speed_x = 0;
-    fighter->speed_y = 0;
+    fighter->texture = NULL;
     fighter->x = windowWidth / 2 - FIGHTER_WIDTH / 2;
     fighter->y = windowHeight / 2 - FIGHTER_HEIGHT / 2;
-    fighter->angle = 0;
     fighter->rect = (SDL_Rect){ fighter->x, fighter->y, FIGHTER_WIDTH, FIGHTER_HEIGHT };
 
     // Initialize thruster state for dual thrusters
@@ -454,103 +541,102 @@ void initFighter(Fighter* fighter, int windowWidth, int windowHeight) {
     fighter->thruster.right_offset.y = FIGHTER_HEIGHT / 2 + 5; // Below ship
 }
 
-void initSolarSystem(BackgroundEffects* bg_effects) {
-    // Realistic relative distances and speeds (scaled for gameplay)
-    PlanetDefinition planet_defs[NUM_PLANETS] = {
-        // Sun (stationary at center)
-        {"Soleil",   0.0f,     0.0f,  40.0f,   3762,  27.4},  // radius, angle, speed, width, gravity
-        
-        // Planets with increasing distance and decreasing speed
-        {"Mercure",  320.0f,   0.0f,  17.7f,   392,   3.7},
-        {"Venus",    480.0f,   1.2f,  12.98f,  564,   8.87},
-        {"Terre",    640.0f,   2.4f,  11.04f,  576,   9.81},
-        {"Mars",     800.0f,   3.1f,  8.93f,   447,   3.73},
-        {"Jupiter",  1120.0f,  4.5f,  8.9f,    1500,  24.79}, // rings
-        {"Saturne",  1440.0f,  5.8f,  3.6f,    2788,  10.44},
-        {"Uranus",   1760.0f,  0.7f,  2.53f,   2000,  8.69}, // rings
-        {"Neptune",  2080.0f,  1.9f,  2.0f,    988,   11.15}
-    };
-    printf("%f\n", planet_defs[0].gravity);
+void initSolarSystem(BackgroundEffects* bg_effects, const GameData* data) {
+    // Orbits, sizes and masses come from the [game] section of physics.info,
+    // in texture order (sun first, stationary at the center)
+    checkInit(data->num_game_bodies != NUM_PLANETS, "physics.info [game] must list the sun and 8 planets!");
     
     for (int i = 0; i < NUM_PLANETS; i++) {
-        bg_effects->planets[i].orbit_radius = planet_defs[i].orbit_radius;
-        bg_effects->planets[i].orbit_angle = planet_defs[i].start_angle;
-        bg_effects->planets[i].orbit_speed = planet_defs[i].orbit_speed;
-        bg_effects->planets[i].width = planet_defs[i].width;
-        bg_effects->planets[i].mass = planet_defs[i].gravity;
+        bg_effects->planets[i].orbit_angle = gameBody(data, i)->start_angle;
         bg_effects->planets[i].texture_index = i;
-        strncpy(bg_effects->planets[i].name, planet_defs[i].name, 19);
-        bg_effects->planets[i].name[19] = '\0';
     }
+    applySolarSystemData(bg_effects, data);
     
     printf("Solar system initialized with %d planets\n", NUM_PLANETS);
 }
 
+// Everything but the current orbit angle, so a data reload doesn't teleport the planets
+void applySolarSystemData(BackgroundEffects* bg_effects, const GameData* data) {
+    for (int i = 0; i < NUM_PLANETS && i < data->num_game_bodies; i++) {
+        const BodyRecord* body = gameBody(data, i);
+        bg_effects->planets[i].orbit_radius = body->orbit_radius;
+        bg_effects->planets[i].orbit_speed = body->orbit_speed;
+        bg_effects->planets[i].width = body->width;
+        bg_effects->planets[i].mass = body->mass;
+        strncpy(bg_effects->planets[i].name, body->label, 19);
+        bg_effects->planets[i].name[19] = '\0';
+    }
+}
+
 void generateStarfield(BackgroundEffects* bg_effects) {
-    bg_effects->num_stars = MAX_STARS;
+    bg_effects->num_stars = bg_effects->config.num_stars;
     
     for (int i = 0; i < bg_effects->num_stars; i++) {
-        // Random position within 10k radius circle
+        // Random position within the starfield circle
         float angle = (rand() % 360) * M_PI / 180.0f;
         float random_0_to_1 = (float)rand() / (float)RAND_MAX;
-        float distance = sqrtf(random_0_to_1) * STARFIELD_RADIUS;
+        float distance = sqrtf(random_0_to_1) * bg_effects->config.starfield_radius;
         
         bg_effects->stars[i].position.x = cos(angle) * distance;
         bg_effects->stars[i].position.y = sin(angle) * distance;
         
         // Random properties
-        bg_effects->stars[i].texture_index = rand() % 10;
+        bg_effects->stars[i].texture_index = rand() % STAR_TEXTURES;
         bg_effects->stars[i].scale = 0.3f + (rand() % 70) / 100.0f;  // 0.3 - 1.0
         bg_effects->stars[i].rotation = rand() % 360;
         bg_effects->stars[i].brightness = 0.5f + (rand() % 50) / 100.0f;  // 0.5 - 1.0
     }
-    
-    printf("Generated %d stars in %d px radius\n", MAX_STARS, STARFIELD_RADIUS);
 }
 
 void initAstralObjects(BackgroundEffects* bg_effects, GameResources* resources) {
-    const int SPAWN_RADIUS = 2000;
-    int object_index = 0;
-    int texture_w, texture_h;
-    
-    // Spawn Nebulae (Type 0)
-    SDL_QueryTexture(resources->astralTextures[0], NULL, NULL, &texture_w, &texture_h);
-    for (int i = 0; i < CLOUD_COUNT; i++) {
-        AstralObject* obj = &bg_effects->astral_objects[object_index++];
-        setupAstralObject(obj, 0, SPAWN_RADIUS, CLOUD_SCORE);
-        obj->w = texture_w;
-        obj->h = texture_h;
-    }
-    
-    // Spawn Galaxies (Type 1)
-    SDL_QueryTexture(resources->astralTextures[1], NULL, NULL, &texture_w, &texture_h);
-    for (int i = 0; i < NEBULA_COUNT; i++) {
-        AstralObject* obj = &bg_effects->astral_objects[object_index++];
-        setupAstralObject(obj, 1, SPAWN_RADIUS, NEBULA_SCORE);
-        obj->w = texture_w;
-        obj->h = texture_h;
-    }
-    
-    // Spawn Nebulae II (Type 2)
-    SDL_QueryTexture(resources->astralTextures[2], NULL, NULL, &texture_w, &texture_h);
-    for (int i = 0; i < NOVA_COUNT; i++) {
-        AstralObject* obj = &bg_effects->astral_objects[object_index++];
-        setupAstralObject(obj, 2, SPAWN_RADIUS, NOVA_SCORE);
-        obj->w = texture_w;
-        obj->h = texture_h;
+    // Discovery distances scale with the texture sizes
+    SDL_Point sizes[ASTRAL_TYPES] = {0};
+    for (int type = 0; type < ASTRAL_TYPES; type++) {
+        getTextureSize(&resources->textures, resources->astralTextures[type], &sizes[type].x, &sizes[type].y);
     }
+    spawnAstralObjects(bg_effects, sizes);
+}
+
+// The world holds a reference on every texture its objects draw, so the
+// texture manager only evicts them once they have been off screen a while
+static void holdWorldTextures(BackgroundEffects* bg_effects, GameResources* resources, void (*hold)(TextureManager*, TextureHandle)) {
+    TextureManager* tm = &resources->textures;
+    for (int i = 0; i < bg_effects->num_stars; i++) hold(tm, resources->starTextures[bg_effects->stars[i].texture_index]);
+    for (int i = 0; i < NUM_PLANETS; i++) hold(tm, resources->planetTextures[bg_effects->planets[i].texture_index]);
+    for (int i = 0; i < bg_effects->num_astral_objects; i++) hold(tm, resources->astralTextures[bg_effects->astral_objects[i].texture_index]);
+
+    // The fighter's own sprites live as long as the world it flies in
+    for (int i = 0; i < 4; i++) hold(tm, resources->thrusterTextures[i]);
+    hold(tm, resources->bulletTexture);
+}
+
+void acquireWorldTextures(BackgroundEffects* bg_effects, GameResources* resources) {
+    holdWorldTextures(bg_effects, resources, acquireTexture);
+}
+
+// Before destroyWorld
+void releaseWorldTextures(BackgroundEffects* bg_effects, GameResources* resources) {
+    holdWorldTextures(bg_effects, resources, releaseTexture);
+}
+
+// Without textures (the server): sizes are the image sizes, per type
+void spawnAstralObjects(BackgroundEffects* bg_effects, const SDL_Point sizes[ASTRAL_TYPES]) {
+    const WorldConfig* config = &bg_effects->config;
+    const int scores[ASTRAL_TYPES] = { CLOUD_SCORE, NEBULA_SCORE, NOVA_SCORE, VORTEX_SCORE };
+    int object_index = 0;
     
-    // Spawn Galaxies II (Type 3)
-    SDL_QueryTexture(resources->astralTextures[3], NULL, NULL, &texture_w, &texture_h);
-    for (int i = 0; i < VORTEX_COUNT; i++) {
-        AstralObject* obj = &bg_effects->astral_objects[object_index++];
-        setupAstralObject(obj, 3, SPAWN_RADIUS, VORTEX_SCORE);
-        obj->w = texture_w;
-        obj->h = texture_h;
+    // Types in texture order: nebulae, galaxies, nebulae II, galaxies II
+    for (int type = 0; type < ASTRAL_TYPES; type++) {
+        for (int i = 0; i < config->astral_counts[type]; i++) {
+            AstralObject* obj = &bg_effects->astral_objects[object_index++];
+            setupAstralObject(obj, type, config->astral_radius, scores[type]);
+            obj->w = sizes[type].x;
+            obj->h = sizes[type].y;
+        }
     }
     
     printf("Spawned astral objects: %d nebulae, %d galaxies, %d nebulae II, %d galaxies II\n",
-           CLOUD_COUNT, NEBULA_COUNT, NOVA_COUNT, VORTEX_COUNT);
+           config->astral_counts[0], config->astral_counts[1], config->astral_counts[2], config->astral_counts[3]);
 }
 
 // Helper function to setup individual astral objects
@@ -566,7 +652,6 @@ void setupAstralObject(AstralObject* obj, int type, int spawn_radius, int score_
     // Set properties based on type
     obj->texture_index = type;
     obj->score_value = score_value;
-    obj->discovered = 0;
     
     // Random properties with type-specific ranges
     switch (type) {
@@ -587,45 +672,17 @@ void setupAstralObject(AstralObject* obj, int type, int spawn_radius, int score_
     obj->rotation = rand() % 360;
 }
 
-void initDiscoverySystem(Game* game) {
-    // Initialize counts to zero
-    for (int i = 0; i < 4; i++) {
-        game->discovery.discovered_count[i] = 0;
-        game->discovery.total_count[i] = 0;
-        game->discovery.total_score[i] = 0;
-    }
-    game->discovery.total_discovered = 0;
-    game->discovery.total_score_earned = 0;
-    
-    // Set total counts based on our constants
-    game->discovery.total_count[0] = CLOUD_COUNT;
-    game->discovery.total_count[1] = NEBULA_COUNT;
-    game->discovery.total_count[2] = NOVA_COUNT;
-    game->discovery.total_count[3] = VORTEX_COUNT;
-}
-
 void cleanupResources(GameResources* resources) {
-    if (resources->pauseTexture) SDL_DestroyTexture(resources->pauseTexture);
-    if (resources->checkboxCheckedTexture) SDL_DestroyTexture(resources->checkboxCheckedTexture);
-    if (resources->checkboxUncheckedTexture) SDL_DestroyTexture(resources->checkboxUncheckedTexture);
-    if (resources->bulletTexture) SDL_DestroyTexture(resources->bulletTexture);
-    if (resources->checkmarkTexture) SDL_DestroyTexture(resources->checkmarkTexture);
-    if (resources->fighterTexture) SDL_DestroyTexture(resources->fighterTexture);
-    if (resources->menuBackground) SDL_DestroyTexture(resources->menuBackground);
-    if (resources->optionsBackground) SDL_DestroyTexture(resources->optionsBackground);
-
-    if (resources->music) Mix_FreeMusic(resources->music);
-    if (resources->discoverySound) Mix_FreeChunk(resources->discoverySound);
-    if (resources->wowSound) Mix_FreeChunk(resources->wowSound);
-    if (resources->aceSound) Mix_FreeChunk(resources->aceSound);
-    if (resources->uiFont) TTF_CloseFont(resources->uiFont);
+    shutdownAssetLoader(&resources->loader);
 
-    int i;
-    for (i=0; i<4; i++) SDL_DestroyTexture(resources->thrusterTextures[i]);
-    for (i=0; i<10; i++) SDL_DestroyTexture(resources->starTextures[i]);
-    for (i=0; i<NUM_PLANETS; i++) SDL_DestroyTexture(resources->planetTextures[i]);
-    for (i=0; i<4; i++) SDL_DestroyTexture(resources->astralTextures[i]);
-    
+    printTextureStats(&resources->textures);
+    destroyTextureManager(&resources->textures);
+
+    shutdownMusicStreamer(&resources->music);
+    shutdownVoiceManager(&resources->voices);
+    if (resources->uiFont) TTF_CloseFont(resources->uiFont);
+    if (resources->font) TTF_CloseFont(resources->font);
+    if (resources->titleFont) TTF_CloseFont(resources->titleFont);
     
     Mix_CloseAudio();
     TTF_Quit();
@@ -5,6 +5,14 @@
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
+#include "particles.h"
+#include "assets.h"
+#include "texmgr.h"
+#include "gamedata.h"
+#include "music.h"
+#include "voices.h"
+#include "input.h"
+#include "overlay.h"
 
 /* 
             DEFINITIONS
@@ -19,19 +27,27 @@
     __typeof__ (b) _b = (b); \
     _a < _b ? _a : _b; })
 
-// Cap FPS
+// Cap FPS (capped pacing, the simulation also steps 1/FPS per frame)
 #define FPS 120
-#define FRAME_DELAY 1000/FPS // Durée d'une frame en millisecondes (16ms pour 60 FPS)
 
 #define FIGHTER_WIDTH 40
 #define FIGHTER_HEIGHT 80
 #define FIGHTER_SPEED 2
 #define FIGHTER_MAX_SPEED 20
 #define FIGHTER_MASS 10.0f
-#define MAX_BULLETS 1000
+
+// Audio files (also matched by the hot reload watcher)
+#define MUSIC_THEME_PATH "music/pinball-theme.mp3"
+#define MUSIC_INNER_PATH "music/inner-system.mp3"   // Optional: the theme plays in their region without them
+#define MUSIC_OUTER_PATH "music/outer-system.mp3"
+#define MUSIC_INNER_RADIUS 1000                     // px from the sun, between Mars and Jupiter
+#define SOUND_DISCOVERY_PATH "music/effects/ting.wav"
+#define SOUND_WOW_PATH "music/effects/wow.wav"
+#define SOUND_ACE_PATH "music/effects/ace.wav"
 
 #define MENU_MARGIN_RIGHT 20
 #define MENU_OFFSET 300
+#define MENU_LINE_HEIGHT 80
 
 /* 
             FIGHTER STRUCTURES
@@ -46,11 +62,11 @@ typedef struct {
     float spread_distance;     // Distance from center for each thruster
 } ThrusterState;
 
+// How the player is drawn: always at the same place on screen, the camera
+// follows it. Where it is and how fast it goes is in SimPlayer.
 typedef struct {
     SDL_Texture* texture;
-    int x, y;
-    float speed_x, speed_y;
-    float angle;
+    int x, y;                  // Screen position
     SDL_Rect rect;
     ThrusterState thruster;
 } Fighter;
@@ -59,16 +75,16 @@ typedef struct {
 /* 
             MAP STRUCTURES
 */
+#define STAR_TEXTURES 4        // Star images, each star uses one
+
 typedef struct {
     SDL_Point position;    // World position
-    int texture_index;     // Which star texture to use (0-9)
+    int texture_index;     // Which star texture to use (0 to STAR_TEXTURES - 1)
     float scale;           // Scale of the star (0.5 - 2.0)
     float rotation;        // Random rotation
     float brightness;      // Alpha/opacity (0.5 - 1.0)
 } Star;
 
-#define MAX_STARS 20000
-#define STARFIELD_RADIUS 5000  // 10,000 px radius
 
 typedef struct {
     SDL_Point position;    // Current screen position
@@ -83,15 +99,6 @@ typedef struct {
     SDL_Point world_pos;
 } Planet;
 
-typedef struct {
-    char name[20];
-    float orbit_radius;
-    float start_angle;
-    float orbit_speed;
-    int width;
-    float gravity;
-} PlanetDefinition;
-
 #define NUM_PLANETS 9  // Sun + 8 planets
 #define GRAVITY_FACTOR 1e12
 
@@ -103,19 +110,11 @@ typedef struct {
     float angle;
     float distance;
     int w, h;
-    int discovered;
     int score_value;
 } AstralObject;
 
 #define ASTRAL_TYPES 4        // 4 different types of astral objects
-
-// Different quantities for each type
-#define CLOUD_COUNT 5 
-#define NEBULA_COUNT 3
-#define NOVA_COUNT 4  
-#define VORTEX_COUNT 2
-
-#define TOTAL_ASTRAL_OBJECTS (CLOUD_COUNT + NEBULA_COUNT + NOVA_COUNT + VORTEX_COUNT)
+extern const char* const astralTexturePaths[ASTRAL_TYPES];
 
 // Score values for each type
 #define CLOUD_SCORE 100  
@@ -128,16 +127,78 @@ typedef struct {
     int total_score[4];         // Total score per type
     int total_discovered;       // Total discovered objects
     int total_score_earned;     // Total score from discoveries
+    int total_objects;          // All types
 } DiscoverySystem;
 
+// World sizes, the defaults unless the command line changes them
+#define DEFAULT_STARS 20000
+#define DEFAULT_STARFIELD_RADIUS 5000  // px
+#define DEFAULT_ASTRAL_RADIUS 2000     // Astral objects spawn this close to the sun
+#define DEFAULT_BULLETS 1000
+#define DEFAULT_CLOUDS 5               // Astral objects of each type
+#define DEFAULT_NEBULAE 3
+#define DEFAULT_NOVAE 4
+#define DEFAULT_VORTICES 2
+
+// --stress: scaled up to find where the frame rate breaks
+#define STRESS_STARS 1000000
+#define STRESS_ASTRAL_OBJECTS 10000    // Split between the types like the defaults
+#define STRESS_BULLETS 50000
+
+// 0 fields are filled in by initWorldConfig
 typedef struct {
-    Star stars[MAX_STARS];
+    int num_stars;
+    int starfield_radius;
+    int astral_counts[ASTRAL_TYPES];   // Clouds, nebulae, novae, vortices
+    int astral_radius;
+    int max_bullets;
+    int gravity;                       // GravityMode, GRAVITY_OFF unless --gravity
+    int gravity_cell;                  // px between gravity field nodes
+} WorldConfig;
+
+typedef struct {
+    WorldConfig config;
+    Star* stars;                       // config.num_stars, allocated by initWorld
     int num_stars;
     Planet planets[NUM_PLANETS];
-    AstralObject astral_objects[TOTAL_ASTRAL_OBJECTS];
+    AstralObject* astral_objects;
+    int num_astral_objects;
+    ParticleSystem particles;
+    struct GravityField* gravity_field;
 } BackgroundEffects;
 
 
+/* 
+            SIMULATION STRUCTURES
+*/
+#define SIM_MAX_EVENTS 16              // Discoveries reported per tick, more still count
+
+// Controls held during one tick, from the keyboard or from a bot
+typedef struct {
+    Uint8 thrust, retro, turn_left, turn_right, reset;
+} SimControls;
+
+// Everything a tick changes for one player, stepped by sim.c
+typedef struct {
+    float x, y;                        // Fighter center, world coordinates
+    float speed_x, speed_y;            // px per tick
+    float angle;                       // Degrees, 0 is up
+    float spawn_x, spawn_y;            // Where reset goes back to
+    int thrusting;
+    int score;
+    int objectives_finished;
+    DiscoverySystem discovery;
+    Uint8* discovered;                 // One flag per astral object of the world
+} SimPlayer;
+
+// What a tick did, for the particles and sounds the game adds on top
+typedef struct {
+    int discovered[SIM_MAX_EVENTS];    // Astral object indices
+    int num_discovered;
+    int finished;                      // The last object was found this tick
+} SimEvents;
+
+
 /* 
             GAME STRUCTURES
 */
@@ -153,38 +214,39 @@ typedef struct {
     GameState screen;
     int isSound;
     int isHard;
-    int score;
     int shipLevel;
     int numBullets;
-    int objectivesFinished;
-    SDL_Rect bullets[MAX_BULLETS];
-    const Uint8* keyState;
-    DiscoverySystem discovery;
+    int maxBullets;
+    SDL_Rect* bullets;                 // maxBullets, allocated by initGame
+    InputState input;
+    SimControls controls;              // Set by handleKeyboardInput for the next update
+    SimPlayer player;                  // Position, speed, score and discoveries
+    struct NetClient* net;             // --connect, NULL when playing alone
 } Game;
 
 typedef struct {
     SDL_Window* window;
-    SDL_Texture* fighterTexture;
-    SDL_Texture* thrusterTextures[4];
-    SDL_Texture* pauseTexture;
-    SDL_Texture* checkboxCheckedTexture;
-    SDL_Texture* checkboxUncheckedTexture;
-    SDL_Texture* pauseTexture2;
-    SDL_Texture* checkboxCheckedTexture2;
-    SDL_Texture* checkboxUncheckedTexture2;
-    SDL_Texture* checkmarkTexture;
-    SDL_Texture* bulletTexture;
-    SDL_Texture* starTextures[10];
-    SDL_Texture* planetTextures[NUM_PLANETS];
-    SDL_Texture* astralTextures[4];
-    SDL_Texture* menuBgTexture;
-    SDL_Texture* menuBackground;
-    SDL_Texture* optionsBackground;
+    TextureHandle fighterTexture;
+    TextureHandle thrusterTextures[4];
+    TextureHandle pauseTexture;
+    TextureHandle checkboxCheckedTexture;
+    TextureHandle checkboxUncheckedTexture;
+    TextureHandle pauseTexture2;
+    TextureHandle checkboxCheckedTexture2;
+    TextureHandle checkboxUncheckedTexture2;
+    TextureHandle checkmarkTexture;
+    TextureHandle bulletTexture;
+    TextureHandle starTextures[STAR_TEXTURES];
+    TextureHandle planetTextures[NUM_PLANETS];
+    TextureHandle astralTextures[4];
+    TextureHandle menuBgTexture;
+    TextureHandle menuBackground;
+    TextureHandle optionsBackground;
     int num_star_textures;
-    Mix_Music* music;
-    Mix_Chunk* discoverySound;
-    Mix_Chunk* wowSound;
-    Mix_Chunk* aceSound;
+    MusicStreamer music;
+    int menuTrack, innerTrack, outerTrack;
+    VoiceManager voices;
+    int discoverySfx, wowSfx, aceSfx;   // Sound ids for playSound
     float musicVolume;      // Music volume (0.0 to 1.0)
     float soundEffectsVolume;
     TTF_Font* font;
@@ -193,6 +255,8 @@ typedef struct {
     float bg_x, bg_y;
     int windowWidth, windowHeight;
     int isHoveringPause;
+    AssetLoader loader;
+    TextureManager textures;
 } GameResources;
 
 enum {TYPE_BUTTON, TYPE_SLIDER, TYPE_CHECKBOX};
@@ -229,6 +293,12 @@ typedef struct {
     SDL_Color textColor;
     SDL_Color hoverColor;
     int isHovering;
+
+    // Set by layoutUI, shared by rendering and hit-testing
+    SDL_Rect bounds;                 // Whole row
+    SDL_Rect control;                // Button background, checkbox box, slider track
+    SDL_Rect label;
+    SDL_Rect value;                  // Slider percentage
 } MenuListItem;
 
 typedef struct {
@@ -251,6 +321,19 @@ typedef struct {
     SDL_Color blue;
     int draggingMusic;
     int draggingSfx;
+
+    // Retained menu: laid out once per size, drawn into a texture that is
+    // only redrawn when something on it changes
+    int layoutWidth, layoutHeight;
+    SDL_Texture* menuLayer;
+    GameState menuLayerScreen;       // Menu it shows
+    int menuLayerDirty;
+    Uint64 menuLayerLoads;           // Texture manager uploads it was drawn after
+    Uint64 menuLayerRedraws;
+
+    TextureHandle background;        // Acquired while its menu is shown
+
+    PerfOverlay overlay;             // Over the gameplay, toggled by the overlay key
 } UIElements;
 
 
@@ -266,13 +349,22 @@ SDL_Renderer* initRenderer(SDL_Window* window);
 TTF_Font* initFont(const char* fontPath, int size);
 void initGameResources(SDL_Renderer* renderer, GameResources* resources);
 void initUIElements(UIElements* ui, SDL_Window* window);
-void initGame(Game* game);
+void initWorldConfig(WorldConfig* config, int stress);
+void setAstralObjectCount(WorldConfig* config, int count);
+void initGame(Game* game, const WorldConfig* config);
+void cleanupGame(Game* game);
+void initWorld(BackgroundEffects* bg_effects, const WorldConfig* config);
+void destroyWorld(BackgroundEffects* bg_effects);
 void initFighter(Fighter* fighter, int windowWidth, int windowHeight);
-void initSolarSystem(BackgroundEffects* bg_effects);
+void initSolarSystem(BackgroundEffects* bg_effects, const GameData* data);
+void applySolarSystemData(BackgroundEffects* bg_effects, const GameData* data);
 void generateStarfield(BackgroundEffects* bg_effects);
 void initAstralObjects(BackgroundEffects* bg_effects, GameResources* resources);
+void spawnAstralObjects(BackgroundEffects* bg_effects, const SDL_Point sizes[ASTRAL_TYPES]);
+void acquireWorldTextures(BackgroundEffects* bg_effects, GameResources* resources);
+void releaseWorldTextures(BackgroundEffects* bg_effects, GameResources* resources);
 void setupAstralObject(AstralObject* obj, int type, int spawn_radius, int score_value);
-void initDiscoverySystem(Game* game);
+void cleanupUIElements(UIElements* ui);
 void cleanupResources(GameResources* resources);
 
 #endif
\ No newline at end of file
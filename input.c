@@ -0,0 +1,152 @@
+#include "input.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* actionNames[ACTION_COUNT] = {
+    "thrust", "retro", "turn_left", "turn_right", "reset", "pause", "start", "fullscreen", "quit", "memory_report", "pacing", "profile", "overlay"
+};
+
+static const KeyBinding defaultBindings[] = {
+    { SDL_SCANCODE_UP, ACTION_THRUST },
+    { SDL_SCANCODE_DOWN, ACTION_RETRO },
+    { SDL_SCANCODE_LEFT, ACTION_TURN_LEFT },
+    { SDL_SCANCODE_RIGHT, ACTION_TURN_RIGHT },
+    { SDL_SCANCODE_SPACE, ACTION_RESET },
+    { SDL_SCANCODE_P, ACTION_PAUSE },
+    { SDL_SCANCODE_Q, ACTION_START },         // A on AZERTY keyboard
+    { SDL_SCANCODE_F, ACTION_FULLSCREEN },
+    { SDL_SCANCODE_A, ACTION_QUIT },          // Q on AZERTY keyboard
+    { SDL_SCANCODE_M, ACTION_MEMORY_REPORT }, // , on AZERTY keyboard
+    { SDL_SCANCODE_V, ACTION_PACING },
+    { SDL_SCANCODE_F9, ACTION_PROFILE },
+    { SDL_SCANCODE_F3, ACTION_OVERLAY }
+};
+
+void initInput(InputState* input) {
+    memset(input, 0, sizeof(*input));
+    for (size_t i = 0; i < sizeof(defaultBindings) / sizeof(defaultBindings[0]); i++) {
+        bindKey(input, defaultBindings[i].scancode, defaultBindings[i].action);
+    }
+}
+
+// A key can drive several actions and an action can have several keys.
+// Returns 0 if the table is full.
+int bindKey(InputState* input, SDL_Scancode scancode, InputAction action) {
+    if (input->num_bindings == INPUT_MAX_BINDINGS) {
+        printf("Warning: Too many key bindings, raise INPUT_MAX_BINDINGS\n");
+        return 0;
+    }
+    input->bindings[input->num_bindings++] = (KeyBinding){ scancode, action };
+    return 1;
+}
+
+static int findAction(const char* name) {
+    for (int i = 0; i < ACTION_COUNT; i++) {
+        if (strcmp(actionNames[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+/*
+    input.bindings: one "action key" pair per line, # starts a comment.
+    Keys use SDL scancode names ("Up", "Space", "Left Shift"), which name the
+    physical position on a QWERTY keyboard. When the file has any valid line
+    it replaces the default bindings entirely.
+*/
+void loadInputBindings(InputState* input, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return;
+
+    KeyBinding bindings[INPUT_MAX_BINDINGS];
+    int count = 0;
+    char line[256];
+    int line_number = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        line[strcspn(line, "#\r\n")] = '\0';
+
+        char name[64];
+        int consumed = 0;
+        if (sscanf(line, " %63s %n", name, &consumed) != 1) continue; // blank line
+
+        // The key name is the rest of the line, it may contain spaces
+        char* key = line + consumed;
+        size_t length = strlen(key);
+        while (length > 0 && (key[length - 1] == ' ' || key[length - 1] == '\t')) key[--length] = '\0';
+
+        int action = findAction(name);
+        SDL_Scancode scancode = length > 0 ? SDL_GetScancodeFromName(key) : SDL_SCANCODE_UNKNOWN;
+        if (action < 0 || scancode == SDL_SCANCODE_UNKNOWN) {
+            printf("Warning: %s:%d: bad binding\n", path, line_number);
+            continue;
+        }
+        if (count == INPUT_MAX_BINDINGS) {
+            printf("Warning: Too many key bindings, raise INPUT_MAX_BINDINGS\n");
+            break;
+        }
+        bindings[count++] = (KeyBinding){ scancode, action };
+    }
+    fclose(file);
+
+    if (count == 0) return;
+    memcpy(input->bindings, bindings, sizeof(bindings[0]) * count);
+    input->num_bindings = count;
+}
+
+static Uint64 min64(Uint64 a, Uint64 b) {
+    return a < b ? a : b;
+}
+
+static void queueInputEvent(InputState* input, InputEvent event) {
+    if (input->write - input->read == INPUT_QUEUE_SIZE) {
+        if (input->dropped++ == 0) printf("Warning: Input queue full, raise INPUT_QUEUE_SIZE\n");
+        return;
+    }
+    input->events[input->write++ & (INPUT_QUEUE_SIZE - 1)] = event;
+}
+
+// Returns 1 if the event was a key event, the caller can skip it then.
+// Auto-repeat is ignored: actions only see the first press.
+int handleInputEvent(InputState* input, const SDL_Event* e) {
+    if (e->type != SDL_KEYDOWN && e->type != SDL_KEYUP) return 0;
+    if (e->key.repeat) return 1;
+
+    // The event sat in SDL's queue since its timestamp, move it back by that much
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint32 waited = SDL_GetTicks() - e->key.timestamp;
+    Uint64 counter = now - min64((Uint64)waited * SDL_GetPerformanceFrequency() / 1000, now);
+
+    for (int i = 0; i < input->num_bindings; i++) {
+        if (input->bindings[i].scancode != e->key.keysym.scancode) continue;
+        queueInputEvent(input, (InputEvent){
+            .action = input->bindings[i].action,
+            .pressed = e->type == SDL_KEYDOWN,
+            .timestamp = e->key.timestamp,
+            .counter = counter
+        });
+    }
+    return 1;
+}
+
+// Consumes the events up to until (SDL_GetTicks time), later ones wait for
+// the next tick. A press and release inside the same tick still show as down.
+void sampleInput(InputState* input, Uint32 until, InputTick* tick) {
+    memset(tick, 0, sizeof(*tick));
+    for (int a = 0; a < ACTION_COUNT; a++) tick->down[a] = input->held[a] > 0;
+
+    for (; input->read != input->write; input->read++) {
+        const InputEvent* event = &input->events[input->read & (INPUT_QUEUE_SIZE - 1)];
+        if ((Sint32)(event->timestamp - until) > 0) break;
+
+        int* held = &input->held[event->action];
+        if (event->pressed) {
+            if ((*held)++ == 0) tick->pressed[event->action] = 1;
+            if (tick->num_presses < INPUT_TICK_PRESSES) tick->press_counters[tick->num_presses++] = event->counter;
+            tick->down[event->action] = 1;
+        } else if (*held > 0) {
+            // Keys already down when the window got focus only send a release
+            if (--(*held) == 0) tick->released[event->action] = 1;
+        }
+    }
+}
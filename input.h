@@ -0,0 +1,81 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SDL2/SDL.h>
+
+/*
+            DEFINITIONS
+*/
+#define INPUT_BINDINGS_PATH "data/input.bindings"  // Optional, the defaults apply without it
+#define INPUT_MAX_BINDINGS 64
+#define INPUT_QUEUE_SIZE 256                       // Key edges waiting for a tick, power of two
+#define INPUT_TICK_PRESSES 8                       // Press times kept per tick for latency tracking
+
+// What the game reacts to, keys are mapped to these through the bindings
+typedef enum {
+    ACTION_THRUST,
+    ACTION_RETRO,                    // Turn against the movement, then thrust
+    ACTION_TURN_LEFT,
+    ACTION_TURN_RIGHT,
+    ACTION_RESET,
+    ACTION_PAUSE,
+    ACTION_START,
+    ACTION_FULLSCREEN,
+    ACTION_QUIT,
+    ACTION_MEMORY_REPORT,
+    ACTION_PACING,                   // Cycle the frame pacing mode
+    ACTION_PROFILE,                  // Write a frame trace
+    ACTION_OVERLAY,                  // Show the performance overlay
+    ACTION_COUNT
+} InputAction;
+
+/*
+            INPUT STRUCTURES
+*/
+typedef struct {
+    SDL_Scancode scancode;           // Physical key: SDL_SCANCODE_Q is A on AZERTY
+    InputAction action;
+} KeyBinding;
+
+typedef struct {
+    InputAction action;
+    int pressed;                     // 0 for a release
+    Uint32 timestamp;                // SDL event time, milliseconds
+    Uint64 counter;                  // Same moment on the performance counter
+} InputEvent;
+
+// What happened to each action during one tick
+typedef struct {
+    Uint8 down[ACTION_COUNT];        // Held at some point: a tap shorter than a tick still counts
+    Uint8 pressed[ACTION_COUNT];     // Press edges
+    Uint8 released[ACTION_COUNT];
+    Uint64 press_counters[INPUT_TICK_PRESSES];  // When the presses happened, for the latency tracker
+    int num_presses;
+} InputTick;
+
+// Key edges come from the SDL event queue, not from polling the keyboard
+// state, so nothing is missed between two frames and one-shot actions need
+// no debouncing. They wait in a queue until sampleInput consumes the ones up
+// to the end of a tick.
+typedef struct {
+    KeyBinding bindings[INPUT_MAX_BINDINGS];
+    int num_bindings;
+
+    InputEvent events[INPUT_QUEUE_SIZE];
+    Uint32 read, write;
+
+    int held[ACTION_COUNT];          // Bound keys down, after the consumed events
+    Uint64 dropped;                  // Queue was full
+} InputState;
+
+
+/*
+            DECLARATIONS
+*/
+void initInput(InputState* input);
+int bindKey(InputState* input, SDL_Scancode scancode, InputAction action);
+void loadInputBindings(InputState* input, const char* path);
+int handleInputEvent(InputState* input, const SDL_Event* e);
+void sampleInput(InputState* input, Uint32 until, InputTick* tick);
+
+#endif
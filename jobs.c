@@ -0,0 +1,137 @@
+#include "jobs.h"
+#include "init.h"      // checkInit
+#include "memtrack.h"
+#include "profiler.h"
+#include <string.h>
+
+static int popRange(JobQueue* queue, JobRange* range) {
+    int found = 0;
+    SDL_AtomicLock(&queue->lock);
+    if (queue->top < queue->bottom) {
+        *range = queue->ranges[--queue->bottom];
+        found = 1;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return found;
+}
+
+// Oldest range of the next worker that has one
+static int stealRange(JobPool* pool, int self, JobRange* range) {
+    for (int i = 1; i < pool->num_workers; i++) {
+        JobQueue* victim = &pool->queues[(self + i) % pool->num_workers];
+        int found = 0;
+        SDL_AtomicLock(&victim->lock);
+        if (victim->top < victim->bottom) {
+            *range = victim->ranges[victim->top++];
+            found = 1;
+        }
+        SDL_AtomicUnlock(&victim->lock);
+        if (found) {
+            SDL_AtomicAdd(&pool->steals, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Own queue first, then the others', until every queue is empty
+static void workUntilEmpty(JobPool* pool, int self) {
+    JobRange range;
+    while (popRange(&pool->queues[self], &range) || stealRange(pool, self, &range)) {
+        range.function(range.data, range.begin, range.end);
+        SDL_AtomicAdd(&pool->pending, -1);
+    }
+}
+
+static int jobWorker(void* data) {
+    JobWorker* worker = data;
+    JobPool* pool = worker->pool;
+    nameProfilerThread("jobs");
+
+    int seen = 0;
+    for (;;) {
+        SDL_LockMutex(pool->lock);
+        while (pool->generation == seen && !pool->quit) SDL_CondWait(pool->wake, pool->lock);
+        seen = pool->generation;
+        int quit = pool->quit;
+        SDL_UnlockMutex(pool->lock);
+        if (quit) return 0;
+
+        workUntilEmpty(pool, worker->index);
+    }
+}
+
+// workers counts the calling thread, 0 for one per core
+void initJobPool(JobPool* pool, int workers) {
+    memset(pool, 0, sizeof(*pool));
+    if (workers <= 0) workers = SDL_GetCPUCount();
+    pool->num_workers = SDL_min(SDL_max(workers, 1), JOB_MAX_WORKERS);
+
+    pool->queues = memCalloc(pool->num_workers, sizeof(JobQueue), MEM_GENERAL);
+    pool->lock = SDL_CreateMutex();
+    pool->wake = SDL_CreateCond();
+    checkInit(!pool->queues || !pool->lock || !pool->wake, "Failed to create the job pool!");
+
+    for (int i = 1; i < pool->num_workers; i++) {
+        pool->workers[i] = (JobWorker){ pool, i };
+        pool->threads[i] = SDL_CreateThread(jobWorker, "jobs", &pool->workers[i]);
+        checkInit(!pool->threads[i], "Failed to create a job worker!");
+    }
+}
+
+void destroyJobPool(JobPool* pool) {
+    if (!pool->lock) return;
+
+    SDL_LockMutex(pool->lock);
+    pool->quit = 1;
+    SDL_CondBroadcast(pool->wake);
+    SDL_UnlockMutex(pool->lock);
+
+    for (int i = 1; i < pool->num_workers; i++) SDL_WaitThread(pool->threads[i], NULL);
+
+    SDL_DestroyCond(pool->wake);
+    SDL_DestroyMutex(pool->lock);
+    memFree(pool->queues);
+    memset(pool, 0, sizeof(*pool));
+}
+
+// Splits [0, count) in ranges of grain items, hands each worker a contiguous
+// share and returns once all of them ran. The caller works too.
+void runJobs(JobPool* pool, JobFunction function, void* data, int count, int grain) {
+    if (count <= 0) return;
+    PROFILE_FUNCTION();
+
+    int capacity = pool->num_workers * JOB_QUEUE_SIZE;
+    if (grain < 1) grain = 1;
+    if ((count + grain - 1) / grain > capacity) grain = (count + capacity - 1) / capacity;
+    int ranges = (count + grain - 1) / grain;
+
+    // The previous batch is done, every queue is empty: a worker still looking
+    // at them finds nothing or a range of this batch, which is fine
+    SDL_AtomicSet(&pool->pending, ranges);
+    for (int w = 0; w < pool->num_workers; w++) {
+        JobQueue* queue = &pool->queues[w];
+        int first = (int)((long long)ranges * w / pool->num_workers);
+        int last = (int)((long long)ranges * (w + 1) / pool->num_workers);
+
+        SDL_AtomicLock(&queue->lock);
+        queue->top = queue->bottom = 0;
+        for (int r = first; r < last; r++) {
+            int begin = r * grain;
+            queue->ranges[queue->bottom++] = (JobRange){ function, data, begin, SDL_min(begin + grain, count) };
+        }
+        SDL_AtomicUnlock(&queue->lock);
+    }
+
+    if (pool->num_workers > 1) {
+        SDL_LockMutex(pool->lock);
+        pool->generation++;
+        SDL_CondBroadcast(pool->wake);
+        SDL_UnlockMutex(pool->lock);
+    }
+
+    workUntilEmpty(pool, 0);
+
+    // Ranges other workers are still running: short, spin
+    while (SDL_AtomicGet(&pool->pending) > 0) {}
+}
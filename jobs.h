@@ -0,0 +1,62 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <SDL2/SDL.h>
+
+/*
+            DEFINITIONS
+*/
+#define JOB_MAX_WORKERS 64           // Threads, the calling one included
+#define JOB_QUEUE_SIZE 1024          // Ranges per worker and batch, runJobs widens the grain to fit
+
+/*
+            JOB STRUCTURES
+*/
+// Runs items [begin, end) of a batch
+typedef void (*JobFunction)(void* data, int begin, int end);
+
+typedef struct {
+    JobFunction function;
+    void* data;
+    int begin, end;
+} JobRange;
+
+// Owner pushes and pops at the bottom, thieves take from the top: the owner
+// keeps working through what it was given (warm in its cache), others take
+// the oldest, largest-remaining share. A spinlock per queue, held for a few
+// instructions, is cheaper here than getting a lock-free deque right.
+typedef struct {
+    SDL_SpinLock lock;
+    int top, bottom;                 // Ranges left are [top, bottom)
+    JobRange ranges[JOB_QUEUE_SIZE];
+} JobQueue;
+
+typedef struct {
+    struct JobPool* pool;
+    int index;                       // Its queue
+} JobWorker;
+
+typedef struct JobPool {
+    int num_workers;                 // Queue 0 belongs to the thread calling runJobs
+    SDL_Thread* threads[JOB_MAX_WORKERS];
+    JobWorker workers[JOB_MAX_WORKERS];
+    JobQueue* queues;
+
+    SDL_mutex* lock;                 // Guards generation and quit, workers sleep on wake
+    SDL_cond* wake;
+    int generation;                  // Bumped by every batch
+    int quit;
+
+    SDL_atomic_t pending;            // Ranges of the current batch not finished
+    SDL_atomic_t steals;             // Ranges run by another worker than their owner
+} JobPool;
+
+
+/*
+            DECLARATIONS
+*/
+void initJobPool(JobPool* pool, int workers);
+void destroyJobPool(JobPool* pool);
+void runJobs(JobPool* pool, JobFunction function, void* data, int count, int grain);
+
+#endif
@@ -0,0 +1,75 @@
+#include "latency.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void initLatencyTracker(LatencyTracker* lt) {
+    memset(lt, 0, sizeof(*lt));
+}
+
+// Right after sampleInput
+void latencyTickConsumed(LatencyTracker* lt, const InputTick* tick) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    for (int i = 0; i < tick->num_presses; i++) {
+        if (lt->num_pending == LATENCY_PENDING) {
+            lt->dropped++;
+            continue;
+        }
+        lt->pending[lt->num_pending++] = (PendingPress){ tick->press_counters[i], now };
+    }
+}
+
+// Right after SDL_RenderPresent returns
+void latencyFramePresented(LatencyTracker* lt) {
+    if (lt->num_pending == 0) return;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    double ms = 1000.0 / SDL_GetPerformanceFrequency();
+    for (int i = 0; i < lt->num_pending; i++) {
+        PendingPress* press = &lt->pending[i];
+        lt->total_ms[lt->next] = (float)((now - press->event) * ms);
+        lt->queue_ms[lt->next] = (float)((press->consumed - press->event) * ms);
+        lt->next = (lt->next + 1) % LATENCY_WINDOW;
+        if (lt->count < LATENCY_WINDOW) lt->count++;
+        lt->presses++;
+    }
+    lt->num_pending = 0;
+}
+
+static int compareFloats(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank on a sorted copy
+static float percentile(const float* sorted, int count, float p) {
+    return sorted[(int)(p * (count - 1) + 0.5f)];
+}
+
+// All zero until the first press has been presented
+void getLatencyReport(const LatencyTracker* lt, LatencyReport* report) {
+    memset(report, 0, sizeof(*report));
+    if (lt->count == 0) return;
+
+    float sorted[LATENCY_WINDOW];
+    memcpy(sorted, lt->total_ms, sizeof(float) * lt->count);
+    qsort(sorted, lt->count, sizeof(float), compareFloats);
+    report->p50 = percentile(sorted, lt->count, 0.50f);
+    report->p99 = percentile(sorted, lt->count, 0.99f);
+    report->max = sorted[lt->count - 1];
+
+    memcpy(sorted, lt->queue_ms, sizeof(float) * lt->count);
+    qsort(sorted, lt->count, sizeof(float), compareFloats);
+    report->queue_p50 = percentile(sorted, lt->count, 0.50f);
+    report->queue_p99 = percentile(sorted, lt->count, 0.99f);
+    report->samples = lt->count;
+}
+
+void printLatencyStats(const LatencyTracker* lt) {
+    LatencyReport report;
+    getLatencyReport(lt, &report);
+    printf("Input latency: %llu presses, last %d: p50 %.1f ms, p99 %.1f ms, max %.1f ms (waiting for a tick: p50 %.1f ms, p99 %.1f ms)\n",
+           (unsigned long long)lt->presses, report.samples, report.p50, report.p99, report.max,
+           report.queue_p50, report.queue_p99);
+    if (lt->dropped > 0) printf("Input latency: %llu presses not tracked\n", (unsigned long long)lt->dropped);
+}
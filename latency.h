@@ -0,0 +1,54 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <SDL2/SDL.h>
+#include "input.h"
+
+/*
+            DEFINITIONS
+*/
+#define LATENCY_WINDOW 256           // Rolling window the percentiles are taken over
+#define LATENCY_PENDING 64           // Presses consumed but not presented yet
+
+/*
+            LATENCY STRUCTURES
+*/
+typedef struct {
+    Uint64 event;                    // Key press, performance counter
+    Uint64 consumed;                 // Tick that sampled it
+} PendingPress;
+
+typedef struct {
+    float p50, p99, max;             // Key press to present, milliseconds
+    float queue_p50, queue_p99;      // Key press to the tick that consumed it
+    int samples;                     // In the window
+} LatencyReport;
+
+// Follows every key press from its SDL event to the tick that consumes it,
+// then to the end of the SDL_RenderPresent that shows the result. With vsync
+// the present blocks until the flip, so that is as close to the photons as
+// we can see from here (scanout and the display itself come on top).
+typedef struct {
+    PendingPress pending[LATENCY_PENDING];
+    int num_pending;
+
+    float total_ms[LATENCY_WINDOW];
+    float queue_ms[LATENCY_WINDOW];
+    int count;                       // Filled part of the window
+    int next;
+
+    Uint64 presses;
+    Uint64 dropped;                  // Pending list was full
+} LatencyTracker;
+
+
+/*
+            DECLARATIONS
+*/
+void initLatencyTracker(LatencyTracker* lt);
+void latencyTickConsumed(LatencyTracker* lt, const InputTick* tick);
+void latencyFramePresented(LatencyTracker* lt);
+void getLatencyReport(const LatencyTracker* lt, LatencyReport* report);
+void printLatencyStats(const LatencyTracker* lt);
+
+#endif
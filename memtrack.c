@@ -0,0 +1,200 @@
+#include "memtrack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sits in front of every tracked block, live blocks form a list for the leak report
+typedef struct MemBlock {
+    struct MemBlock* prev;
+    struct MemBlock* next;
+    size_t size;
+    const char* file;
+    int line;
+    MemTag tag;
+} MemBlock;
+
+#define MEMTRACK_HEADER ((sizeof(MemBlock) + MEMTRACK_ALIGN - 1) & ~(size_t)(MEMTRACK_ALIGN - 1))
+
+typedef struct {
+    SDL_Texture* texture;
+    size_t bytes;
+    TextureCategory category;
+} TrackedTexture;
+
+static const char* tagNames[MEM_TAG_COUNT] = { "general", "world", "gravity", "particles", "ui", "audio", "net" };
+static const char* categoryNames[TEXCAT_COUNT] = { "sprites", "stars", "planets", "astral", "ui", "text" };
+
+static struct {
+    SDL_SpinLock lock;                       // Heap side only, textures live on the render thread
+    MemBlock* blocks;                        // Most recent first
+    MemUsage heap[MEM_TAG_COUNT];
+
+    TrackedTexture textures[MEMTRACK_MAX_TEXTURES];
+    int num_textures;
+    int untracked_textures;                  // Table was full
+    MemUsage vram[TEXCAT_COUNT];
+} memtrack;
+
+static void addUsage(MemUsage* usage, size_t bytes) {
+    usage->bytes += bytes;
+    usage->count++;
+    usage->created++;
+    if (usage->bytes > usage->peak_bytes) usage->peak_bytes = usage->bytes;
+}
+
+static void removeUsage(MemUsage* usage, size_t bytes) {
+    usage->bytes -= bytes;
+    usage->count--;
+}
+
+// Returns NULL on failure like malloc, callers keep their own error handling
+void* memAllocAt(size_t size, MemTag tag, const char* file, int line) {
+    size_t total = (MEMTRACK_HEADER + size + MEMTRACK_ALIGN - 1) & ~(size_t)(MEMTRACK_ALIGN - 1);
+    MemBlock* block = aligned_alloc(MEMTRACK_ALIGN, total);
+    if (!block) return NULL;
+
+    block->size = size;
+    block->file = file;
+    block->line = line;
+    block->tag = tag;
+    block->prev = NULL;
+
+    SDL_AtomicLock(&memtrack.lock);
+    block->next = memtrack.blocks;
+    if (memtrack.blocks) memtrack.blocks->prev = block;
+    memtrack.blocks = block;
+    addUsage(&memtrack.heap[tag], size);
+    SDL_AtomicUnlock(&memtrack.lock);
+
+    return (char*)block + MEMTRACK_HEADER;
+}
+
+void* memCallocAt(size_t count, size_t size, MemTag tag, const char* file, int line) {
+    if (size != 0 && count > (size_t)-1 / size) return NULL;
+
+    void* ptr = memAllocAt(count * size, tag, file, line);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+char* memStrdupAt(const char* text, MemTag tag, const char* file, int line) {
+    size_t length = strlen(text) + 1;
+    char* copy = memAllocAt(length, tag, file, line);
+    if (copy) memcpy(copy, text, length);
+    return copy;
+}
+
+// Only for blocks from memAlloc, memCalloc and memStrdup. NULL is ignored.
+void memFree(void* ptr) {
+    if (!ptr) return;
+    MemBlock* block = (MemBlock*)((char*)ptr - MEMTRACK_HEADER);
+
+    SDL_AtomicLock(&memtrack.lock);
+    if (block->prev) block->prev->next = block->next;
+    else memtrack.blocks = block->next;
+    if (block->next) block->next->prev = block->prev;
+    removeUsage(&memtrack.heap[block->tag], block->size);
+    SDL_AtomicUnlock(&memtrack.lock);
+
+    free(block);
+}
+
+// Render thread. Same 4 bytes per pixel estimate as the texture manager.
+void trackTexture(SDL_Texture* texture, TextureCategory category) {
+    if (!texture) return;
+    if (memtrack.num_textures == MEMTRACK_MAX_TEXTURES) {
+        if (memtrack.untracked_textures++ == 0) printf("Warning: Texture table full, raise MEMTRACK_MAX_TEXTURES\n");
+        return;
+    }
+
+    int w = 0, h = 0;
+    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+    size_t bytes = (size_t)w * h * 4;
+
+    memtrack.textures[memtrack.num_textures++] = (TrackedTexture){ texture, bytes, category };
+    addUsage(&memtrack.vram[category], bytes);
+}
+
+// Call before SDL_DestroyTexture. Textures that were never tracked are ignored.
+void untrackTexture(SDL_Texture* texture) {
+    // Newest first: text textures are destroyed right after being created
+    for (int i = memtrack.num_textures - 1; i >= 0; i--) {
+        TrackedTexture* tracked = &memtrack.textures[i];
+        if (tracked->texture != texture) continue;
+
+        removeUsage(&memtrack.vram[tracked->category], tracked->bytes);
+        *tracked = memtrack.textures[--memtrack.num_textures];
+        return;
+    }
+}
+
+void destroyTrackedTexture(SDL_Texture* texture) {
+    if (!texture) return;
+    untrackTexture(texture);
+    SDL_DestroyTexture(texture);
+}
+
+// Live texture bytes and textures created since start, every category
+void getTextureTotals(size_t* bytes, Uint64* created) {
+    *bytes = 0;
+    *created = 0;
+    for (int i = 0; i < TEXCAT_COUNT; i++) {
+        *bytes += memtrack.vram[i].bytes;
+        *created += memtrack.vram[i].created;
+    }
+}
+
+static double megabytes(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void printMemoryReport() {
+    size_t heap_bytes = 0, vram_bytes = 0;
+
+    SDL_AtomicLock(&memtrack.lock);
+    MemUsage heap[MEM_TAG_COUNT];
+    memcpy(heap, memtrack.heap, sizeof(heap));
+    SDL_AtomicUnlock(&memtrack.lock);
+
+    for (int i = 0; i < MEM_TAG_COUNT; i++) heap_bytes += heap[i].bytes;
+    for (int i = 0; i < TEXCAT_COUNT; i++) vram_bytes += memtrack.vram[i].bytes;
+
+    printf("Memory: %.2f MB heap, %.2f MB textures\n", megabytes(heap_bytes), megabytes(vram_bytes));
+    printf("  %-10s %7s %10s %10s %10s\n", "heap", "blocks", "MB", "peak MB", "allocs");
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        printf("  %-10s %7d %10.2f %10.2f %10llu\n", tagNames[i], heap[i].count,
+               megabytes(heap[i].bytes), megabytes(heap[i].peak_bytes), (unsigned long long)heap[i].created);
+    }
+    printf("  %-10s %7s %10s %10s %10s\n", "textures", "live", "MB", "peak MB", "created");
+    for (int i = 0; i < TEXCAT_COUNT; i++) {
+        MemUsage* usage = &memtrack.vram[i];
+        printf("  %-10s %7d %10.2f %10.2f %10llu\n", categoryNames[i], usage->count,
+               megabytes(usage->bytes), megabytes(usage->peak_bytes), (unsigned long long)usage->created);
+    }
+    if (memtrack.untracked_textures > 0) printf("  %d textures created while the table was full\n", memtrack.untracked_textures);
+}
+
+// Call last, after everything has been freed: whatever is left leaked
+void printMemoryLeaks() {
+    int blocks = 0;
+    size_t bytes = 0;
+
+    SDL_AtomicLock(&memtrack.lock);
+    for (MemBlock* block = memtrack.blocks; block; block = block->next) {
+        if (blocks < MEMTRACK_MAX_LEAKS) {
+            printf("Leak: %zu bytes (%s) allocated at %s:%d\n", block->size, tagNames[block->tag], block->file, block->line);
+        }
+        blocks++;
+        bytes += block->size;
+    }
+    SDL_AtomicUnlock(&memtrack.lock);
+
+    if (blocks > MEMTRACK_MAX_LEAKS) printf("Leak: ... and %d more blocks\n", blocks - MEMTRACK_MAX_LEAKS);
+    for (int i = 0; i < TEXCAT_COUNT; i++) {
+        MemUsage* usage = &memtrack.vram[i];
+        if (usage->count > 0) printf("Leak: %d %s textures, %.2f MB\n", usage->count, categoryNames[i], megabytes(usage->bytes));
+    }
+
+    if (blocks == 0 && memtrack.num_textures == 0) printf("Memory: no leaks\n");
+    else printf("Memory: %d blocks (%zu bytes) and %d textures not freed\n", blocks, bytes, memtrack.num_textures);
+}
@@ -0,0 +1,69 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+
+/*
+            DEFINITIONS
+*/
+#define MEMTRACK_MAX_TEXTURES 1024   // Live tracked textures
+#define MEMTRACK_MAX_LEAKS 32        // Listed at shutdown, the rest are only counted
+#define MEMTRACK_ALIGN 16            // Every block, the particle SSE loops rely on it
+
+// Heap allocations, by the subsystem that owns them
+typedef enum {
+    MEM_GENERAL,
+    MEM_WORLD,                       // BackgroundEffects: stars, planets, astral objects
+    MEM_GRAVITY,
+    MEM_PARTICLES,
+    MEM_UI,
+    MEM_AUDIO,                       // Sound effect PCM converted for the mixer
+    MEM_NET,                         // Snapshot history, the clients' state
+    MEM_TAG_COUNT
+} MemTag;
+
+// Texture memory, by what the texture shows
+typedef enum {
+    TEXCAT_SPRITES,                  // Fighter, thrusters, bullets, particles
+    TEXCAT_STARS,
+    TEXCAT_PLANETS,
+    TEXCAT_ASTRAL,
+    TEXCAT_UI,
+    TEXCAT_TEXT,                     // renderText, created and destroyed every frame
+    TEXCAT_COUNT
+} TextureCategory;
+
+/*
+            ACCOUNTING STRUCTURES
+*/
+typedef struct {
+    size_t bytes;                    // Live
+    size_t peak_bytes;
+    int count;                       // Live blocks or textures
+    Uint64 created;                  // Since start
+} MemUsage;
+
+// Allocation helpers record where the block was allocated for the leak list
+#define memAlloc(size, tag) memAllocAt((size), (tag), __FILE__, __LINE__)
+#define memCalloc(count, size, tag) memCallocAt((count), (size), (tag), __FILE__, __LINE__)
+#define memStrdup(text, tag) memStrdupAt((text), (tag), __FILE__, __LINE__)
+
+
+/*
+            DECLARATIONS
+*/
+void* memAllocAt(size_t size, MemTag tag, const char* file, int line);
+void* memCallocAt(size_t count, size_t size, MemTag tag, const char* file, int line);
+char* memStrdupAt(const char* text, MemTag tag, const char* file, int line);
+void memFree(void* ptr);
+
+void trackTexture(SDL_Texture* texture, TextureCategory category);
+void untrackTexture(SDL_Texture* texture);
+void destroyTrackedTexture(SDL_Texture* texture);
+void getTextureTotals(size_t* bytes, Uint64* created);
+
+void printMemoryReport();
+void printMemoryLeaks();
+
+#endif
@@ -3,138 +3,308 @@
 #include "init.h"   // Needs resources and UI elements
 #include "render.h" // Render menu
 #include "sounds.h"
+#include "gravity.h"
+#include "hotreload.h"
+#include "startup.h"
+#include "latency.h"
+#include "ui.h"
+#include "pacer.h"
+#include "profiler.h"
+#include "stress.h"
+#include "server.h"
+#include "netgame.h"
+#include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 
-int main() {
+int main(int argc, char* argv[]) {
     // Initialize variables
     Fighter fighter;
-    GameResources resources;
+    GameResources resources = {0};
     UIElements ui;
     Game game;
-
-    SDL_Rect bullets[MAX_BULLETS];
     
+    // --profile records every frame and writes the last ones at exit,
+    // --profile=N keeps N frames (also what the profile key captures).
+    // --stars=, --objects=, --bullets=, --radius= size the world, --stress[=N]
+    // scales it up and flies the camera for N frames. --gravity[=mode] pulls
+    // the fighter toward the planets, --gravity-cell=px sets the grid accuracy.
+    // --server[=N] runs bots in N headless sessions (1 to 10000 by default)
+    // and reports the tick rate.
+    // --host[=port] runs a multiplayer server, --connect=host[:port] plays on
+    // one, --netbench[=N] measures N bots over loopback (--loss=percent).
+    int profile = 0, profile_frames = PROFILER_TRACE_FRAMES;
+    int stress_frames = 0;
+    WorldConfig world = {0};
+    ServerOptions server = {0};
+    NetOptions net = { .port = NET_DEFAULT_PORT };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--profile") == 0) {
+            profile = 1;
+        } else if (strncmp(argv[i], "--profile=", 10) == 0) {
+            profile = 1;
+            profile_frames = atoi(argv[i] + 10);
+        } else if (parseWorldArgument(argv[i], &world, &stress_frames)) {
+            continue;
+        } else if (parseGravityArgument(argv[i], &world)) {
+            continue;
+        } else if (parseServerArgument(argv[i], &server)) {
+            continue;
+        } else if (parseNetArgument(argv[i], &net)) {
+            continue;
+        } else {
+            printf("Warning: Unknown argument %s\n", argv[i]);
+        }
+    }
+    initWorldConfig(&world, stress_frames > 0);
+    // A predicted tick would need the planets of the server tick that applies it
+    if (world.gravity != GRAVITY_OFF && (net.host || net.bench_players || net.connect[0])) {
+        printf("Warning: --gravity is for playing alone, the multiplayer rules have none\n");
+        world.gravity = GRAVITY_OFF;
+    }
+    // The error statistics live in the shared world, the server's workers would race on them
+    if (world.gravity == GRAVITY_VALIDATE && server.enabled) {
+        printf("Warning: --gravity=validate is for playing alone, the server uses exact\n");
+        world.gravity = GRAVITY_EXACT;
+    }
+    initProfiler(profile, profile_frames);
+    nameProfilerThread("main");
+
+    if (server.enabled || net.host || net.bench_players) {
+        int status = server.enabled ? runServer(&server, &world) :
+                     net.host ? runNetHost(&net, &world) : runNetBench(&net, &world);
+        shutdownProfiler();
+        return status;
+    }
+
+    // Measure everything up to the first frame
+    initStartupTrace();
+    int startup = beginStartupSpan("startup");
+
     // Initialize SDL systems
+    int span = beginStartupSpan("initSDLSystems");
     initSDLSystems();
+    endStartupSpan(span);
     
     // Create window and renderer
+    span = beginStartupSpan("initWindow");
     initWindow("Fighter game", &resources);
+    endStartupSpan(span);
+    span = beginStartupSpan("initRenderer");
     SDL_Renderer* renderer = initRenderer(resources.window);
+    endStartupSpan(span);
     
     // Initialize game components
+    span = beginStartupSpan("initGameResources");
     initGameResources(renderer, &resources);
+    endStartupSpan(span);
+    span = beginStartupSpan("initUIElements");
     initUIElements(&ui, resources.window);
-    initGame(&game);
+    endStartupSpan(span);
+    initGame(&game, &world);
     initFighter(&fighter, resources.windowWidth, resources.windowHeight);
 
-    BackgroundEffects bg_effects;
-    generateStarfield(&bg_effects);
-    initSolarSystem(&bg_effects);
-    initAstralObjects(&bg_effects, &resources);
-    initDiscoverySystem(&game);
+    // Text data files, through the binary cache
+    static GameData data;
+    span = beginStartupSpan("loadGameData");
+    loadGameData(&data);
+    endStartupSpan(span);
 
+    // Watch img/, data/ and music/ for edits
+    static HotReload hotreload;
+    span = beginStartupSpan("initHotReload");
+    initHotReload(&hotreload);
+    endStartupSpan(span);
+
+    // Heap allocated with the stars and astral objects, so it all shows as world memory
+    BackgroundEffects* bg_effects = memCalloc(1, sizeof(BackgroundEffects), MEM_WORLD);
+    checkInit(!bg_effects, "Failed to allocate background effects");
+    initWorld(bg_effects, &world);
+    span = beginStartupSpan("generateStarfield");
+    generateStarfield(bg_effects);
+    endStartupSpan(span);
+    printf("Generated %d stars in %d px radius\n", bg_effects->num_stars, bg_effects->config.starfield_radius);
+    span = beginStartupSpan("initSolarSystem");
+    initSolarSystem(bg_effects, &data);
+    endStartupSpan(span);
+    span = beginStartupSpan("initWorldGravity");
+    initWorldGravity(bg_effects);
+    endStartupSpan(span);
+    span = beginStartupSpan("initAstralObjects");
+    initAstralObjects(bg_effects, &resources);
+    acquireWorldTextures(bg_effects, &resources);
+    endStartupSpan(span);
+    span = beginStartupSpan("initParticleSystem");
+    initParticleSystem(&bg_effects->particles, renderer);
+    endStartupSpan(span);
+    initSimPlayer(&game.player, bg_effects, fighter.x + fighter.rect.w / 2, fighter.y + fighter.rect.h / 2);
+    if (net.connect[0]) {
+        printf("Connecting to %s:%d\n", net.connect, net.port);
+        game.net = createNetClient(net.connect, net.port, net.loss, bg_effects);
+        if (game.net) game.net->log = 1;
+    }
+
+    span = beginStartupSpan("fullscreen");
     SDL_SetWindowFullscreen(resources.window, SDL_WINDOW_FULLSCREEN_DESKTOP);
+    endStartupSpan(span);
+
+    // Key press to present, on the overlay and reported at exit
+    static LatencyTracker latency;
+    initLatencyTracker(&latency);
+    ui.overlay.latency = &latency;
+
+    // Capped by default: the simulation advances a fixed 1/FPS per frame
+    static FramePacer pacer;
+    initFramePacer(&pacer, renderer, resources.window, stress_frames ? PACE_UNCAPPED : PACE_CAPPED, FPS);
+    ui.overlay.pacer = &pacer;
+
+    // Straight into the game, as fast as it goes
+    static StressRun stress;
+    initStressRun(&stress, stress_frames);
+    if (stress_frames) game.screen = GAME;
+
+    // The first frame closes the trace
+    int first_frame = beginStartupSpan("first frame");
     
     // Main loop flag
     int quit = 0;
-    Uint32 frameStart;
-    int frameTime;
     SDL_Event e;
 
     // While application is running
     while (!quit) {
-        // Enregistrer le début de la frame
-        frameStart = SDL_GetTicks();
+        // Swap in the files edited since the last frame
+        PROFILE_BEGIN("processHotReload");
+        processHotReload(&hotreload, &resources, &data, bg_effects);
+        PROFILE_END();
 
-        // Handle events on queue (only for non-keyboard events)
+        // Handle events on queue, key edges go to the input layer
+        PROFILE_BEGIN("events");
         while (SDL_PollEvent(&e) != 0) {
+            if (handleInputEvent(&game.input, &e)) continue;
             handleMouseInput(&game, &fighter, &resources, &ui, e, &quit);
         }
+        PROFILE_END();
 
-        // Update keyboard state
-        SDL_PumpEvents();
-
-        // Handle keyboard input
-        handleKeyboardInput(&game, &fighter, &resources, &quit);
+        // Handle keyboard input, everything pressed up to now
+        InputTick tick;
+        sampleInput(&game.input, SDL_GetTicks(), &tick);
+        latencyTickConsumed(&latency, &tick);
+        handleKeyboardInput(&game, &resources, &tick, &quit);
+        if (tick.pressed[ACTION_PACING]) cyclePaceMode(&pacer);
+        if (tick.pressed[ACTION_PROFILE]) requestProfilerDump();
+        if (tick.pressed[ACTION_OVERLAY]) togglePerfOverlay(&ui.overlay);
 
         // Update game state
-        updateGameState(&game, &fighter, &resources, &bg_effects);
+        Uint64 sim_start = SDL_GetPerformanceCounter();
+        updateGameState(&game, &fighter, &resources, bg_effects);
+        float sim_ms = (SDL_GetPerformanceCounter() - sim_start) * 1000.0f / SDL_GetPerformanceFrequency();
+        updateStressRun(&stress, &pacer, &game, &fighter, &resources, bg_effects, &quit);
+        PROFILE_BEGIN("audio");
+        updateMusic(&game, &resources);
+        updateSounds(&resources, &game.player);
+        PROFILE_END();
+
+        // Create the textures that finished decoding in the background
+        uploadDecodedAssets(&resources.loader, TEXMGR_UPLOAD_BUDGET);
 
         // Render game
-        renderGameScreen(renderer, &game, &fighter, &resources, &ui, &bg_effects);
+        renderGameScreen(renderer, &game, &fighter, &resources, &ui, bg_effects);
+        latencyFramePresented(&latency);
+        recordOverlayFrame(&ui.overlay, sim_ms);
+        endTextureFrame(&resources.textures);
 
-        // Frame rate limiting
-        frameTime = SDL_GetTicks() - frameStart;
-        if (FRAME_DELAY > frameTime) {
-            SDL_Delay(FRAME_DELAY - frameTime);
+        if (first_frame >= 0) {
+            endStartupSpan(first_frame);
+            endStartupSpan(startup);
+            finishStartupTrace(STARTUP_TRACE_PATH);
+            first_frame = -1;
         }
+
+        // Frame rate limiting
+        PROFILE_BEGIN("endFrame");
+        endFrame(&pacer);
+        PROFILE_END();
+        profileFrame();
     }
 
     // Cleanup
+    printStressReport(&stress, &pacer, bg_effects, &game);
+    printFrameStats(&pacer);
+    printLatencyStats(&latency);
+    shutdownHotReload(&hotreload);
+    destroyNetClient(game.net);
     if (fighter.texture) SDL_DestroyTexture(fighter.texture);
+    destroyParticleSystem(&bg_effects->particles);
+    destroyGravityField(bg_effects);
+    releaseWorldTextures(bg_effects, &resources);
+    destroyWorld(bg_effects);
+    memFree(bg_effects);
+    cleanupGame(&game);
+    cleanupUIElements(&ui);
     cleanupResources(&resources);
     if (renderer) SDL_DestroyRenderer(renderer);
     if (resources.window) SDL_DestroyWindow(resources.window);
 
+    // Every thread has been joined
+    shutdownProfiler();
+
+    // Everything is freed by now, what is still tracked leaked
+    printMemoryLeaks();
+
     return 0;
 }
 
-void handleMouseInput(Game* game, Fighter* fighter, GameResources* resources, UIElements* ui, SDL_Event e, int* quit) {
-    int x, y;
+// Music (0) or sound effects (1) slider follows the mouse
+static void setSliderFromMouse(GameResources* resources, UIElements* ui, int i, int x) {
+    MenuListItem* item = &ui->optionsButtons[i];
+    float newVolume = sliderValueAt(item, x);
+    if (i == 0) setMusicVolume(resources, newVolume);
+    else setSoundEffectsVolume(resources, newVolume);
+
+    // Update knob position
+    item->slider.knobPosition = newVolume;
+    markMenuDirty(ui);
+}
 
+void handleMouseInput(Game* game, Fighter* fighter, GameResources* resources, UIElements* ui, SDL_Event e, int* quit) {
     // User requests quit
     if (e.type == SDL_QUIT) {
         *quit = 1;
+    } else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        // Menus are laid out in renderer coordinates (the logical size)
+        layoutUI(ui, resources->windowWidth, resources->windowHeight);
+    } else if (e.type == SDL_RENDER_TARGETS_RESET) {
+        markMenuDirty(ui); // the menu layer lost its contents
     } else if (e.type == SDL_MOUSEBUTTONDOWN) {
-        SDL_GetMouseState(&x, &y);
+        // Event coordinates are already in renderer coordinates, unlike SDL_GetMouseState
+        int x = e.button.x, y = e.button.y;
 
         // Check if the mouse click is within the buttons
         if (game->screen == MAIN_MENU) {
-            int lineHeight = 80;
-            int currentYPosition = resources->windowHeight - lineHeight - 20;
-            for (int i=ui->nbMenuButtons-1; i>=0; i--){
-                if (x >= MENU_MARGIN_RIGHT && x <= (MENU_MARGIN_RIGHT + ui->menuButtons[i].w) &&
-                    y >= currentYPosition && y <= (currentYPosition + ui->menuButtons[i].h)) {
-                    printf("%s button clicked!\n", ui->menuButtons[i].text);
-
-                    if (i==0) game->screen = GAME;
-                    else if (i==1) game->screen = OPTIONS;
-                    else if (i==2) *quit = 1;
+            int i = hitTestMenuList(ui->menuButtons, ui->nbMenuButtons, x, y);
+            if (i >= 0) {
+                printf("%s button clicked!\n", ui->menuButtons[i].text);
 
-                }
-                currentYPosition -= lineHeight;
+                if (i==0) game->screen = GAME;
+                else if (i==1) game->screen = OPTIONS;
+                else if (i==2) *quit = 1;
             }
         } else if (game->screen == OPTIONS) {
-            int lineHeight = 80;
-            int currentYPosition = resources->windowHeight - lineHeight - 20;
-            for (int i=ui->nbOptionsButtons-1; i>=0; i--){
-                if (ui->optionsButtons[i].isHovering) {
-                    if (i==0) {
-                        if (x >= MENU_MARGIN_RIGHT + MENU_OFFSET && x < MENU_MARGIN_RIGHT + MENU_OFFSET + ui->optionsButtons[0].slider.length) {
-                            float newVolume = min(max((float)(x - MENU_MARGIN_RIGHT-MENU_OFFSET) / ui->optionsButtons[0].slider.length, 0.0f), 1.0f);
-                            setMusicVolume(resources, newVolume);
-                            
-                            // Update knob position
-                            ui->optionsButtons[0].slider.knobPosition = newVolume;
-                            ui->draggingMusic = 1;
-                        }
-                    } else if (i==1) {
-                        if (x >= MENU_MARGIN_RIGHT + MENU_OFFSET && x < MENU_MARGIN_RIGHT + MENU_OFFSET + ui->optionsButtons[1].slider.length) {
-                            float newVolume = min(max((float)(x - MENU_MARGIN_RIGHT-MENU_OFFSET) / ui->optionsButtons[1].slider.length, 0.0f), 1.0f);
-                            setSoundEffectsVolume(resources, newVolume);
-                            
-                            // Update knob position
-                            ui->optionsButtons[1].slider.knobPosition = newVolume;
-                            ui->draggingSfx = 1;
-                        }
-                    } else if (i==2) {
-                        if (x >= MENU_MARGIN_RIGHT && x <= MENU_MARGIN_RIGHT + MENU_OFFSET + min(ui->optionsButtons[i].checkbox.boxSize, ui->optionsButtons[i].h))
-                            ui->optionsButtons[i].checkbox.isChecked = !ui->optionsButtons[i].checkbox.isChecked;
-                    } else if (i==3) {
-                        game->screen = MAIN_MENU;
-                    }
+            int i = hitTestMenuList(ui->optionsButtons, ui->nbOptionsButtons, x, y);
+            MenuListItem* item = i >= 0 ? &ui->optionsButtons[i] : NULL;
+            if (i==0 || i==1) {
+                if (x >= item->control.x && x < item->control.x + item->control.w) {
+                    setSliderFromMouse(resources, ui, i, x);
+                    if (i==0) ui->draggingMusic = 1;
+                    else ui->draggingSfx = 1;
                 }
-                currentYPosition -= lineHeight;
+            } else if (i==2) {
+                if (x <= item->control.x + item->control.w) {
+                    item->checkbox.isChecked = !item->checkbox.isChecked;
+                    markMenuDirty(ui);
+                }
+            } else if (i==3) {
+                game->screen = MAIN_MENU;
             }
         } else if (game->screen == GAME) {
             // Check if the pause button is clicked
@@ -148,71 +318,42 @@ void handleMouseInput(Game* game, Fighter* fighter, GameResources* resources, UI
         }
     } else if (e.type == SDL_MOUSEBUTTONUP) {
         if (game->screen == OPTIONS) {
-            SDL_GetMouseState(&x, &y);
+            int x = e.button.x;
             if (ui->draggingMusic) {
-                float newVolume = min(max((float)(x - MENU_MARGIN_RIGHT-MENU_OFFSET) / ui->optionsButtons[0].slider.length, 0.0f), 1.0f);
-                setMusicVolume(resources, newVolume);
-                
-                // Update knob position
-                ui->optionsButtons[0].slider.knobPosition = newVolume;
+                setSliderFromMouse(resources, ui, 0, x);
                 ui->draggingMusic = 0;
-                ui->optionsButtons[0].isHovering = 0;
+                setMenuHover(ui, &ui->optionsButtons[0], 0);
             }
 
             if (ui->draggingSfx) {
-                float newVolume = min(max((float)(x - MENU_MARGIN_RIGHT-MENU_OFFSET) / ui->optionsButtons[1].slider.length, 0.0f), 1.0f);
-                setSoundEffectsVolume(resources, newVolume);
-                
-                // Update knob position
-                ui->optionsButtons[1].slider.knobPosition = newVolume;
+                setSliderFromMouse(resources, ui, 1, x);
                 ui->draggingSfx = 0;
-                ui->optionsButtons[1].isHovering = 0;
+                setMenuHover(ui, &ui->optionsButtons[1], 0);
             }
         }
     } else if (e.type == SDL_MOUSEMOTION) {
-        SDL_GetMouseState(&x, &y);
+        int x = e.motion.x, y = e.motion.y;
         if (game->screen == OPTIONS) {
-            if (ui->draggingMusic) {
-                float newVolume = min(max((float)(x - MENU_MARGIN_RIGHT-MENU_OFFSET) / ui->optionsButtons[0].slider.length, 0.0f), 1.0f);
-                setMusicVolume(resources, newVolume);
-                ui->optionsButtons[0].slider.knobPosition = newVolume;
-            }
-            
-            if (ui->draggingSfx) {
-                float newVolume = min(max((float)(x - MENU_MARGIN_RIGHT-MENU_OFFSET) / ui->optionsButtons[1].slider.length, 0.0f), 1.0f);
-                setSoundEffectsVolume(resources, newVolume);
-                ui->optionsButtons[1].slider.knobPosition = newVolume;
-            }
+            if (ui->draggingMusic) setSliderFromMouse(resources, ui, 0, x);
+            if (ui->draggingSfx) setSliderFromMouse(resources, ui, 1, x);
         }
         
         if (game->screen == MAIN_MENU) {
-            int lineHeight = 80;
-            int currentYPosition = resources->windowHeight - lineHeight - 20;
-            for (int i=ui->nbMenuButtons-1; i>=0; i--){
-                if (x >= MENU_MARGIN_RIGHT && x <= (MENU_MARGIN_RIGHT + ui->menuButtons[i].w) &&
-                    y >= currentYPosition && y <= (currentYPosition + ui->menuButtons[i].h)) {
-                    ui->menuButtons[i].isHovering = 1;
-                } else {
-                    ui->menuButtons[i].isHovering = 0;
-                }
-                currentYPosition -= lineHeight;
+            int hit = hitTestMenuList(ui->menuButtons, ui->nbMenuButtons, x, y);
+            for (int i=0; i<ui->nbMenuButtons; i++) {
+                setMenuHover(ui, &ui->menuButtons[i], i == hit);
             }
         } else if (game->screen == OPTIONS) {
-            int lineHeight = 80;
-            int currentYPosition = resources->windowHeight - lineHeight - 20;
-            for (int i=ui->nbOptionsButtons-1; i>=0; i--){
-                if (x >= MENU_MARGIN_RIGHT && x <= (MENU_MARGIN_RIGHT + ui->optionsButtons[i].w) &&
-                y >= currentYPosition && y <= (currentYPosition + ui->optionsButtons[i].h)
-                && (!(i!=0 && ui->draggingMusic) && !(i!=1 && ui->draggingSfx))) { // if 0 nor 1 dragging
-                    ui->optionsButtons[i].isHovering = 1;
-                } else {
-                    if ((i==0 && !ui->draggingMusic) || (i==1 && !ui->draggingSfx) || i>1)
-                        ui->optionsButtons[i].isHovering = 0;
+            int hit = hitTestMenuList(ui->optionsButtons, ui->nbOptionsButtons, x, y);
+            for (int i=0; i<ui->nbOptionsButtons; i++) {
+                if (i == hit && (!(i!=0 && ui->draggingMusic) && !(i!=1 && ui->draggingSfx))) { // if 0 nor 1 dragging
+                    setMenuHover(ui, &ui->optionsButtons[i], 1);
+                } else if ((i==0 && !ui->draggingMusic) || (i==1 && !ui->draggingSfx) || i>1) {
+                    setMenuHover(ui, &ui->optionsButtons[i], 0);
                 }
-                currentYPosition -= lineHeight;
             }
         } else if (game->screen == GAME) {
-            // Check if the pause button is clicked
+            // Check if the pause button is hovered
             if (x >= ui->pauseButtonRect.x && x <= (ui->pauseButtonRect.x + ui->pauseButtonRect.w) &&
             y >= ui->pauseButtonRect.y && y <= (ui->pauseButtonRect.y + ui->pauseButtonRect.h)) {
                 resources->isHoveringPause = 1;
@@ -224,87 +365,43 @@ void handleMouseInput(Game* game, Fighter* fighter, GameResources* resources, UI
     }
 }
 
-void handleKeyboardInput(Game* game, Fighter* fighter, GameResources* resources, int* quit) {
-    // Toggle fullscreen with F11 key
-    if (game->keyState[SDL_SCANCODE_F]) {
-        static int is_fullscreen = 0;
-        is_fullscreen = !is_fullscreen;
-        
-        if (is_fullscreen) {
-            SDL_SetWindowFullscreen(resources->window, SDL_WINDOW_FULLSCREEN_DESKTOP);
-        } else {
-            SDL_SetWindowFullscreen(resources->window, 0);
-        }
-        
-        // Add a small delay to prevent multiple toggles
-        SDL_Delay(200);
+void handleKeyboardInput(Game* game, GameResources* resources, const InputTick* tick, int* quit) {
+    // Toggle fullscreen, once per press
+    if (tick->pressed[ACTION_FULLSCREEN]) {
+        int is_fullscreen = SDL_GetWindowFlags(resources->window) & SDL_WINDOW_FULLSCREEN;
+        SDL_SetWindowFullscreen(resources->window, is_fullscreen ? 0 : SDL_WINDOW_FULLSCREEN_DESKTOP);
     }
 
-    if (game->screen == GAME) {
-        int is_thrusting = 0;
+    if (tick->pressed[ACTION_MEMORY_REPORT]) {
+        printMemoryReport();
+        printTextureStats(&resources->textures);
+    }
+
+    // Movement is applied by the next updateGameState
+    memset(&game->controls, 0, sizeof(game->controls));
 
-        // Check for P key (pause) - use key press for one-time actions
-        if (game->keyState[SDL_SCANCODE_P]) {
+    if (game->screen == GAME) {
+        // One-time actions react to the press edge
+        if (tick->pressed[ACTION_PAUSE]) {
             printf("P key pressed - going back to main menu!\n");
             game->screen = MAIN_MENU;
-            // Add a small delay to prevent multiple triggers
-            SDL_Delay(200);
-        }
-
-        // Handle continuous movement keys
-        if (game->keyState[SDL_SCANCODE_UP]) {
-            is_thrusting = 1;
-            float rad_angle = fighter->angle * M_PI / 180.0f;
-            fighter->speed_x += sin(rad_angle) * FIGHTER_SPEED;
-            fighter->speed_y += -cos(rad_angle) * FIGHTER_SPEED;
-        }
-        
-        if (game->keyState[SDL_SCANCODE_DOWN]) {
-            int action = getShortestRotationDirection(fighter);
-            if (action == THRUST) { // accelerate if angle opposite to speed
-                is_thrusting = 1;
-                float rad_angle = fighter->angle * M_PI / 180.0f;
-                fighter->speed_x += sin(rad_angle) * FIGHTER_SPEED;
-                fighter->speed_y += -cos(rad_angle) * FIGHTER_SPEED;
-            } else {
-                switch(action) {
-                    case TURN_LEFT:
-                        fighter->angle -= ANGLES_PER_FRAME;
-                        break;
-                    case TURN_RIGHT:
-                        fighter->angle += ANGLES_PER_FRAME;
-                        break;
-                    default: // DO_NOTHING
-                        break;
-                }
-            }
-        }
-        
-        if (game->keyState[SDL_SCANCODE_LEFT]) {
-            fighter->angle -= ANGLES_PER_FRAME;
-        }
-        
-        if (game->keyState[SDL_SCANCODE_RIGHT]) {
-            fighter->angle += ANGLES_PER_FRAME;
-        }
-        
-        if (game->keyState[SDL_SCANCODE_SPACE]) {
-            fighter->speed_x = 0;
-            fighter->speed_y = 0;
-            fighter->angle = 0;
-            resources->bg_x = 0;
-            resources->bg_y = 0;
         }
 
-        // Update thruster animation
-        updateThruster(&fighter->thruster, is_thrusting);
+        // Continuous movement keys
+        game->controls = (SimControls){
+            .thrust = tick->down[ACTION_THRUST],
+            .retro = tick->down[ACTION_RETRO],
+            .turn_left = tick->down[ACTION_TURN_LEFT],
+            .turn_right = tick->down[ACTION_TURN_RIGHT],
+            .reset = tick->down[ACTION_RESET]
+        };
     } else if (game->screen == MAIN_MENU) {
-        if (game->keyState[SDL_SCANCODE_Q]) { // A
+        if (tick->pressed[ACTION_START]) {
             game->screen = GAME;
         }
     }
 
-    if (game->keyState[SDL_SCANCODE_A]) { // Q on AZERTY keyboard
+    if (tick->pressed[ACTION_QUIT]) {
         *quit = 1;
     }
 }
@@ -5,6 +5,6 @@
 #include "init.h"  // Needs GameResources and UIElements
 
 void handleMouseInput(Game* game, Fighter* fighter, GameResources* resources, UIElements* ui, SDL_Event e, int* quit);
-void handleKeyboardInput(Game* game, Fighter* fighter, GameResources* resources, int* quit);
+void handleKeyboardInput(Game* game, GameResources* resources, const InputTick* tick, int* quit);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "music.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+static Uint32 trackFrames(MusicStreamer* ms, Mix_Chunk* pcm) {
+    return pcm->alen / (sizeof(Sint16) * ms->channels);
+}
+
+static const Sint16* voiceSamples(MusicStreamer* ms, MusicVoice* voice, Uint32* frames) {
+    if (voice->track < 0 || !ms->tracks[voice->track].pcm) return NULL;
+    Mix_Chunk* pcm = ms->tracks[voice->track].pcm;
+    *frames = trackFrames(ms, pcm);
+    return *frames > 0 ? (const Sint16*)pcm->abuf : NULL;
+}
+
+// Streaming thread. Equal-power crossfade while a track is incoming.
+static void mixBlock(MusicStreamer* ms, Sint16* out, int frames) {
+    Uint32 current_frames = 0, incoming_frames = 0;
+    const Sint16* current = voiceSamples(ms, &ms->current, &current_frames);
+    const Sint16* incoming = voiceSamples(ms, &ms->incoming, &incoming_frames);
+    int channels = ms->channels;
+
+    for (int f = 0; f < frames; f++) {
+        float gain_out = 1.0f, gain_in = 0.0f;
+        if (incoming) {
+            float t = (float)ms->fade_position / ms->fade_frames;
+            gain_out = cosf(t * (float)M_PI / 2);
+            gain_in = sinf(t * (float)M_PI / 2);
+        }
+
+        for (int c = 0; c < channels; c++) {
+            float sample = 0.0f;
+            if (current) sample += current[ms->current.position * channels + c] * gain_out;
+            if (incoming) sample += incoming[ms->incoming.position * channels + c] * gain_in;
+            out[f * channels + c] = (Sint16)(sample > 32767.0f ? 32767 : sample < -32768.0f ? -32768 : sample);
+        }
+
+        // Tracks loop on themselves, no gap at the seam
+        if (current && ++ms->current.position >= current_frames) ms->current.position = 0;
+        if (incoming) {
+            if (++ms->incoming.position >= incoming_frames) ms->incoming.position = 0;
+            if (++ms->fade_position >= ms->fade_frames) {
+                ms->current = ms->incoming;
+                ms->incoming.track = -1;
+                current = incoming;
+                current_frames = incoming_frames;
+                incoming = NULL;
+            }
+        }
+    }
+}
+
+// Streaming thread: swaps in the tracks the game thread handed over. The
+// previous decode (hot reload) is freed here, nothing reads it any more.
+static void takeDecodedTracks(MusicStreamer* ms) {
+    for (int i = 0; i < MUSIC_MAX_TRACKS; i++) {
+        MusicTrack* track = &ms->tracks[i];
+        Mix_Chunk* pcm = SDL_AtomicSetPtr(&track->pending, NULL);
+        if (!pcm) continue;
+
+        Mix_Chunk* old = track->pcm;
+        track->pcm = pcm;
+
+        Uint32 frames = trackFrames(ms, pcm);
+        if (ms->current.track == i) ms->current.position %= SDL_max(frames, 1u);
+        if (ms->incoming.track == i) ms->incoming.position %= SDL_max(frames, 1u);
+        if (old) Mix_FreeChunk(old);
+    }
+}
+
+// Streaming thread. A fade in progress finishes before the next starts.
+static void startWantedTrack(MusicStreamer* ms) {
+    int wanted = SDL_AtomicGet(&ms->wanted);
+    if (wanted < 0 || wanted >= MUSIC_MAX_TRACKS || !ms->tracks[wanted].pcm) return;
+    if (ms->incoming.track >= 0 || ms->current.track == wanted) return;
+
+    if (ms->current.track < 0 || !ms->tracks[ms->current.track].pcm) {
+        ms->current = (MusicVoice){ wanted, 0 };
+        return;
+    }
+
+    ms->incoming = (MusicVoice){ wanted, 0 };
+    ms->fade_position = 0;
+    ms->fade_frames = SDL_max(1, MUSIC_CROSSFADE_MS * ms->frequency / 1000);
+}
+
+static int musicStreamThread(void* data) {
+    MusicStreamer* ms = data;
+
+    while (!SDL_AtomicGet(&ms->quit)) {
+        takeDecodedTracks(ms);
+        startWantedTrack(ms);
+
+        // Blocks never straddle the end of the ring: its size is a multiple of the block size
+        while ((Uint32)SDL_AtomicGet(&ms->write_frames) - (Uint32)SDL_AtomicGet(&ms->read_frames) <= MUSIC_RING_FRAMES - MUSIC_BLOCK_FRAMES) {
+            Uint32 index = (Uint32)SDL_AtomicGet(&ms->write_frames) & (MUSIC_RING_FRAMES - 1);
+            mixBlock(ms, &ms->ring[index * ms->channels], MUSIC_BLOCK_FRAMES);
+            SDL_AtomicAdd(&ms->write_frames, MUSIC_BLOCK_FRAMES);
+        }
+
+        SDL_Delay(MUSIC_FILL_INTERVAL_MS);
+    }
+    return 0;
+}
+
+// Audio thread (SDL_mixer music hook): copy out of the ring, nothing else
+static void musicCallback(void* data, Uint8* stream, int length) {
+    MusicStreamer* ms = data;
+    Sint16* out = (Sint16*)stream;
+    int channels = ms->channels;
+    Uint32 frames = length / (sizeof(Sint16) * channels);
+
+    Uint32 read = SDL_AtomicGet(&ms->read_frames);
+    Uint32 available = (Uint32)SDL_AtomicGet(&ms->write_frames) - read;
+    Uint32 count = available < frames ? available : frames;
+    int volume = SDL_AtomicGet(&ms->volume);
+
+    for (Uint32 f = 0; f < count; f++) {
+        const Sint16* in = &ms->ring[((read + f) & (MUSIC_RING_FRAMES - 1)) * channels];
+        for (int c = 0; c < channels; c++) {
+            out[f * channels + c] = in[c] * volume / MIX_MAX_VOLUME;
+        }
+    }
+    if (count < frames) {
+        memset(&out[count * channels], 0, (frames - count) * channels * sizeof(Sint16));
+        SDL_AtomicAdd(&ms->underruns, 1);
+    }
+    SDL_AtomicAdd(&ms->read_frames, count);
+}
+
+// Returns 0 (music stays silent) if the mixer format is not 16-bit
+int initMusicStreamer(MusicStreamer* ms, AssetLoader* loader) {
+    memset(ms, 0, sizeof(*ms));
+    ms->loader = loader;
+    ms->current.track = -1;
+    ms->incoming.track = -1;
+    SDL_AtomicSet(&ms->wanted, -1);
+    SDL_AtomicSet(&ms->volume, MIX_MAX_VOLUME);
+
+    Uint16 format;
+    if (!Mix_QuerySpec(&ms->frequency, &format, &ms->channels) ||
+        format != AUDIO_S16SYS || ms->channels > MUSIC_MAX_CHANNELS) {
+        printf("Warning: Music streaming needs 16-bit stereo output, music disabled\n");
+        ms->channels = 0;
+        return 0;
+    }
+
+    ms->thread = SDL_CreateThread(musicStreamThread, "music", ms);
+    if (!ms->thread) {
+        printf("Warning: Music streaming disabled, %s\n", SDL_GetError());
+        shutdownMusicStreamer(ms);
+        return 0;
+    }
+
+    Mix_HookMusic(musicCallback, ms);
+    return 1;
+}
+
+void shutdownMusicStreamer(MusicStreamer* ms) {
+    if (ms->thread) Mix_HookMusic(NULL, NULL);
+
+    SDL_AtomicSet(&ms->quit, 1);
+    if (ms->thread) SDL_WaitThread(ms->thread, NULL);
+    ms->thread = NULL;
+
+    for (int i = 0; i < ms->num_tracks; i++) {
+        Mix_Chunk* pending = SDL_AtomicSetPtr(&ms->tracks[i].pending, NULL);
+        if (pending) Mix_FreeChunk(pending);
+        if (ms->tracks[i].pcm) Mix_FreeChunk(ms->tracks[i].pcm);
+        ms->tracks[i].pcm = NULL;
+    }
+}
+
+int findMusicTrack(MusicStreamer* ms, const char* path) {
+    for (int i = 0; i < ms->num_tracks; i++) {
+        if (strcmp(ms->tracks[i].path, path) == 0) return i;
+    }
+    return -1;
+}
+
+// Same path added twice returns the same track
+int addMusicTrack(MusicStreamer* ms, const char* path) {
+    int track = findMusicTrack(ms, path);
+    if (track >= 0) return track;
+
+    if (ms->num_tracks == MUSIC_MAX_TRACKS) {
+        printf("Warning: Too many music tracks, ignoring %s\n", path);
+        return -1;
+    }
+
+    // The slot is still zero from initMusicStreamer, the streaming thread
+    // may already be polling its pending pointer
+    track = ms->num_tracks++;
+    snprintf(ms->tracks[track].path, PAK_PATH_LENGTH, "%s", path);
+    return track;
+}
+
+// Render thread: hands the decode (first load or hot reload) to the
+// streaming thread without waiting for it. A decode it has not taken yet is
+// replaced and freed here.
+static void onTrackDecoded(Asset* asset, void* object) {
+    MusicStreamer* ms = asset->userdata;
+    MusicTrack* track = &ms->tracks[asset->user_index];
+
+    track->loading = 0;
+    if (object) {
+        Mix_Chunk* replaced = SDL_AtomicSetPtr(&track->pending, object);
+        if (replaced) Mix_FreeChunk(replaced);
+        track->decoded = 1;
+    } else if (!track->decoded) {
+        track->failed = 1;
+    }
+}
+
+static void decodeTrack(MusicStreamer* ms, int track) {
+    ms->tracks[track].loading = 1;
+    queueAsset(ms->loader, (Asset){
+        .kind = ASSET_CHUNK,
+        .path = ms->tracks[track].path,
+        .on_ready = onTrackDecoded,
+        .userdata = ms,
+        .user_index = track
+    });
+}
+
+// Fades to track once it is decoded, the current one keeps playing meanwhile
+void playMusicTrack(MusicStreamer* ms, int track) {
+    if (!ms->thread || track < 0 || track >= ms->num_tracks) return;
+
+    MusicTrack* t = &ms->tracks[track];
+    if (!t->decoded && !t->loading && !t->failed) decodeTrack(ms, track);
+    SDL_AtomicSet(&ms->wanted, track);
+}
+
+// The file changed on disk (hot reload)
+void reloadMusicTrack(MusicStreamer* ms, int track) {
+    if (!ms->thread || track < 0 || track >= ms->num_tracks) return;
+
+    MusicTrack* t = &ms->tracks[track];
+    t->failed = 0;
+    if (!t->loading && (t->decoded || SDL_AtomicGet(&ms->wanted) == track)) decodeTrack(ms, track);
+}
+
+void setMusicStreamVolume(MusicStreamer* ms, float volume) {
+    SDL_AtomicSet(&ms->volume, (int)(MIX_MAX_VOLUME * volume));
+}
@@ -0,0 +1,80 @@
+#ifndef MUSIC_H
+#define MUSIC_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include "assets.h"
+
+/*
+            DEFINITIONS
+*/
+#define MUSIC_MAX_TRACKS 8
+#define MUSIC_MAX_CHANNELS 2
+#define MUSIC_RING_FRAMES 16384        // ~370 ms at 44.1 kHz, power of two
+#define MUSIC_BLOCK_FRAMES 1024        // Frames mixed per step by the streaming thread
+#define MUSIC_FILL_INTERVAL_MS 5       // Streaming thread sleep between two fills
+#define MUSIC_CROSSFADE_MS 2000
+
+/*
+            STREAMER STRUCTURES
+*/
+typedef struct {
+    char path[PAK_PATH_LENGTH];
+    Mix_Chunk* pcm;                    // Streaming thread: whole track in the device format, NULL until decoded
+    void* pending;                     // Decoded Mix_Chunk handed to the streaming thread (atomic pointer)
+
+    // Game thread
+    int decoded;                       // A decode was handed over
+    int loading;
+    int failed;
+} MusicTrack;
+
+typedef struct {
+    int track;                         // -1: silent
+    Uint32 position;                   // Frame, wraps to loop the track without a gap
+} MusicVoice;
+
+// Tracks are decoded by the asset loader workers and handed to the streaming
+// thread through each track's pending slot. The streaming thread mixes the
+// playing track (and the incoming one during a crossfade) into a lock-free
+// ring, in MUSIC_BLOCK_FRAMES steps. The SDL_mixer music hook only copies
+// from the ring and applies the volume. Nothing on the audio, streaming or
+// game thread waits on a lock or a decoder.
+typedef struct {
+    MusicTrack tracks[MUSIC_MAX_TRACKS];
+    int num_tracks;                    // Game thread
+    AssetLoader* loader;
+
+    // Streaming thread only
+    MusicVoice current;
+    MusicVoice incoming;               // Fading in while current fades out
+    Uint32 fade_position, fade_frames;
+
+    SDL_Thread* thread;
+    SDL_atomic_t quit;
+    SDL_atomic_t wanted;               // Track the game asked for, -1: none
+
+    // Single producer (streaming thread), single consumer (audio callback)
+    Sint16 ring[MUSIC_RING_FRAMES * MUSIC_MAX_CHANNELS];
+    SDL_atomic_t read_frames;
+    SDL_atomic_t write_frames;
+    int channels;
+    int frequency;
+
+    SDL_atomic_t volume;               // 0 to MIX_MAX_VOLUME
+    SDL_atomic_t underruns;            // Callbacks that found the ring short
+} MusicStreamer;
+
+
+/*
+            DECLARATIONS
+*/
+int initMusicStreamer(MusicStreamer* ms, AssetLoader* loader);
+void shutdownMusicStreamer(MusicStreamer* ms);
+int addMusicTrack(MusicStreamer* ms, const char* path);
+int findMusicTrack(MusicStreamer* ms, const char* path);
+void playMusicTrack(MusicStreamer* ms, int track);
+void reloadMusicTrack(MusicStreamer* ms, int track);
+void setMusicStreamVolume(MusicStreamer* ms, float volume);
+
+#endif
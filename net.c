@@ -0,0 +1,202 @@
+#include "net.h"
+#include <stdio.h>
+#include <string.h>
+
+void initBitWriter(BitWriter* writer, Uint8* data, int capacity) {
+    writer->data = data;
+    writer->capacity = capacity;
+    writer->bits = 0;
+    writer->overflow = 0;
+}
+
+// count from 0 to 32, the bits of value above count are ignored
+void writeBits(BitWriter* writer, Uint32 value, int count) {
+    if (writer->overflow || writer->bits + count > writer->capacity * 8) {
+        writer->overflow = 1;
+        return;
+    }
+
+    while (count > 0) {
+        int byte = writer->bits >> 3;
+        int offset = writer->bits & 7;
+        int take = SDL_min(8 - offset, count);
+        if (offset == 0) writer->data[byte] = 0;   // Fresh byte, the buffer is not cleared
+        writer->data[byte] |= (value & ((1u << take) - 1)) << offset;
+        value >>= take;
+        count -= take;
+        writer->bits += take;
+    }
+}
+
+// count bits written by another BitWriter
+void appendBits(BitWriter* writer, const Uint8* data, int count) {
+    for (int i = 0; i < count; i += 8) writeBits(writer, data[i >> 3], SDL_min(8, count - i));
+}
+
+// 4 bits at a time, each group followed by a bit saying if another comes
+void writeVarint(BitWriter* writer, Uint32 value) {
+    do {
+        writeBits(writer, value & 15, 4);
+        value >>= 4;
+        writeBits(writer, value != 0, 1);
+    } while (value);
+}
+
+// Small differences of either sign give small numbers: 0, -1, 1, -2, 2...
+static Uint32 zigzag(Sint32 value) {
+    return ((Uint32)value << 1) ^ (Uint32)(value >> 31);
+}
+
+static Sint32 unzigzag(Uint32 value) {
+    return (Sint32)(value >> 1) ^ -(Sint32)(value & 1);
+}
+
+// value against what the other end already has. Unchanged is 1 bit, then the
+// difference in 4, 8, 16 or 32 bits behind a prefix of 2 to 4 bits.
+static const int deltaSizes[4] = { 4, 8, 16, 32 };
+
+void writeDelta(BitWriter* writer, Sint32 value, Sint32 base) {
+    Uint32 diff = zigzag((Sint32)((Uint32)value - (Uint32)base));
+    if (diff == 0) {
+        writeBits(writer, 0, 1);
+        return;
+    }
+
+    int size = 0;
+    while (size < 3 && diff >= (1u << deltaSizes[size])) size++;
+    writeBits(writer, 1, 1);
+    for (int i = 0; i < size; i++) writeBits(writer, 1, 1);
+    if (size < 3) writeBits(writer, 0, 1);
+    writeBits(writer, diff, deltaSizes[size]);
+}
+
+int bitWriterBytes(const BitWriter* writer) {
+    return (writer->bits + 7) >> 3;
+}
+
+void initBitReader(BitReader* reader, const Uint8* data, int bytes) {
+    reader->data = data;
+    reader->size = bytes * 8;
+    reader->bits = 0;
+    reader->overflow = 0;
+}
+
+Uint32 readBits(BitReader* reader, int count) {
+    if (reader->overflow || reader->bits + count > reader->size) {
+        reader->overflow = 1;
+        return 0;
+    }
+
+    Uint32 value = 0;
+    int shift = 0;
+    while (count > 0) {
+        int byte = reader->bits >> 3;
+        int offset = reader->bits & 7;
+        int take = SDL_min(8 - offset, count);
+        value |= (Uint32)((reader->data[byte] >> offset) & ((1u << take) - 1)) << shift;
+        shift += take;
+        count -= take;
+        reader->bits += take;
+    }
+    return value;
+}
+
+Uint32 readVarint(BitReader* reader) {
+    Uint32 value = 0;
+    for (int shift = 0; shift < 32; shift += 4) {
+        value |= readBits(reader, 4) << shift;
+        if (!readBits(reader, 1)) return value;
+    }
+    reader->overflow = 1;   // Longer than 32 bits
+    return 0;
+}
+
+Sint32 readDelta(BitReader* reader, Sint32 base) {
+    if (!readBits(reader, 1)) return base;
+
+    int size = 0;
+    while (size < 3 && readBits(reader, 1)) size++;
+    Uint32 diff = readBits(reader, deltaSizes[size]);
+    return (Sint32)((Uint32)base + (Uint32)unzigzag(diff));
+}
+
+// Bits needed to tell count values apart, at least 1
+int bitsFor(Uint32 count) {
+    int bits = 1;
+    while (bits < 32 && (count - 1) >> bits) bits++;
+    return bits;
+}
+
+// port 0 lets the system pick one
+int openNetSocket(NetSocket* sock, Uint16 port, float loss) {
+    memset(sock, 0, sizeof(*sock));
+    sock->loss = loss;
+    sock->rng = 0x2545F491u ^ port;
+
+    sock->socket = SDLNet_UDP_Open(port);
+    if (!sock->socket) {
+        printf("Warning: Could not open UDP port %d: %s\n", port, SDLNet_GetError());
+        return 0;
+    }
+    sock->outgoing = SDLNet_AllocPacket(NET_MAX_PACKET);
+    sock->incoming = SDLNet_AllocPacket(NET_MAX_PACKET);
+    if (!sock->outgoing || !sock->incoming) {
+        printf("Warning: Could not allocate the UDP packets: %s\n", SDLNet_GetError());
+        closeNetSocket(sock);
+        return 0;
+    }
+    return 1;
+}
+
+void closeNetSocket(NetSocket* sock) {
+    if (sock->outgoing) SDLNet_FreePacket(sock->outgoing);
+    if (sock->incoming) SDLNet_FreePacket(sock->incoming);
+    if (sock->socket) SDLNet_UDP_Close(sock->socket);
+    sock->outgoing = sock->incoming = NULL;
+    sock->socket = NULL;
+}
+
+Uint16 getNetSocketPort(const NetSocket* sock) {
+    IPaddress* local = SDLNet_UDP_GetPeerAddress(sock->socket, -1);
+    return local ? SDL_SwapBE16(local->port) : 0;
+}
+
+// Returns 0 if it could not be sent. A packet dropped on purpose counts as sent.
+int sendPacket(NetSocket* sock, const IPaddress* address, const Uint8* data, int bytes) {
+    if (!sock->socket || bytes > NET_MAX_PACKET) return 0;
+
+    if (sock->loss > 0.0f) {
+        // xorshift, the game's rand() is left alone
+        sock->rng ^= sock->rng << 13;
+        sock->rng ^= sock->rng >> 17;
+        sock->rng ^= sock->rng << 5;
+        if ((sock->rng & 0xFFFFFF) < sock->loss * 0x1000000) {
+            sock->traffic.packets_dropped++;
+            return 1;
+        }
+    }
+
+    memcpy(sock->outgoing->data, data, bytes);
+    sock->outgoing->len = bytes;
+    sock->outgoing->address = *address;
+    if (!SDLNet_UDP_Send(sock->socket, -1, sock->outgoing)) return 0;
+
+    sock->traffic.packets_sent++;
+    sock->traffic.bytes_sent += bytes;
+    return 1;
+}
+
+// Size of the next packet waiting, 0 when there is none
+int receivePacket(NetSocket* sock, IPaddress* from, const Uint8** data) {
+    if (!sock->socket || SDLNet_UDP_Recv(sock->socket, sock->incoming) <= 0) return 0;
+
+    sock->traffic.packets_received++;
+    sock->traffic.bytes_received += sock->incoming->len;
+    *from = sock->incoming->address;
+    *data = sock->incoming->data;
+    return sock->incoming->len;
+}
+
+int sameAddress(const IPaddress* a, const IPaddress* b) {
+    return a->host == b->host && a->port == b->port;
+}
@@ -0,0 +1,77 @@
+#ifndef NET_H
+#define NET_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_net.h>
+
+/*
+            DEFINITIONS
+*/
+#define NET_DEFAULT_PORT 27960
+#define NET_MAX_PACKET 8192          // Bytes. Past the MTU (~1400) IP fragments the datagram
+#define NET_UDP_HEADERS 28           // IPv4 and UDP header bytes on top of every payload
+
+/*
+            NET STRUCTURES
+*/
+// Bits go in from the least significant one up, byte after byte. A write
+// that does not fit sets overflow and the packet must not be sent.
+typedef struct {
+    Uint8* data;
+    int capacity;                    // Bytes
+    int bits;                        // Written so far
+    int overflow;
+} BitWriter;
+
+// Reading past the end returns zeros and sets overflow: the packet is malformed
+typedef struct {
+    const Uint8* data;
+    int size;                        // Bits
+    int bits;                        // Read so far
+    int overflow;
+} BitReader;
+
+// Payload bytes, without the UDP and IP headers
+typedef struct {
+    Uint64 packets_sent, bytes_sent;
+    Uint64 packets_dropped;          // By the loss setting, not sent
+    Uint64 packets_received, bytes_received;
+} NetTraffic;
+
+// A non-blocking UDP socket. loss drops that share of the packets sent, to
+// try the protocol on loopback as if it went over a real network.
+typedef struct {
+    UDPsocket socket;
+    UDPpacket* outgoing;
+    UDPpacket* incoming;             // Valid until the next receivePacket
+    float loss;                      // 0 to 1
+    Uint32 rng;
+    NetTraffic traffic;
+} NetSocket;
+
+
+/*
+            DECLARATIONS
+*/
+void initBitWriter(BitWriter* writer, Uint8* data, int capacity);
+void writeBits(BitWriter* writer, Uint32 value, int count);
+void appendBits(BitWriter* writer, const Uint8* data, int count);
+void writeVarint(BitWriter* writer, Uint32 value);
+void writeDelta(BitWriter* writer, Sint32 value, Sint32 base);
+int bitWriterBytes(const BitWriter* writer);
+
+void initBitReader(BitReader* reader, const Uint8* data, int bytes);
+Uint32 readBits(BitReader* reader, int count);
+Uint32 readVarint(BitReader* reader);
+Sint32 readDelta(BitReader* reader, Sint32 base);
+
+int bitsFor(Uint32 count);
+
+int openNetSocket(NetSocket* sock, Uint16 port, float loss);
+void closeNetSocket(NetSocket* sock);
+Uint16 getNetSocketPort(const NetSocket* sock);
+int sendPacket(NetSocket* sock, const IPaddress* address, const Uint8* data, int bytes);
+int receivePacket(NetSocket* sock, IPaddress* from, const Uint8** data);
+int sameAddress(const IPaddress* a, const IPaddress* b);
+
+#endif
@@ -0,0 +1,874 @@
+#include "netgame.h"
+#include "sim.h"
+#include "server.h"   // Headless world, bots
+#include "memtrack.h"
+#include "profiler.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Returns 1 if arg was one of the network options
+int parseNetArgument(const char* arg, NetOptions* options) {
+    if (strcmp(arg, "--host") == 0) {
+        options->host = 1;
+        return 1;
+    }
+    if (strncmp(arg, "--host=", 7) == 0) {
+        int port = atoi(arg + 7);
+        options->host = 1;
+        if (port < 1 || port > 65535) printf("Warning: --host needs a port from 1 to 65535, got %s\n", arg + 7);
+        else options->port = port;
+        return 1;
+    }
+    if (strncmp(arg, "--connect=", 10) == 0) {
+        snprintf(options->connect, sizeof(options->connect), "%s", arg + 10);
+        char* colon = strrchr(options->connect, ':');
+        if (colon) {
+            int port = atoi(colon + 1);
+            *colon = '\0';
+            if (port < 1 || port > 65535) printf("Warning: --connect needs a port from 1 to 65535, got %s\n", colon + 1);
+            else options->port = port;
+        }
+        return 1;
+    }
+    if (strcmp(arg, "--netbench") == 0) {
+        options->bench_players = NET_BENCH_PLAYERS;
+        return 1;
+    }
+    if (strncmp(arg, "--netbench=", 11) == 0) {
+        int players = atoi(arg + 11);
+        options->bench_players = NET_BENCH_PLAYERS;
+        if (players < 1 || players > NET_MAX_PLAYERS) printf("Warning: --netbench needs 1 to %d players, got %s\n", NET_MAX_PLAYERS, arg + 11);
+        else options->bench_players = players;
+        return 1;
+    }
+    if (strncmp(arg, "--loss=", 7) == 0) {
+        float percent = atof(arg + 7);
+        if (percent < 0.0f || percent > 90.0f) printf("Warning: --loss needs 0 to 90 percent, got %s\n", arg + 7);
+        else options->loss = percent / 100.0f;
+        return 1;
+    }
+    return 0;
+}
+
+// Both ends keep their snapshots at the same place
+static int historyIndex(Uint32 tick) {
+    return (tick / NET_SNAPSHOT_INTERVAL) % NET_SNAPSHOT_HISTORY;
+}
+
+static void writeControls(BitWriter* writer, const SimControls* controls) {
+    writeBits(writer, controls->thrust, 1);
+    writeBits(writer, controls->retro, 1);
+    writeBits(writer, controls->turn_left, 1);
+    writeBits(writer, controls->turn_right, 1);
+    writeBits(writer, controls->reset, 1);
+}
+
+static void readControls(BitReader* reader, SimControls* controls) {
+    controls->thrust = readBits(reader, 1);
+    controls->retro = readBits(reader, 1);
+    controls->turn_left = readBits(reader, 1);
+    controls->turn_right = readBits(reader, 1);
+    controls->reset = readBits(reader, 1);
+}
+
+static double counterMs(Uint64 counter) {
+    return counter * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+
+/*
+            SERVER
+*/
+int initNetServer(NetServer* server, BackgroundEffects* world, Uint16 port, float loss) {
+    memset(server, 0, sizeof(*server));
+    server->world = world;
+    if (SDLNet_Init() < 0) {
+        printf("Warning: SDL_net could not initialize: %s\n", SDLNet_GetError());
+        return 0;
+    }
+    if (!openNetSocket(&server->socket, port, loss)) {
+        SDLNet_Quit();
+        return 0;
+    }
+
+    server->world_hash = hashWorld(world);
+    server->flag_bytes = discoveryFlagBytes(world);
+    server->history = memCalloc(NET_SNAPSHOT_HISTORY, sizeof(NetSnapshot), MEM_NET);
+    server->history_flags = memCalloc(NET_SNAPSHOT_HISTORY * NET_MAX_PLAYERS, server->flag_bytes, MEM_NET);
+    server->no_flags = memCalloc(1, server->flag_bytes, MEM_NET);
+    checkInit(!server->history || !server->history_flags || !server->no_flags, "Failed to allocate the snapshot history!");
+    return 1;
+}
+
+static Uint8* peerFlags(NetServer* server, int index, int slot) {
+    return server->history_flags + ((size_t)index * NET_MAX_PLAYERS + slot) * server->flag_bytes;
+}
+
+static void disconnectPeer(NetServer* server, int slot, const char* reason) {
+    NetPeer* peer = &server->peers[slot];
+    destroySimPlayer(&peer->player);
+    peer->connected = 0;
+    server->num_peers--;
+    if (server->log) printf("Player %d %s, %d playing\n", slot, reason, server->num_peers);
+}
+
+void destroyNetServer(NetServer* server) {
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        if (server->peers[i].connected) disconnectPeer(server, i, "left with the server");
+    }
+    memFree(server->history);
+    memFree(server->history_flags);
+    memFree(server->no_flags);
+    server->history = NULL;
+    server->history_flags = server->no_flags = NULL;
+    closeNetSocket(&server->socket);
+    SDLNet_Quit();
+}
+
+static int findPeer(const NetServer* server, const IPaddress* address) {
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        if (server->peers[i].connected && sameAddress(&server->peers[i].address, address)) return i;
+    }
+    return -1;
+}
+
+// Players spawn on a circle around the sun, one place per slot
+static void connectPeer(NetServer* server, int slot, const IPaddress* address) {
+    NetPeer* peer = &server->peers[slot];
+    memset(peer, 0, sizeof(*peer));
+    peer->connected = 1;
+    peer->address = *address;
+    peer->next_input = 1;
+    peer->last_heard = server->tick;
+
+    float angle = slot * 2.0f * M_PI / NET_MAX_PLAYERS;
+    initSimPlayer(&peer->player, server->world, cosf(angle) * NET_SPAWN_RADIUS, sinf(angle) * NET_SPAWN_RADIUS);
+    quantizeSimPlayer(&peer->player);
+    peer->player.spawn_x = peer->player.x;
+    peer->player.spawn_y = peer->player.y;
+
+    server->num_peers++;
+    if (server->log) printf("Player %d joined, %d playing\n", slot, server->num_peers);
+}
+
+static void sendWelcome(NetServer* server, int slot) {
+    const NetPeer* peer = &server->peers[slot];
+    Uint8 data[16];
+    BitWriter writer;
+    initBitWriter(&writer, data, sizeof(data));
+    writeBits(&writer, NET_WELCOME, 4);
+    writeBits(&writer, slot, 6);
+    writeBits(&writer, server->tick, 32);
+    writeBits(&writer, (Uint32)lroundf(peer->player.spawn_x * NET_POSITION_SCALE), 32);
+    writeBits(&writer, (Uint32)lroundf(peer->player.spawn_y * NET_POSITION_SCALE), 32);
+    sendPacket(&server->socket, &peer->address, data, bitWriterBytes(&writer));
+}
+
+static void sendReject(NetServer* server, const IPaddress* address, int reason) {
+    Uint8 data[1];
+    BitWriter writer;
+    initBitWriter(&writer, data, sizeof(data));
+    writeBits(&writer, NET_REJECT, 4);
+    writeBits(&writer, reason, 2);
+    sendPacket(&server->socket, address, data, bitWriterBytes(&writer));
+}
+
+static void handleHello(NetServer* server, const IPaddress* from, BitReader* reader) {
+    Uint32 protocol = readBits(reader, 16);
+    Uint32 world_hash = readBits(reader, 32);
+    if (reader->overflow || protocol != NET_PROTOCOL) return;
+
+    // Already in: the welcome was lost, it gets it again
+    int slot = findPeer(server, from);
+    if (slot < 0) {
+        if (world_hash != server->world_hash) {
+            sendReject(server, from, NET_REJECT_WORLD);
+            return;
+        }
+        for (int i = 0; i < NET_MAX_PLAYERS && slot < 0; i++) {
+            if (!server->peers[i].connected) slot = i;
+        }
+        if (slot < 0) {
+            sendReject(server, from, NET_REJECT_FULL);
+            return;
+        }
+        connectPeer(server, slot, from);
+    }
+    sendWelcome(server, slot);
+}
+
+// The newest input and the ones before it, newest first
+static void handleInputs(NetServer* server, const IPaddress* from, BitReader* reader) {
+    int slot = readBits(reader, 6);
+    NetPeer* peer = &server->peers[slot];
+    if (!peer->connected || !sameAddress(&peer->address, from)) return;
+
+    Uint32 acked = readBits(reader, 32);
+    Uint32 newest = readBits(reader, 32);
+    int count = readBits(reader, 4);
+    SimControls inputs[15];
+    for (int i = 0; i < count; i++) readControls(reader, &inputs[i]);
+    if (reader->overflow) return;
+
+    peer->last_heard = server->tick;
+    if (acked > peer->acked && acked <= server->tick) peer->acked = acked;
+
+    for (int i = 0; i < count && (Uint32)i < newest; i++) {
+        Uint32 sequence = newest - i;
+        if (sequence < peer->next_input) break;                       // Applied already
+        if (sequence >= peer->next_input + NET_INPUT_HISTORY) continue;   // Too far ahead to keep
+        int index = sequence % NET_INPUT_HISTORY;
+        peer->inputs[index] = inputs[i];
+        peer->input_sequences[index] = sequence;
+    }
+    if (count > 0 && newest > peer->newest_input) peer->newest_input = newest;
+}
+
+static void receiveServerPackets(NetServer* server) {
+    IPaddress from;
+    const Uint8* data;
+    int size;
+    while ((size = receivePacket(&server->socket, &from, &data)) > 0) {
+        BitReader reader;
+        initBitReader(&reader, data, size);
+        switch (readBits(&reader, 4)) {
+            case NET_HELLO:
+                handleHello(server, &from, &reader);
+                break;
+            case NET_INPUT:
+                handleInputs(server, &from, &reader);
+                break;
+            case NET_BYE: {
+                int slot = readBits(&reader, 6);
+                if (!reader.overflow && server->peers[slot].connected && sameAddress(&server->peers[slot].address, &from)) {
+                    disconnectPeer(server, slot, "left");
+                }
+                break;
+            }
+            default:   // Not from a client
+                break;
+        }
+    }
+}
+
+// One tick of one player: its next input, or two when its clock runs ahead
+// of the server's and they pile up
+static void stepPeer(NetServer* server, NetPeer* peer) {
+    int steps = peer->newest_input >= peer->next_input + NET_INPUT_BUFFER ? 2 : 1;
+    for (int i = 0; i < steps; i++) {
+        Uint32 sequence = peer->next_input;
+        int index = sequence % NET_INPUT_HISTORY;
+        if (peer->input_sequences[index] == sequence) {
+            peer->last_controls = peer->inputs[index];
+        } else if (peer->newest_input <= sequence) {
+            return;   // Not sent yet
+        }
+        // Otherwise lost with every copy: the last controls stand in and the
+        // client gets corrected by the next snapshot
+        peer->next_input++;
+
+        SimEvents events;
+        stepSimPlayer(&peer->player, &peer->last_controls, server->world, &events);
+        quantizeSimPlayer(&peer->player);
+    }
+}
+
+// Encoded once per base and snapshot, most clients acked the same one
+static const NetEncoded* encodeWorld(NetServer* server, const NetSnapshot* snapshot, const NetSnapshot* base, Uint32 base_tick) {
+    for (int i = 0; i < server->cache_used; i++) {
+        if (server->cache[i].base == base_tick) {
+            server->stats.cache_hits++;
+            return &server->cache[i];
+        }
+    }
+
+    // Round robin: the base ticks are all multiples of NET_SNAPSHOT_INTERVAL
+    int slot = server->cache_used < NET_ENCODE_CACHE ? server->cache_used++ : server->cache_next;
+    server->cache_next = (slot + 1) % NET_ENCODE_CACHE;
+    NetEncoded* encoded = &server->cache[slot];
+    BitWriter writer;
+    initBitWriter(&writer, encoded->data, sizeof(encoded->data));
+    writeWorldDelta(&writer, snapshot, base);
+    encoded->base = base_tick;
+    encoded->bits = writer.bits;
+    encoded->overflow = writer.overflow;
+    return encoded;
+}
+
+// Against the newest snapshot the client has, when it is still kept
+static void sendSnapshot(NetServer* server, int slot) {
+    NetPeer* peer = &server->peers[slot];
+    int index = historyIndex(server->tick);
+    const NetSnapshot* snapshot = &server->history[index];
+
+    static const NetSnapshot nothing = {0};
+    const NetSnapshot* base = &nothing;
+    const Uint8* base_flags = server->no_flags;
+    Uint32 base_tick = 0;
+    if (peer->acked && server->tick - peer->acked < 256) {
+        int base_index = historyIndex(peer->acked);
+        if (server->history[base_index].tick == peer->acked) {
+            base = &server->history[base_index];
+            base_flags = peerFlags(server, base_index, slot);
+            base_tick = peer->acked;
+        }
+    }
+
+    const NetEncoded* world = encodeWorld(server, snapshot, base, base_tick);
+    Uint8 data[NET_MAX_PACKET];
+    BitWriter writer;
+    initBitWriter(&writer, data, sizeof(data));
+    writeBits(&writer, NET_SNAPSHOT, 4);
+    writeBits(&writer, server->tick, 32);
+    writeBits(&writer, base_tick ? server->tick - base_tick : 0, 8);
+    writeBits(&writer, peer->next_input - 1, 32);   // Last input applied
+    appendBits(&writer, world->data, world->bits);
+    writeFlagsDelta(&writer, peerFlags(server, index, slot), base_flags, server->world->num_astral_objects);
+    if (writer.overflow || world->overflow) {
+        server->stats.oversized++;
+        return;
+    }
+
+    int bytes = bitWriterBytes(&writer);
+    sendPacket(&server->socket, &peer->address, data, bytes);
+    server->stats.snapshots++;
+    server->stats.snapshot_bytes += bytes;
+    if (!base_tick) {
+        server->stats.full_snapshots++;
+        server->stats.full_bytes += bytes;
+    }
+}
+
+static void sendSnapshots(NetServer* server) {
+    PROFILE_FUNCTION();
+    int index = historyIndex(server->tick);
+    NetSnapshot* snapshot = &server->history[index];
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->tick = server->tick;
+    storePlanetAngles(snapshot->planet_angles, server->world);
+
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        NetPeer* peer = &server->peers[i];
+        Uint8* flags = peerFlags(server, index, i);
+        if (peer->connected) {
+            storePlayerState(&snapshot->players[i], &peer->player);
+            packDiscoveryFlags(flags, peer->player.discovered, server->world->num_astral_objects);
+        } else {
+            memset(flags, 0, server->flag_bytes);
+        }
+    }
+
+    server->cache_used = 0;
+    server->cache_next = 0;
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        if (server->peers[i].connected) sendSnapshot(server, i);
+    }
+}
+
+// One fixed tick: what the clients sent, the rules, then a snapshot every
+// NET_SNAPSHOT_INTERVAL ticks
+void updateNetServer(NetServer* server) {
+    PROFILE_FUNCTION();
+    Uint64 start = SDL_GetPerformanceCounter();
+    receiveServerPackets(server);
+
+    updateSolarSystem(server->world);
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        NetPeer* peer = &server->peers[i];
+        if (!peer->connected) continue;
+        if (server->tick - peer->last_heard > NET_TIMEOUT_TICKS) {
+            disconnectPeer(server, i, "timed out");
+            continue;
+        }
+        stepPeer(server, peer);
+    }
+    server->tick++;
+    Uint64 stepped = SDL_GetPerformanceCounter();
+
+    if (server->tick % NET_SNAPSHOT_INTERVAL == 0) sendSnapshots(server);
+    server->stats.ticks++;
+    server->stats.step_time += stepped - start;
+    server->stats.snapshot_time += SDL_GetPerformanceCounter() - stepped;
+}
+
+
+/*
+            CLIENT
+*/
+NetClient* createNetClient(const char* host, Uint16 port, float loss, BackgroundEffects* world) {
+    if (SDLNet_Init() < 0) {
+        printf("Warning: SDL_net could not initialize: %s\n", SDLNet_GetError());
+        return NULL;
+    }
+    NetClient* client = memCalloc(1, sizeof(NetClient), MEM_NET);
+    checkInit(!client, "Failed to allocate the network client!");
+
+    if (SDLNet_ResolveHost(&client->server, host, port) < 0) {
+        printf("Warning: Could not resolve %s: %s\n", host, SDLNet_GetError());
+        memFree(client);
+        SDLNet_Quit();
+        return NULL;
+    }
+    if (!openNetSocket(&client->socket, 0, loss)) {
+        memFree(client);
+        SDLNet_Quit();
+        return NULL;
+    }
+
+    client->world = world;
+    client->flag_bytes = discoveryFlagBytes(world);
+    client->history = memCalloc(NET_SNAPSHOT_HISTORY, sizeof(NetSnapshot), MEM_NET);
+    client->history_flags = memCalloc(NET_SNAPSHOT_HISTORY, client->flag_bytes, MEM_NET);
+    client->flags = memCalloc(1, client->flag_bytes, MEM_NET);
+    client->no_flags = memCalloc(1, client->flag_bytes, MEM_NET);
+    checkInit(!client->history || !client->history_flags || !client->flags || !client->no_flags,
+              "Failed to allocate the snapshot history!");
+
+    // The first hello goes with the first tick
+    client->state = NET_CONNECTING;
+    client->ticks = 0;
+    return client;
+}
+
+// Tells the server, so the slot frees up now rather than at the timeout
+void destroyNetClient(NetClient* client) {
+    if (!client) return;
+    if (client->state == NET_CONNECTED) {
+        Uint8 data[2];
+        BitWriter writer;
+        initBitWriter(&writer, data, sizeof(data));
+        writeBits(&writer, NET_BYE, 4);
+        writeBits(&writer, client->slot, 6);
+        sendPacket(&client->socket, &client->server, data, bitWriterBytes(&writer));
+    }
+
+    closeNetSocket(&client->socket);
+    memFree(client->history);
+    memFree(client->history_flags);
+    memFree(client->flags);
+    memFree(client->no_flags);
+    memFree(client);
+    SDLNet_Quit();
+}
+
+static Uint8* ownFlags(NetClient* client, int index) {
+    return client->history_flags + (size_t)index * client->flag_bytes;
+}
+
+static void sendHello(NetClient* client) {
+    Uint8 data[8];
+    BitWriter writer;
+    initBitWriter(&writer, data, sizeof(data));
+    writeBits(&writer, NET_HELLO, 4);
+    writeBits(&writer, NET_PROTOCOL, 16);
+    writeBits(&writer, hashWorld(client->world), 32);
+    sendPacket(&client->socket, &client->server, data, bitWriterBytes(&writer));
+}
+
+// The last count inputs, and the newest snapshot it has. 0 inputs keeps the
+// connection up while the game is paused, the player stays where it is.
+static void sendInputs(NetClient* client, int count) {
+    count = SDL_min(count, (int)SDL_min(client->input_sequence, NET_INPUT_REDUNDANCY));
+
+    Uint8 data[32];
+    BitWriter writer;
+    initBitWriter(&writer, data, sizeof(data));
+    writeBits(&writer, NET_INPUT, 4);
+    writeBits(&writer, client->slot, 6);
+    writeBits(&writer, client->latest, 32);
+    writeBits(&writer, client->input_sequence, 32);
+    writeBits(&writer, count, 4);
+    for (int i = 0; i < count; i++) {
+        writeControls(&writer, &client->inputs[(client->input_sequence - i) % NET_INPUT_HISTORY]);
+    }
+    sendPacket(&client->socket, &client->server, data, bitWriterBytes(&writer));
+}
+
+static void handleWelcome(NetClient* client, BitReader* reader, SimPlayer* player) {
+    int slot = readBits(reader, 6);
+    readBits(reader, 32);   // Server tick, only the snapshots' matter
+    float x = (Sint32)readBits(reader, 32) / NET_POSITION_SCALE;
+    float y = (Sint32)readBits(reader, 32) / NET_POSITION_SCALE;
+    if (reader->overflow) return;
+
+    // A new player at the server's spawn
+    client->slot = slot;
+    client->state = NET_CONNECTED;
+    client->ticks = 0;
+    player->x = player->spawn_x = x;
+    player->y = player->spawn_y = y;
+    player->speed_x = player->speed_y = 0;
+    player->angle = 0;
+    player->score = 0;
+    player->objectives_finished = 0;
+    memset(player->discovered, 0, client->world->num_astral_objects);
+    countDiscoveries(player, client->world);
+    if (client->log) printf("Connected as player %d\n", slot);
+}
+
+// Newer than everything so far and decoded against a snapshot it has
+static int readSnapshot(NetClient* client, BitReader* reader, Uint32* last_input) {
+    Uint32 tick = readBits(reader, 32);
+    int distance = readBits(reader, 8);
+    Uint32 input = readBits(reader, 32);
+    if (reader->overflow || tick <= client->latest) return 0;   // Late, or a duplicate
+
+    static const NetSnapshot nothing = {0};
+    const NetSnapshot* base = &nothing;
+    const Uint8* base_flags = client->no_flags;
+    if (distance) {
+        int base_index = historyIndex(tick - distance);
+        if (client->history[base_index].tick != tick - distance) return 0;
+        base = &client->history[base_index];
+        base_flags = ownFlags(client, base_index);
+    }
+
+    NetSnapshot snapshot;
+    snapshot.tick = tick;
+    readWorldDelta(reader, &snapshot, base);
+    readFlagsDelta(reader, client->flags, base_flags, client->world->num_astral_objects);
+    if (reader->overflow) return 0;
+
+    int index = historyIndex(tick);
+    client->history[index] = snapshot;
+    memcpy(ownFlags(client, index), client->flags, client->flag_bytes);
+    client->latest = tick;
+    *last_input = input;
+    return 1;
+}
+
+// Everyone else where the snapshot has them, the planets where they were
+static void applySnapshot(NetClient* client, const NetSnapshot* snapshot) {
+    loadPlanetAngles(client->world, snapshot->planet_angles);
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        const NetPlayerState* state = &snapshot->players[i];
+        NetRemotePlayer* remote = &client->remotes[i];
+        remote->present = state->present && i != client->slot;
+        remote->x = state->x / NET_POSITION_SCALE;
+        remote->y = state->y / NET_POSITION_SCALE;
+        remote->speed_x = state->speed_x / NET_SPEED_SCALE;
+        remote->speed_y = state->speed_y / NET_SPEED_SCALE;
+        remote->angle = state->angle;
+        remote->thrusting = state->thrusting;
+        remote->age = 0;
+    }
+}
+
+// The server's state as of last_input, then the inputs it has not applied
+// yet predicted again on top. The same code and the same quantized state on
+// both ends: without lost inputs the prediction comes out the same.
+static void reconcilePlayer(NetClient* client, SimPlayer* player, Uint32 last_input) {
+    int index = historyIndex(client->latest);
+    const NetPlayerState* state = &client->history[index].players[client->slot];
+    if (!state->present) return;
+
+    float predicted_x = player->x, predicted_y = player->y;
+    loadPlayerState(player, state);
+    unpackDiscoveryFlags(player->discovered, ownFlags(client, index), client->world->num_astral_objects);
+    countDiscoveries(player, client->world);
+
+    Uint32 first = last_input + 1;
+    if (client->input_sequence >= first && client->input_sequence - first >= NET_INPUT_HISTORY) {
+        first = client->input_sequence - NET_INPUT_HISTORY + 1;
+    }
+    for (Uint32 sequence = first; sequence <= client->input_sequence; sequence++) {
+        SimEvents events;   // Played when they were predicted the first time
+        stepSimPlayer(player, &client->inputs[sequence % NET_INPUT_HISTORY], client->world, &events);
+        quantizeSimPlayer(player);
+        client->stats.replayed++;
+    }
+
+    float error = hypotf(player->x - predicted_x, player->y - predicted_y);
+    if (error > 0.0f) {
+        client->stats.corrections++;
+        client->stats.max_error = fmaxf(client->stats.max_error, error);
+    }
+}
+
+static void receiveClientPackets(NetClient* client, SimPlayer* player) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    IPaddress from;
+    const Uint8* data;
+    int size, snapshots = 0;
+    Uint32 last_input = 0;
+    while ((size = receivePacket(&client->socket, &from, &data)) > 0) {
+        if (!sameAddress(&from, &client->server)) continue;
+
+        BitReader reader;
+        initBitReader(&reader, data, size);
+        int type = readBits(&reader, 4);
+        if (type == NET_WELCOME && client->state == NET_CONNECTING) {
+            handleWelcome(client, &reader, player);
+        } else if (type == NET_REJECT && client->state == NET_CONNECTING) {
+            int reason = readBits(&reader, 2);
+            printf("Warning: The server turned us away (%s), playing alone\n",
+                   reason == NET_REJECT_WORLD ? "it has another world, check --stars= and --objects=" : "it is full");
+            client->state = NET_OFFLINE;
+        } else if (type == NET_SNAPSHOT && client->state == NET_CONNECTED) {
+            if (readSnapshot(client, &reader, &last_input)) {
+                applySnapshot(client, &client->history[historyIndex(client->latest)]);
+                snapshots++;
+            }
+        }
+    }
+
+    // Only the newest one matters for the own player
+    if (snapshots) {
+        reconcilePlayer(client, player, last_input);
+        client->stats.snapshots += snapshots;
+        client->ticks = 0;
+    }
+    client->stats.receive_time += SDL_GetPerformanceCounter() - start;
+}
+
+// Hellos until the server answers, or gives up and plays alone
+static void keepConnecting(NetClient* client) {
+    if (client->ticks >= NET_CONNECT_TICKS) {
+        printf("Warning: No answer from the server, playing alone\n");
+        client->state = NET_OFFLINE;
+    } else if (client->ticks % NET_HELLO_TICKS == 0) {
+        sendHello(client);
+    }
+    client->ticks++;
+}
+
+static void checkServerTimeout(NetClient* client) {
+    if (++client->ticks > NET_TIMEOUT_TICKS) {
+        printf("Warning: Lost the server, playing alone\n");
+        client->state = NET_OFFLINE;
+    }
+}
+
+// One tick of the own player with the controls of this frame. Before the
+// server has answered, the player waits at the spawn.
+void stepNetClient(NetClient* client, SimPlayer* player, const SimControls* controls, SimEvents* events) {
+    PROFILE_FUNCTION();
+    events->num_discovered = 0;
+    events->finished = 0;
+    receiveClientPackets(client, player);
+
+    if (client->state == NET_OFFLINE) {
+        stepSimPlayer(player, controls, client->world, events);
+        return;
+    }
+    if (client->state == NET_CONNECTING) {
+        keepConnecting(client);
+        return;
+    }
+
+    client->input_sequence++;
+    client->inputs[client->input_sequence % NET_INPUT_HISTORY] = *controls;
+    sendInputs(client, NET_INPUT_REDUNDANCY);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    stepSimPlayer(player, controls, client->world, events);
+    quantizeSimPlayer(player);
+    client->stats.predict_time += SDL_GetPerformanceCounter() - start;
+    client->stats.ticks++;
+
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) client->remotes[i].age++;
+    checkServerTimeout(client);
+}
+
+// Between game ticks (in the menus): the connection stays up, the others move on
+void pollNetClient(NetClient* client, SimPlayer* player) {
+    receiveClientPackets(client, player);
+    if (client->state == NET_CONNECTING) {
+        keepConnecting(client);
+    } else if (client->state == NET_CONNECTED) {
+        sendInputs(client, 0);
+        for (int i = 0; i < NET_MAX_PLAYERS; i++) client->remotes[i].age++;
+        checkServerTimeout(client);
+    }
+}
+
+
+/*
+            HOST AND LOOPBACK HARNESS
+*/
+static void printHostReport(NetServer* server, double seconds) {
+    const NetServerStats* stats = &server->stats;
+    const NetTraffic* traffic = &server->socket.traffic;
+    double down = (traffic->bytes_sent + traffic->packets_sent * NET_UDP_HEADERS) * 8.0 / 1000.0 / seconds;
+    double up = (traffic->bytes_received + traffic->packets_received * NET_UDP_HEADERS) * 8.0 / 1000.0 / seconds;
+    printf("%d playing, %.1f kbit/s out, %.1f kbit/s in, %.3f ms/tick, %llu snapshots (%llu full)\n",
+           server->num_peers, down, up, counterMs(stats->step_time + stats->snapshot_time) / SDL_max(stats->ticks, 1),
+           (unsigned long long)stats->snapshots, (unsigned long long)stats->full_snapshots);
+    memset(&server->stats, 0, sizeof(server->stats));
+    memset(&server->socket.traffic, 0, sizeof(server->socket.traffic));
+}
+
+// --host: the server on its own, ticking in real time until Ctrl+C
+int runNetHost(const NetOptions* options, const WorldConfig* config) {
+    checkInit(SDL_Init(SDL_INIT_EVENTS) < 0, "SDL could not initialize!");
+    checkInit(!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG), "SDL_image could not initialize!");
+
+    BackgroundEffects* world = createHeadlessWorld(config);
+    static NetServer server;
+    checkInit(!initNetServer(&server, world, options->port, options->loss), "Could not open the server port!");
+    server.log = 1;
+    printf("Hosting on port %d: %d astral objects, world %08x, ticks of 1/%d s. Ctrl+C to stop.\n",
+           options->port, world->num_astral_objects, server.world_hash, FPS);
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    Uint64 ticks = 0;
+    while (!SDL_QuitRequested()) {
+        updateNetServer(&server);
+        ticks++;
+
+        // Sleep until the next tick is due, none are skipped when it falls behind
+        Uint64 due = start + ticks * frequency / FPS;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now < due) SDL_Delay((Uint32)((due - now) * 1000 / frequency));
+        if (ticks % (FPS * NET_HOST_REPORT_SECONDS) == 0) printHostReport(&server, NET_HOST_REPORT_SECONDS);
+    }
+
+    destroyNetServer(&server);
+    destroyHeadlessWorld(world);
+    IMG_Quit();
+    SDL_Quit();
+
+    printMemoryLeaks();
+    return 0;
+}
+
+typedef struct {
+    NetServer* server;
+    BackgroundEffects* world;        // The clients', planets from the snapshots
+    int count;
+    NetClient* clients[NET_MAX_PLAYERS];
+    SimPlayer players[NET_MAX_PLAYERS];
+    Bot bots[NET_MAX_PLAYERS];
+} NetBench;
+
+// The server's tick, then every client's: the inputs reach the server on the
+// next tick, the snapshots the clients on the same one
+static void stepNetBench(NetBench* bench) {
+    updateNetServer(bench->server);
+    for (int i = 0; i < bench->count; i++) {
+        SimControls controls;
+        SimEvents events;
+        runBot(&bench->bots[i], &bench->players[i], bench->world, &controls);
+        stepNetClient(bench->clients[i], &bench->players[i], &controls, &events);
+    }
+}
+
+static void resetNetBenchStats(NetBench* bench) {
+    memset(&bench->server->stats, 0, sizeof(bench->server->stats));
+    memset(&bench->server->socket.traffic, 0, sizeof(bench->server->socket.traffic));
+    for (int i = 0; i < bench->count; i++) {
+        memset(&bench->clients[i]->stats, 0, sizeof(bench->clients[i]->stats));
+        memset(&bench->clients[i]->socket.traffic, 0, sizeof(bench->clients[i]->socket.traffic));
+    }
+}
+
+static void printNetBenchReport(const NetBench* bench, double seconds) {
+    const NetServerStats* server = &bench->server->stats;
+    NetClientStats clients = {0};
+    NetTraffic up = {0};
+    for (int i = 0; i < bench->count; i++) {
+        const NetClientStats* stats = &bench->clients[i]->stats;
+        clients.snapshots += stats->snapshots;
+        clients.corrections += stats->corrections;
+        clients.replayed += stats->replayed;
+        clients.max_error = fmaxf(clients.max_error, stats->max_error);
+        clients.ticks += stats->ticks;
+        clients.receive_time += stats->receive_time;
+        clients.predict_time += stats->predict_time;
+        up.packets_sent += bench->clients[i]->socket.traffic.packets_sent;
+        up.bytes_sent += bench->clients[i]->socket.traffic.bytes_sent;
+    }
+
+    double snapshots_per_second = (double)FPS / NET_SNAPSHOT_INTERVAL;
+    double snapshot_bytes = (double)server->snapshot_bytes / SDL_max(server->snapshots, 1);
+    double full_bytes = (double)server->full_bytes / SDL_max(server->full_snapshots, 1);
+    double delta_bytes = (double)(server->snapshot_bytes - server->full_bytes) / SDL_max(server->snapshots - server->full_snapshots, 1);
+    // The same world as plain floats and ints, every field of every player, one byte per flag
+    int objects = bench->world->num_astral_objects;
+    double raw_bytes = bench->count * (6 * sizeof(float) + 3 * sizeof(int)) + NUM_PLANETS * sizeof(float) + objects;
+    double input_bytes = (double)up.bytes_sent / SDL_max(up.packets_sent, 1);
+    double tick_ms = 1000.0 / FPS;
+    double server_ms = counterMs(server->step_time + server->snapshot_time) / SDL_max(server->ticks, 1);
+
+    printf("Down, per client: %.1f bytes per snapshot (full %.1f, delta %.1f), %.1f kbit/s with the UDP/IP headers\n",
+           snapshot_bytes, full_bytes, delta_bytes, (snapshot_bytes + NET_UDP_HEADERS) * 8.0 * snapshots_per_second / 1000.0);
+    printf("  as plain floats, no deltas: %.0f bytes per snapshot, %.1f kbit/s\n",
+           raw_bytes, (raw_bytes + NET_UDP_HEADERS) * 8.0 * snapshots_per_second / 1000.0);
+    printf("  the server sends %.1f kbit/s to everyone, %llu full snapshots, %llu over %d bytes\n",
+           (server->snapshot_bytes + server->snapshots * NET_UDP_HEADERS) * 8.0 / 1000.0 / (server->ticks / (double)FPS),
+           (unsigned long long)server->full_snapshots, (unsigned long long)server->oversized, NET_MAX_PACKET);
+    printf("Up, per client: %.1f bytes per input packet, %.1f kbit/s with the UDP/IP headers\n",
+           input_bytes, (input_bytes + NET_UDP_HEADERS) * 8.0 * FPS / 1000.0);
+    printf("Server: %.4f ms/tick rules, %.4f ms/tick snapshots, %.2f%% of a %.2f ms tick, %.0f%% of the world deltas reused\n",
+           counterMs(server->step_time) / SDL_max(server->ticks, 1), counterMs(server->snapshot_time) / SDL_max(server->ticks, 1),
+           server_ms * 100.0 / tick_ms, tick_ms, server->cache_hits * 100.0 / SDL_max(server->snapshots, 1));
+    printf("Client: %.2f us/tick predicting, %.2f us per snapshot receiving and predicting again, %.2f inputs again per snapshot\n",
+           counterMs(clients.predict_time) * 1000.0 / SDL_max(clients.ticks, 1),
+           counterMs(clients.receive_time) * 1000.0 / SDL_max(clients.snapshots, 1),
+           (double)clients.replayed / SDL_max(clients.snapshots, 1));
+    printf("Prediction: %llu corrections in %llu snapshots, largest %.2f px\n",
+           (unsigned long long)clients.corrections, (unsigned long long)clients.snapshots, clients.max_error);
+    printf("%.2f s for %.1f s of play, %.1fx realtime\n", seconds, server->ticks / (double)FPS, server->ticks / (double)FPS / seconds);
+}
+
+// --netbench: a server and bot clients in this process, talking UDP over
+// loopback, as fast as they go. Reports the bandwidth and the CPU time, and
+// fails when the snapshot codec does not decode what it encodes.
+int runNetBench(const NetOptions* options, const WorldConfig* config) {
+    checkInit(SDL_Init(0) < 0, "SDL could not initialize!");
+
+    // A new seed every run, printed with the first round that fails
+    int codec_failures = checkSnapshotCodec((Uint32)SDL_GetPerformanceCounter());
+    if (codec_failures > 0) {
+        printf("Codec check: %d of %d rounds failed\n", codec_failures, NET_CODEC_ROUNDS);
+        SDL_Quit();
+        return 1;
+    }
+    printf("Codec check: %d random snapshots and flag sets decoded to what was sent\n", NET_CODEC_ROUNDS);
+    checkInit(!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG), "SDL_image could not initialize!");
+
+    static NetServer server;
+    static NetBench bench;
+    bench.server = &server;
+    bench.count = options->bench_players;
+    BackgroundEffects* server_world = createHeadlessWorld(config);
+    bench.world = createHeadlessWorld(config);
+    checkInit(!initNetServer(&server, server_world, 0, options->loss), "Could not open the server socket!");
+    Uint16 port = getNetSocketPort(&server.socket);
+
+    for (int i = 0; i < bench.count; i++) {
+        bench.clients[i] = createNetClient("127.0.0.1", port, options->loss, bench.world);
+        checkInit(!bench.clients[i], "Could not open a client socket!");
+        initSimPlayer(&bench.players[i], bench.world, 0, 0);
+        initBot(&bench.bots[i], i);
+    }
+    printf("Netbench: %d players, %d astral objects, %.0f%% loss, ticks of 1/%d s, a snapshot every %d\n",
+           bench.count, bench.world->num_astral_objects, options->loss * 100.0f, FPS, NET_SNAPSHOT_INTERVAL);
+
+    // Everyone in, then a second of play before measuring
+    for (int i = 0; i < NET_CONNECT_TICKS && server.num_peers < bench.count; i++) stepNetBench(&bench);
+    for (int i = 0; i < NET_BENCH_WARMUP_TICKS; i++) stepNetBench(&bench);
+    if (server.num_peers < bench.count) printf("Warning: Only %d of %d players connected\n", server.num_peers, bench.count);
+
+    resetNetBenchStats(&bench);
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < NET_BENCH_TICKS; i++) stepNetBench(&bench);
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    printNetBenchReport(&bench, seconds);
+
+    for (int i = 0; i < bench.count; i++) {
+        destroyNetClient(bench.clients[i]);
+        destroySimPlayer(&bench.players[i]);
+    }
+    destroyNetServer(&server);
+    destroyHeadlessWorld(bench.world);
+    destroyHeadlessWorld(server_world);
+    IMG_Quit();
+    SDL_Quit();
+
+    printMemoryLeaks();
+    return 0;
+}
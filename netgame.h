@@ -0,0 +1,159 @@
+#ifndef NETGAME_H
+#define NETGAME_H
+
+#include <SDL2/SDL.h>
+#include "init.h"
+#include "net.h"
+#include "snapshot.h"
+
+/*
+            DEFINITIONS
+*/
+#define NET_PROTOCOL 0x5346          // Opens every hello, anything else is not a client of this game
+#define NET_SNAPSHOT_INTERVAL 4      // Ticks between snapshots: 30 per second at 120 FPS
+#define NET_SNAPSHOT_HISTORY 32      // Snapshots both ends keep to delta against, about a second
+#define NET_INPUT_HISTORY 64         // Inputs by sequence: how far ahead of the server a client can predict
+#define NET_INPUT_REDUNDANCY 8       // Inputs per packet, the newest and the ones before it, for the lost packets
+#define NET_INPUT_BUFFER 4           // Inputs waiting on the server before it steps twice in a tick to catch up
+#define NET_ENCODE_CACHE 4           // World deltas kept per snapshot, one per snapshot clients acked
+#define NET_TIMEOUT_TICKS (FPS * 5)  // Silence before the server drops a client, or a client the server
+#define NET_HELLO_TICKS (FPS / 4)    // Between hellos while connecting
+#define NET_CONNECT_TICKS (FPS * 3)  // Of hellos before playing alone
+#define NET_SPAWN_RADIUS 600.0f      // px from the sun, players spawn on a circle
+#define NET_HOST_REPORT_SECONDS 10
+#define NET_BENCH_PLAYERS 64         // --netbench without a count
+#define NET_BENCH_TICKS (FPS * 30)   // Measured, once everyone is connected
+#define NET_BENCH_WARMUP_TICKS FPS
+
+// First 4 bits of every packet
+enum { NET_HELLO = 1, NET_WELCOME, NET_REJECT, NET_INPUT, NET_SNAPSHOT, NET_BYE };
+enum { NET_REJECT_FULL, NET_REJECT_WORLD };
+enum { NET_OFFLINE, NET_CONNECTING, NET_CONNECTED };
+
+/*
+            NETWORK STRUCTURES
+*/
+// --host[=port], --connect=host[:port], --netbench[=players], --loss=percent
+typedef struct {
+    int host;
+    Uint16 port;
+    char connect[64];                // Server to play on, empty to play alone
+    int bench_players;               // 0 when off
+    float loss;                      // Share of the packets dropped, 0 to 1
+} NetOptions;
+
+// A client as the server sees it. Inputs are numbered from 1 and applied one
+// per tick in order; one that is not here yet holds the player back rather
+// than guessing, which is what the client predicted.
+typedef struct {
+    int connected;
+    IPaddress address;
+    SimPlayer player;
+    SimControls inputs[NET_INPUT_HISTORY];
+    Uint32 input_sequences[NET_INPUT_HISTORY];   // Of the input in each slot, 0 for none
+    Uint32 next_input;               // Sequence the next step applies
+    Uint32 newest_input;             // Highest received
+    SimControls last_controls;       // Stand in for an input lost with every copy
+    Uint32 acked;                    // Newest snapshot it has, 0 for none
+    Uint32 last_heard;               // Server tick
+} NetPeer;
+
+// The world part of a snapshot against one base, the same for every client
+// that acked that base
+typedef struct {
+    Uint32 base;                     // Snapshot tick, 0 against nothing
+    int bits;
+    int overflow;
+    Uint8 data[NET_MAX_PACKET];
+} NetEncoded;
+
+typedef struct {
+    Uint64 snapshots, snapshot_bytes;
+    Uint64 full_snapshots, full_bytes;    // Against nothing: new clients, or acks too old
+    Uint64 cache_hits;               // Clients that got an already encoded world delta
+    Uint64 oversized;                // Snapshots over NET_MAX_PACKET, not sent
+    Uint64 ticks;
+    Uint64 step_time, snapshot_time; // Performance counter
+} NetServerStats;
+
+// Authoritative: clients only send their controls, every rule runs here and
+// the snapshots tell them what came of it
+typedef struct {
+    BackgroundEffects* world;
+    NetSocket socket;
+    NetPeer peers[NET_MAX_PLAYERS];
+    int num_peers;
+    Uint32 tick;
+    Uint32 world_hash;
+    int flag_bytes;                  // Discovery flags of one player, packed
+    NetSnapshot* history;            // NET_SNAPSHOT_HISTORY, at tick / NET_SNAPSHOT_INTERVAL
+    Uint8* history_flags;            // Flags of every player for each of them
+    Uint8* no_flags;                 // What a full snapshot's flags are coded against
+    NetEncoded cache[NET_ENCODE_CACHE];   // World deltas of the snapshot being sent
+    int cache_used;
+    int cache_next;                  // Slot the next miss replaces once they are all used
+    int log;                         // Print who comes and goes
+    NetServerStats stats;
+} NetServer;
+
+// Another player as of the last snapshot
+typedef struct {
+    int present;
+    float x, y;
+    float speed_x, speed_y;
+    float angle;
+    int thrusting;
+    int age;                         // Ticks since, it is drawn that far along its speed
+} NetRemotePlayer;
+
+typedef struct {
+    Uint64 snapshots;
+    Uint64 corrections;              // Snapshots that moved the predicted player
+    Uint64 replayed;                 // Inputs predicted again after a snapshot
+    float max_error;                 // px, largest correction
+    Uint64 ticks;
+    Uint64 receive_time, predict_time;    // Performance counter
+} NetClientStats;
+
+// Sends the controls of every tick and predicts the own player with them.
+// A snapshot gives the server's state as of the last input it applied: the
+// player is put there and the inputs after it are predicted again.
+typedef struct NetClient {
+    int state;
+    int ticks;                       // In this state, or since the last snapshot
+    NetSocket socket;
+    IPaddress server;
+    int slot;
+    BackgroundEffects* world;
+    int flag_bytes;
+    NetSnapshot* history;            // Received, at tick / NET_SNAPSHOT_INTERVAL
+    Uint8* history_flags;            // The own discovery flags of each
+    Uint8* flags;                    // Decoded, before it is known to be good
+    Uint8* no_flags;
+    Uint32 latest;                   // Newest snapshot tick, what is acked
+    SimControls inputs[NET_INPUT_HISTORY];
+    Uint32 input_sequence;           // Of the newest input
+    NetRemotePlayer remotes[NET_MAX_PLAYERS];
+    int log;                         // Print the connection changes
+    NetClientStats stats;
+} NetClient;
+
+
+/*
+            DECLARATIONS
+*/
+int parseNetArgument(const char* arg, NetOptions* options);
+
+int initNetServer(NetServer* server, BackgroundEffects* world, Uint16 port, float loss);
+void destroyNetServer(NetServer* server);
+void updateNetServer(NetServer* server);
+
+NetClient* createNetClient(const char* host, Uint16 port, float loss, BackgroundEffects* world);
+void destroyNetClient(NetClient* client);
+void stepNetClient(NetClient* client, SimPlayer* player, const SimControls* controls, SimEvents* events);
+void pollNetClient(NetClient* client, SimPlayer* player);
+
+int runNetHost(const NetOptions* options, const WorldConfig* config);
+int runNetBench(const NetOptions* options, const WorldConfig* config);
+
+#endif
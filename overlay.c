@@ -0,0 +1,153 @@
+#include "overlay.h"
+#include "drawstats.h"
+#include "memtrack.h"
+#include <stdio.h>
+#include <string.h>
+
+void initPerfOverlay(PerfOverlay* overlay, float budget_ms) {
+    memset(overlay, 0, sizeof(*overlay));
+    overlay->budget_ms = budget_ms;
+}
+
+void destroyPerfOverlay(PerfOverlay* overlay) {
+    destroyTrackedTexture(overlay->text);
+    overlay->text = NULL;
+}
+
+void togglePerfOverlay(PerfOverlay* overlay) {
+    overlay->visible = !overlay->visible;
+    overlay->text_time = 0;
+}
+
+static float counterToMs(Uint64 ticks) {
+    return ticks * 1000.0f / SDL_GetPerformanceFrequency();
+}
+
+// Once per frame, after the present. render time and the draw counts come
+// from drawStats, filled by renderGameScreen. The text the overlay renders
+// for itself is not counted as a created texture.
+void recordOverlayFrame(PerfOverlay* overlay, float sim_ms) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    float frame_ms = overlay->last_frame ? counterToMs(now - overlay->last_frame) : 0.0f;
+    overlay->last_frame = now;
+
+    size_t texture_bytes;
+    Uint64 textures_created;
+    getTextureTotals(&texture_bytes, &textures_created);
+    int created = overlay->textures_seen ? (int)(textures_created - overlay->textures_seen) - overlay->own_textures : 0;
+    created = SDL_max(created, 0);   // memtrack misses textures once its table is full
+    overlay->textures_seen = textures_created;
+    overlay->own_textures = 0;
+
+    overlay->history[overlay->head] = (OverlayFrame){ frame_ms, sim_ms + drawStats.render_ms };
+    overlay->head = (overlay->head + 1) % OVERLAY_HISTORY;
+
+    overlay->frames++;
+    overlay->frame_ms += frame_ms;
+    overlay->frame_max_ms = SDL_max(overlay->frame_max_ms, frame_ms);
+    overlay->sim_ms += sim_ms;
+    overlay->render_ms += drawStats.render_ms;
+    overlay->draw_calls += drawStats.draw_calls;
+    overlay->textures_created += created;
+}
+
+// Averages since the last update, then starts summing again
+static void updateOverlayText(SDL_Renderer* renderer, PerfOverlay* overlay, TTF_Font* font, Uint32 now) {
+    int frames = SDL_max(overlay->frames, 1);
+    size_t texture_bytes;
+    Uint64 textures_created;
+    getTextureTotals(&texture_bytes, &textures_created);
+    LatencyReport latency = {0};
+    if (overlay->latency) getLatencyReport(overlay->latency, &latency);
+    FrameStats pacing = {0};
+    if (overlay->pacer) getFrameStats(overlay->pacer, &pacing);
+
+    char text[512];
+    snprintf(text, sizeof(text),
+             "frame %.2f ms (max %.2f)\n"
+             "sim %.2f ms  render %.2f ms  overlay %.3f ms\n"
+             "draw calls %d  textures created %.1f\n"
+             "stars %d / %d  objects %d / %d\n"
+             "%s frames p50 %.2f  p95 %.2f  p99 %.2f ms\n"
+             "input latency p50 %.1f ms  p99 %.1f ms (%d presses)\n"
+             "texture memory %.1f MB\n"
+             "graph: frame (yellow), sim + render (blue), budget (red)",
+             overlay->frame_ms / frames, overlay->frame_max_ms,
+             overlay->sim_ms / frames, overlay->render_ms / frames, overlay->overlay_ms / frames,
+             overlay->draw_calls / frames, (float)overlay->textures_created / frames,
+             drawStats.stars_drawn, drawStats.stars_total, drawStats.objects_drawn, drawStats.objects_total,
+             overlay->pacer ? paceModeName(overlay->pacer->mode) : "paced", pacing.p50_ms, pacing.p95_ms, pacing.p99_ms,
+             latency.p50, latency.p99, latency.samples,
+             texture_bytes / (1024.0 * 1024.0));
+
+    overlay->frames = 0;
+    overlay->frame_ms = overlay->frame_max_ms = overlay->sim_ms = overlay->render_ms = overlay->overlay_ms = 0.0f;
+    overlay->draw_calls = overlay->textures_created = 0;
+    overlay->text_time = now;
+
+    destroyTrackedTexture(overlay->text);
+    overlay->text = NULL;
+
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* surface = TTF_RenderText_Blended_Wrapped(font, text, white, OVERLAY_HISTORY * 2);
+    if (!surface) return;
+    overlay->text = SDL_CreateTextureFromSurface(renderer, surface);
+    overlay->text_size = (SDL_Point){ surface->w, surface->h };
+    SDL_FreeSurface(surface);
+    trackTexture(overlay->text, TEXCAT_UI);
+    if (overlay->text) overlay->own_textures++;
+}
+
+static int graphY(int bottom, float ms) {
+    return bottom - (int)(SDL_min(ms / OVERLAY_GRAPH_MS, 1.0f) * OVERLAY_GRAPH_HEIGHT);
+}
+
+// Bottom left, over the gameplay and before the present
+void renderPerfOverlay(SDL_Renderer* renderer, PerfOverlay* overlay, TTF_Font* font) {
+    if (!overlay->visible) return;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    Uint32 now = SDL_GetTicks();
+    if (!overlay->text || now - overlay->text_time >= OVERLAY_TEXT_MS) updateOverlayText(renderer, overlay, font, now);
+
+    int w, h;
+    SDL_RenderGetLogicalSize(renderer, &w, &h);
+    if (h == 0) SDL_GetRendererOutputSize(renderer, &w, &h);
+
+    const int graph_w = OVERLAY_HISTORY * 2;
+    SDL_Rect panel = { OVERLAY_MARGIN, 0, graph_w + 2 * OVERLAY_MARGIN, overlay->text_size.y + OVERLAY_GRAPH_HEIGHT + 3 * OVERLAY_MARGIN };
+    panel.y = h - OVERLAY_MARGIN - panel.h;
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(renderer, &panel);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    int x = panel.x + OVERLAY_MARGIN;
+    if (overlay->text) {
+        SDL_Rect text_rect = { x, panel.y + OVERLAY_MARGIN, overlay->text_size.x, overlay->text_size.y };
+        SDL_RenderCopy(renderer, overlay->text, NULL, &text_rect);
+    }
+
+    // Oldest frame on the left, two pixels per frame
+    int bottom = panel.y + panel.h - OVERLAY_MARGIN;
+    SDL_SetRenderDrawColor(renderer, 255, 80, 80, 255);
+    SDL_RenderDrawLine(renderer, x, graphY(bottom, overlay->budget_ms), x + graph_w, graphY(bottom, overlay->budget_ms));
+
+    for (int i = 0; i < OVERLAY_HISTORY; i++) {
+        const OverlayFrame* frame = &overlay->history[(overlay->head + i) % OVERLAY_HISTORY];
+        overlay->points[i] = (SDL_Point){ x + i * 2, graphY(bottom, frame->frame_ms) };
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 230, 0, 255);
+    SDL_RenderDrawLines(renderer, overlay->points, OVERLAY_HISTORY);
+
+    for (int i = 0; i < OVERLAY_HISTORY; i++) {
+        const OverlayFrame* frame = &overlay->history[(overlay->head + i) % OVERLAY_HISTORY];
+        overlay->points[i] = (SDL_Point){ x + i * 2, graphY(bottom, frame->work_ms) };
+    }
+    SDL_SetRenderDrawColor(renderer, 80, 200, 255, 255);
+    SDL_RenderDrawLines(renderer, overlay->points, OVERLAY_HISTORY);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    overlay->overlay_ms += counterToMs(SDL_GetPerformanceCounter() - start);
+}
@@ -0,0 +1,63 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include "latency.h"
+#include "pacer.h"
+
+/*
+            DEFINITIONS
+*/
+#define OVERLAY_HISTORY 240          // Frames in the graph
+#define OVERLAY_GRAPH_HEIGHT 100     // px
+#define OVERLAY_GRAPH_MS 33.3f       // Top of the graph
+#define OVERLAY_TEXT_MS 250          // The text is re-rendered this often, averaged in between
+#define OVERLAY_MARGIN 10
+
+/*
+            OVERLAY STRUCTURES
+*/
+typedef struct {
+    float frame_ms;                  // Present to present
+    float work_ms;                   // Simulation and render
+} OverlayFrame;
+
+// Performance overlay over the gameplay. Frames are recorded whether it is
+// shown or not, so the graph is full when it is turned on. Drawing it is a
+// fill, two polylines and one cached text texture: the text only goes
+// through SDL_ttf every OVERLAY_TEXT_MS.
+typedef struct {
+    int visible;
+    float budget_ms;                 // Frame budget line in the graph
+
+    OverlayFrame history[OVERLAY_HISTORY];
+    int head;                        // Next slot
+    Uint64 last_frame;
+
+    // Summed since the text was last rendered
+    int frames;
+    float frame_ms, frame_max_ms, sim_ms, render_ms, overlay_ms;
+    int draw_calls, textures_created;
+    Uint64 textures_seen;            // Created by memtrack at the previous frame
+    int own_textures;                // Text textures since then, left out of the count
+    const LatencyTracker* latency;   // Set by the game loop, NULL shows no latency
+    const FramePacer* pacer;         // Same, for the frame time percentiles
+
+    SDL_Texture* text;
+    SDL_Point text_size;
+    Uint32 text_time;
+    SDL_Point points[OVERLAY_HISTORY];
+} PerfOverlay;
+
+
+/*
+            DECLARATIONS
+*/
+void initPerfOverlay(PerfOverlay* overlay, float budget_ms);
+void destroyPerfOverlay(PerfOverlay* overlay);
+void togglePerfOverlay(PerfOverlay* overlay);
+void recordOverlayFrame(PerfOverlay* overlay, float sim_ms);
+void renderPerfOverlay(SDL_Renderer* renderer, PerfOverlay* overlay, TTF_Font* font);
+
+#endif
@@ -0,0 +1,181 @@
+#include "pacer.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* modeNames[PACE_MODES] = { "uncapped", "capped", "vsync" };
+
+const char* paceModeName(PaceMode mode) {
+    return mode >= 0 && mode < PACE_MODES ? modeNames[mode] : "?";
+}
+
+static double counterToMs(const FramePacer* fp, Uint64 ticks) {
+    return ticks * 1000.0 / fp->frequency;
+}
+
+// Capped mode, and vsync mode when the present does not actually wait
+static int isCapped(const FramePacer* fp) {
+    return fp->mode == PACE_CAPPED || (fp->mode == PACE_VSYNC && !fp->vsync);
+}
+
+static double capRate(const FramePacer* fp) {
+    if (fp->mode == PACE_VSYNC && fp->refresh_hz > 0) return fp->refresh_hz;
+    return fp->target_fps;
+}
+
+static void describePacing(const FramePacer* fp) {
+    if (isCapped(fp)) printf("Pacing: %s, %.0f fps", paceModeName(fp->mode), capRate(fp));
+    else printf("Pacing: %s", paceModeName(fp->mode));
+    if (fp->refresh_hz > 0) printf(" (display %.0f Hz, vsync %s)\n", fp->refresh_hz, fp->vsync ? "on" : "off");
+    else printf(" (vsync %s)\n", fp->vsync ? "on" : "off");
+}
+
+void initFramePacer(FramePacer* fp, SDL_Renderer* renderer, SDL_Window* window, PaceMode mode, double target_fps) {
+    memset(fp, 0, sizeof(*fp));
+    fp->renderer = renderer;
+    fp->target_fps = target_fps;
+    fp->frequency = SDL_GetPerformanceFrequency();
+    fp->spin_ms = 1.0;
+
+    SDL_DisplayMode display;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &display) == 0) fp->refresh_hz = display.refresh_rate;
+
+    setPaceMode(fp, mode);
+}
+
+// Turns vsync on or off to match and starts new statistics
+void setPaceMode(FramePacer* fp, PaceMode mode) {
+    fp->mode = mode;
+
+    int want_vsync = mode == PACE_VSYNC;
+    if (SDL_RenderSetVSync(fp->renderer, want_vsync) == 0) {
+        fp->vsync = want_vsync;
+    } else {
+        // Cannot switch it: whatever the renderer was created with stays
+        SDL_RendererInfo info;
+        fp->vsync = SDL_GetRendererInfo(fp->renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC);
+        if (fp->vsync != want_vsync) printf("Warning: Cannot turn vsync %s: %s\n", want_vsync ? "on" : "off", SDL_GetError());
+    }
+    fp->vsync_probe = mode == PACE_VSYNC && fp->vsync && fp->refresh_hz > 0 ? PACER_VSYNC_PROBE : 0;
+
+    fp->period = (Uint64)(fp->frequency / capRate(fp));
+    fp->deadline = SDL_GetPerformanceCounter() + fp->period;
+    fp->last_frame = 0;
+    resetFrameStats(fp);
+    describePacing(fp);
+}
+
+// For comparing strategies in game: the statistics of the last one are printed first
+void cyclePaceMode(FramePacer* fp) {
+    printFrameStats(fp);
+    setPaceMode(fp, (fp->mode + 1) % PACE_MODES);
+}
+
+// SDL_Delay while the deadline is further than the spin window, then spin
+static void waitUntil(FramePacer* fp, Uint64 deadline) {
+    for (;;) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now >= deadline) return;
+
+        double remaining = counterToMs(fp, deadline - now);
+        if (remaining <= fp->spin_ms) continue;
+
+        Uint32 sleep = (Uint32)(remaining - fp->spin_ms);
+        if (sleep == 0) continue;
+        SDL_Delay(sleep);
+
+        // The spin window follows how late the scheduler wakes us up
+        double late = counterToMs(fp, SDL_GetPerformanceCounter() - now) - sleep;
+        fp->oversleep_ms += (late - fp->oversleep_ms) * 0.1;
+        fp->spin_ms = SDL_clamp(2.0 * fp->oversleep_ms, PACER_MIN_SPIN_MS, PACER_MAX_SPIN_MS);
+    }
+}
+
+static void recordFrame(FramePacer* fp, double ms) {
+    int bucket = (int)(ms * 1000.0 / PACER_BUCKET_US);
+    if (bucket >= PACER_BUCKETS) bucket = PACER_BUCKETS - 1;
+    fp->histogram[bucket]++;
+    fp->frames++;
+    fp->total_ms += ms;
+    if (ms > fp->max_ms) fp->max_ms = ms;
+}
+
+// A driver can report vsync and not wait (forced off, some compositors):
+// then frames come much faster than the display and we cap ourselves
+static void checkVsync(FramePacer* fp) {
+    if (fp->vsync_probe == 0 || --fp->vsync_probe > 0) return;
+
+    FrameStats stats;
+    getFrameStats(fp, &stats);
+    if (stats.p50_ms < 0.75 * 1000.0 / fp->refresh_hz) {
+        printf("Warning: Vsync is not waiting (%.2f ms frames), capping instead\n", stats.p50_ms);
+        fp->vsync = 0;
+        fp->deadline = SDL_GetPerformanceCounter() + fp->period;
+        resetFrameStats(fp);
+        describePacing(fp);
+    }
+}
+
+// Right after SDL_RenderPresent
+void endFrame(FramePacer* fp) {
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (isCapped(fp)) {
+        if (now < fp->deadline) {
+            waitUntil(fp, fp->deadline);
+            now = SDL_GetPerformanceCounter();
+        } else {
+            fp->missed++;
+        }
+
+        // Fell more than a frame behind: start over rather than rush to catch up
+        fp->deadline += fp->period;
+        if (now > fp->deadline) fp->deadline = now + fp->period;
+    }
+
+    if (fp->last_frame) recordFrame(fp, counterToMs(fp, now - fp->last_frame));
+    fp->last_frame = now;
+    checkVsync(fp);
+}
+
+// Histogram bucket centers, good to PACER_BUCKET_US (never above the max)
+static double histogramPercentile(const FramePacer* fp, double p) {
+    Uint64 rank = (Uint64)(p * fp->frames + 0.999999);
+    if (rank == 0) rank = 1;
+
+    Uint64 seen = 0;
+    for (int i = 0; i < PACER_BUCKETS - 1; i++) {
+        seen += fp->histogram[i];
+        if (seen >= rank) return SDL_min((i + 0.5) * PACER_BUCKET_US / 1000.0, fp->max_ms);
+    }
+    return fp->max_ms;
+}
+
+void getFrameStats(const FramePacer* fp, FrameStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (fp->frames == 0) return;
+
+    stats->frames = fp->frames;
+    stats->average_ms = fp->total_ms / fp->frames;
+    stats->p50_ms = histogramPercentile(fp, 0.50);
+    stats->p95_ms = histogramPercentile(fp, 0.95);
+    stats->p99_ms = histogramPercentile(fp, 0.99);
+    stats->max_ms = fp->max_ms;
+}
+
+void resetFrameStats(FramePacer* fp) {
+    memset(fp->histogram, 0, sizeof(fp->histogram));
+    fp->frames = 0;
+    fp->total_ms = 0.0;
+    fp->max_ms = 0.0;
+    fp->missed = 0;
+}
+
+void printFrameStats(const FramePacer* fp) {
+    FrameStats stats;
+    getFrameStats(fp, &stats);
+    printf("Frames (%s): %llu, average %.2f ms, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms",
+           paceModeName(fp->mode), (unsigned long long)stats.frames, stats.average_ms,
+           stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms);
+    if (isCapped(fp)) printf(", %llu missed deadlines\n", (unsigned long long)fp->missed);
+    else printf("\n");
+}
@@ -0,0 +1,71 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include <SDL2/SDL.h>
+
+/*
+            DEFINITIONS
+*/
+#define PACER_BUCKET_US 100          // Histogram resolution
+#define PACER_BUCKETS 500            // Up to 50 ms, the last bucket takes everything longer
+#define PACER_MIN_SPIN_MS 0.5        // Spin at least this long before a deadline
+#define PACER_MAX_SPIN_MS 4.0
+#define PACER_VSYNC_PROBE 60         // Frames timed before trusting vsync
+
+typedef enum {
+    PACE_UNCAPPED,                   // Vsync off, as fast as it goes
+    PACE_CAPPED,                     // Vsync off, sleep then spin to the target rate
+    PACE_VSYNC,                      // Present waits for the display
+    PACE_MODES
+} PaceMode;
+
+/*
+            PACER STRUCTURES
+*/
+typedef struct {
+    Uint64 frames;
+    double average_ms;
+    double p50_ms, p95_ms, p99_ms, max_ms;
+} FrameStats;
+
+// Frame limiter on the performance counter. Waiting sleeps while the deadline
+// is far, then spins for the last stretch: how long depends on how late
+// SDL_Delay has been waking up. Frame times (present to present) go into a
+// histogram the percentiles are read from.
+typedef struct {
+    SDL_Renderer* renderer;
+    PaceMode mode;
+    double target_fps;
+    double refresh_hz;               // Display, 0 if unknown
+
+    Uint64 frequency;
+    Uint64 period;                   // Counter ticks per frame while capped
+    Uint64 deadline;                 // End of the current frame while capped
+    Uint64 last_frame;
+
+    int vsync;                       // The renderer has vsync on
+    int vsync_probe;                 // Frames left before checking it really waits
+    double spin_ms;                  // Adaptive, from the sleep overshoot
+    double oversleep_ms;             // Running average of SDL_Delay lateness
+
+    Uint32 histogram[PACER_BUCKETS];
+    Uint64 frames;
+    double total_ms;
+    double max_ms;
+    Uint64 missed;                   // Capped frames that ended past their deadline
+} FramePacer;
+
+
+/*
+            DECLARATIONS
+*/
+void initFramePacer(FramePacer* fp, SDL_Renderer* renderer, SDL_Window* window, PaceMode mode, double target_fps);
+void setPaceMode(FramePacer* fp, PaceMode mode);
+void cyclePaceMode(FramePacer* fp);
+void endFrame(FramePacer* fp);
+void getFrameStats(const FramePacer* fp, FrameStats* stats);
+void resetFrameStats(FramePacer* fp);
+void printFrameStats(const FramePacer* fp);
+const char* paceModeName(PaceMode mode);
+
+#endif
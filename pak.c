@@ -0,0 +1,72 @@
+#include "pak.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Returns 1 if the archive was mapped, 0 if the game should use loose files
+int openAssetArchive(AssetArchive* archive, const char* path) {
+    memset(archive, 0, sizeof(*archive));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PakHeader)) {
+        close(fd);
+        return 0;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file alive
+    if (data == MAP_FAILED) {
+        printf("Warning: Failed to map asset archive %s\n", path);
+        return 0;
+    }
+
+    const PakHeader* header = data;
+    size_t index_end = sizeof(PakHeader) + (size_t)header->count * sizeof(PakEntry);
+    if (memcmp(header->magic, PAK_MAGIC, 4) != 0 || header->version != PAK_VERSION || index_end > (size_t)st.st_size) {
+        printf("Warning: Ignoring invalid asset archive %s (run make assets)\n", path);
+        munmap(data, st.st_size);
+        return 0;
+    }
+
+    archive->data = data;
+    archive->size = st.st_size;
+    archive->entries = (const PakEntry*)(archive->data + sizeof(PakHeader));
+    archive->count = header->count;
+    archive->mtime = st.st_mtime;
+
+    printf("Asset archive %s: %d images, %.1f MB\n", path, archive->count, archive->size / (1024.0 * 1024.0));
+    return 1;
+}
+
+void closeAssetArchive(AssetArchive* archive) {
+    if (archive->data) munmap((void*)archive->data, archive->size);
+    memset(archive, 0, sizeof(*archive));
+}
+
+// Returns NULL when the image is not packed or its source was edited after packing
+const PakEntry* findArchiveEntry(AssetArchive* archive, const char* path) {
+    if (!archive->data) return NULL;
+
+    for (int i = 0; i < archive->count; i++) {
+        const PakEntry* entry = &archive->entries[i];
+        if (strncmp(entry->path, path, PAK_PATH_LENGTH) != 0) continue;
+
+        if (entry->offset + entry->size > archive->size) return NULL;
+
+        struct stat st;
+        if (stat(path, &st) == 0 && st.st_mtime > archive->mtime) return NULL;
+
+        return entry;
+    }
+    return NULL;
+}
+
+const void* archivePixels(AssetArchive* archive, const PakEntry* entry) {
+    return archive->data + entry->offset;
+}
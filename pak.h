@@ -0,0 +1,59 @@
+#ifndef PAK_H
+#define PAK_H
+
+#include <SDL2/SDL.h>
+
+/*
+            ARCHIVE FORMAT
+*/
+// data/assets.pak, written by `make assets` (tools/packassets.c):
+//   PakHeader | PakEntry[count] | pixel blobs
+// Pixels are RGBA32 (bytes R, G, B, A), pitch = width * 4, each blob starts
+// on a PAK_ALIGN boundary so it can be uploaded straight from the mapping.
+#define PAK_MAGIC "FPAK"
+#define PAK_VERSION 2
+#define PAK_PATH_LENGTH 112
+#define PAK_ALIGN 64
+#define PAK_DEFAULT_PATH "data/assets.pak"
+
+// PakEntry.flags
+#define PAK_ALPHA 0x1 // The source had an alpha channel or a color key
+
+typedef struct {
+    char magic[4];
+    Uint32 version;
+    Uint32 count;
+    Uint32 reserved;
+} PakHeader;
+
+typedef struct {
+    char path[PAK_PATH_LENGTH];  // Source path, as referenced by the game
+    Uint32 width, height;        // Stored (draw) resolution
+    Uint32 logical_w, logical_h; // Resolution of the source image
+    Uint64 offset;               // From the start of the file
+    Uint64 size;
+    Uint32 flags;                // PAK_ALPHA
+    Uint32 reserved;
+} PakEntry;
+
+/*
+            RUNTIME STRUCTURE
+*/
+typedef struct {
+    const Uint8* data;       // Read-only mapping of the whole file
+    size_t size;
+    const PakEntry* entries;
+    int count;
+    long mtime;              // Sources newer than this are read from disk instead
+} AssetArchive;
+
+
+/*
+            DECLARATIONS
+*/
+int openAssetArchive(AssetArchive* archive, const char* path);
+void closeAssetArchive(AssetArchive* archive);
+const PakEntry* findArchiveEntry(AssetArchive* archive, const char* path);
+const void* archivePixels(AssetArchive* archive, const PakEntry* entry);
+
+#endif
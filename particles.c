@@ -0,0 +1,268 @@
+#include "particles.h"
+#include "profiler.h"
+#define DRAWSTATS_COUNT
+#include "drawstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#define PARTICLE_TEXTURE_SIZE 32
+
+// Creates a small white disc with a soft edge, tinted per vertex at render time
+static SDL_Texture* createParticleTexture(SDL_Renderer* renderer) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, PARTICLE_TEXTURE_SIZE, PARTICLE_TEXTURE_SIZE, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) return NULL;
+
+    float half = PARTICLE_TEXTURE_SIZE / 2.0f;
+    for (int y = 0; y < PARTICLE_TEXTURE_SIZE; y++) {
+        Uint8* row = (Uint8*)surface->pixels + y * surface->pitch;
+        for (int x = 0; x < PARTICLE_TEXTURE_SIZE; x++) {
+            float dx = (x + 0.5f - half) / half;
+            float dy = (y + 0.5f - half) / half;
+            float falloff = 1.0f - sqrtf(dx * dx + dy * dy);
+            if (falloff < 0) falloff = 0;
+
+            row[x * 4 + 0] = 255;
+            row[x * 4 + 1] = 255;
+            row[x * 4 + 2] = 255;
+            row[x * 4 + 3] = (Uint8)(falloff * falloff * 255);
+        }
+    }
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (texture) SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_ADD);
+    trackTexture(texture, TEXCAT_SPRITES);
+    return texture;
+}
+
+int initParticleSystem(ParticleSystem* ps, SDL_Renderer* renderer) {
+    memset(ps, 0, sizeof(*ps));
+
+    // One 16-byte aligned block (MEMTRACK_ALIGN), carved into the float arrays then the colors
+    size_t floats = (size_t)MAX_PARTICLES * sizeof(float);
+    size_t colors = (size_t)MAX_PARTICLES * sizeof(SDL_Color);
+    ps->block = memAlloc(floats * 8 + colors, MEM_PARTICLES);
+    if (!ps->block) {
+        printf("Warning: Failed to allocate particle pool\n");
+        return 0;
+    }
+    memset(ps->block, 0, floats * 8 + colors);
+
+    float* base = ps->block;
+    ps->x            = base + 0 * MAX_PARTICLES;
+    ps->y            = base + 1 * MAX_PARTICLES;
+    ps->vx           = base + 2 * MAX_PARTICLES;
+    ps->vy           = base + 3 * MAX_PARTICLES;
+    ps->life         = base + 4 * MAX_PARTICLES;
+    ps->inv_max_life = base + 5 * MAX_PARTICLES;
+    ps->alpha        = base + 6 * MAX_PARTICLES;
+    ps->size         = base + 7 * MAX_PARTICLES;
+    ps->color        = (SDL_Color*)(base + 8 * MAX_PARTICLES);
+
+    ps->vertices = memAlloc(PARTICLE_BATCH_SIZE * 4 * sizeof(SDL_Vertex), MEM_PARTICLES);
+    ps->indices = memAlloc(PARTICLE_BATCH_SIZE * 6 * sizeof(int), MEM_PARTICLES);
+    if (!ps->vertices || !ps->indices) {
+        printf("Warning: Failed to allocate particle batch buffers\n");
+        destroyParticleSystem(ps);
+        return 0;
+    }
+
+    // Two triangles per quad, same layout for every batch
+    for (int i = 0; i < PARTICLE_BATCH_SIZE; i++) {
+        int v = i * 4;
+        int* idx = &ps->indices[i * 6];
+        idx[0] = v;     idx[1] = v + 1; idx[2] = v + 2;
+        idx[3] = v + 2; idx[4] = v + 3; idx[5] = v;
+    }
+
+    ps->texture = createParticleTexture(renderer);
+    if (!ps->texture) printf("Warning: Failed to create particle texture\n");
+
+    ps->rng = 0x9E3779B9u;
+    return 1;
+}
+
+void destroyParticleSystem(ParticleSystem* ps) {
+    destroyTrackedTexture(ps->texture);
+    memFree(ps->block);
+    memFree(ps->vertices);
+    memFree(ps->indices);
+    memset(ps, 0, sizeof(*ps));
+}
+
+void clearParticles(ParticleSystem* ps) {
+    if (!ps->block) return;
+    memset(ps->life, 0, MAX_PARTICLES * sizeof(float));
+    memset(ps->alpha, 0, MAX_PARTICLES * sizeof(float));
+    ps->live = 0;
+    ps->replace = 0;
+}
+
+// out: [0, 1)
+float particleRandom(ParticleSystem* ps) {
+    Uint32 s = ps->rng;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    ps->rng = s;
+    return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+void spawnParticle(ParticleSystem* ps, float x, float y, float vx, float vy, float life, float size, SDL_Color color) {
+    if (!ps->block || life <= 0) return;
+
+    // Pool full: overwrite one, going round the pool
+    int i;
+    if (ps->live < MAX_PARTICLES) {
+        i = ps->live++;
+    } else {
+        i = ps->replace;
+        ps->replace = (ps->replace + 1) % MAX_PARTICLES;
+    }
+
+    ps->x[i] = x;
+    ps->y[i] = y;
+    ps->vx[i] = vx;
+    ps->vy[i] = vy;
+    ps->life[i] = life;
+    ps->inv_max_life[i] = 1.0f / life;
+    ps->alpha[i] = 1.0f;
+    ps->size[i] = size;
+    ps->color[i] = color;
+}
+
+void emitParticleBurst(ParticleSystem* ps, float x, float y, int count, float speed, float life, SDL_Color color) {
+    for (int i = 0; i < count; i++) {
+        float angle = particleRandom(ps) * 2 * M_PI;
+        float v = speed * (0.3f + 0.7f * particleRandom(ps));
+        spawnParticle(ps, x, y,
+                      cosf(angle) * v, sinf(angle) * v,
+                      life * (0.5f + 0.5f * particleRandom(ps)),
+                      2.0f + particleRandom(ps) * 4.0f,
+                      color);
+    }
+}
+
+// direction in radians (atan2 convention), spread is the half-angle of the cone
+void emitParticleCone(ParticleSystem* ps, float x, float y, float base_vx, float base_vy, float direction, float spread,
+                      float speed, int count, float life, float size, SDL_Color color) {
+    for (int i = 0; i < count; i++) {
+        float angle = direction + (particleRandom(ps) * 2 - 1) * spread;
+        float v = speed * (0.6f + 0.4f * particleRandom(ps));
+        spawnParticle(ps, x, y,
+                      base_vx + cosf(angle) * v, base_vy + sinf(angle) * v,
+                      life * (0.7f + 0.3f * particleRandom(ps)),
+                      size * (0.7f + 0.6f * particleRandom(ps)),
+                      color);
+    }
+}
+
+// Integrates slots [start, end), both multiples of 4
+static void updateRange(ParticleSystem* ps, int start, int end, float dt) {
+#ifdef __SSE__
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vdrag = _mm_set1_ps(PARTICLE_DRAG);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (int i = start; i < end; i += 4) {
+        __m128 vx = _mm_load_ps(&ps->vx[i]);
+        __m128 vy = _mm_load_ps(&ps->vy[i]);
+        _mm_store_ps(&ps->x[i], _mm_add_ps(_mm_load_ps(&ps->x[i]), _mm_mul_ps(vx, vdt)));
+        _mm_store_ps(&ps->y[i], _mm_add_ps(_mm_load_ps(&ps->y[i]), _mm_mul_ps(vy, vdt)));
+        _mm_store_ps(&ps->vx[i], _mm_mul_ps(vx, vdrag));
+        _mm_store_ps(&ps->vy[i], _mm_mul_ps(vy, vdrag));
+
+        __m128 life = _mm_sub_ps(_mm_load_ps(&ps->life[i]), vdt);
+        _mm_store_ps(&ps->life[i], life);
+
+        __m128 alpha = _mm_mul_ps(life, _mm_load_ps(&ps->inv_max_life[i]));
+        _mm_store_ps(&ps->alpha[i], _mm_min_ps(_mm_max_ps(alpha, zero), one));
+    }
+#else
+    for (int i = start; i < end; i++) {
+        ps->x[i] += ps->vx[i] * dt;
+        ps->y[i] += ps->vy[i] * dt;
+        ps->vx[i] *= PARTICLE_DRAG;
+        ps->vy[i] *= PARTICLE_DRAG;
+        ps->life[i] -= dt;
+
+        float alpha = ps->life[i] * ps->inv_max_life[i];
+        ps->alpha[i] = alpha < 0 ? 0 : alpha > 1 ? 1 : alpha;
+    }
+#endif
+}
+
+// Moves the last live particle into the dead slot i
+static void removeParticle(ParticleSystem* ps, int i) {
+    int last = --ps->live;
+    ps->x[i] = ps->x[last];
+    ps->y[i] = ps->y[last];
+    ps->vx[i] = ps->vx[last];
+    ps->vy[i] = ps->vy[last];
+    ps->life[i] = ps->life[last];
+    ps->inv_max_life[i] = ps->inv_max_life[last];
+    ps->alpha[i] = ps->alpha[last];
+    ps->size[i] = ps->size[last];
+    ps->color[i] = ps->color[last];
+    ps->life[last] = 0;
+    ps->alpha[last] = 0;
+}
+
+void updateParticles(ParticleSystem* ps, float dt) {
+    PROFILE_FUNCTION();
+    if (!ps->block || ps->live == 0) return;
+
+    // Round out to whole SIMD blocks; the slots past live are dead (life <= 0)
+    // so integrating them has no visible effect
+    updateRange(ps, 0, (ps->live + 3) & ~3, dt);
+
+    // Additive blending does not care about the order, swap the dead out
+    for (int i = 0; i < ps->live;) {
+        if (ps->life[i] <= 0) removeParticle(ps, i);
+        else i++;
+    }
+    if (ps->replace >= ps->live) ps->replace = 0;
+}
+
+void renderParticles(SDL_Renderer* renderer, ParticleSystem* ps, float camera_x, float camera_y, int screen_w, int screen_h) {
+    PROFILE_FUNCTION();
+    if (!ps->block || !ps->texture || ps->live == 0) return;
+
+    int batched = 0;
+
+    for (int i = 0; i < ps->live; i++) {
+        if (ps->alpha[i] <= 0) continue;
+
+        float half = ps->size[i] * 0.5f;
+        float sx = ps->x[i] - camera_x;
+        float sy = ps->y[i] - camera_y;
+
+        // Only render if visible on screen
+        if (sx + half < 0 || sx - half > screen_w || sy + half < 0 || sy - half > screen_h) continue;
+
+        SDL_Color c = ps->color[i];
+        c.a = (Uint8)(ps->alpha[i] * 255);
+
+        SDL_Vertex* v = &ps->vertices[batched * 4];
+        v[0] = (SDL_Vertex){ {sx - half, sy - half}, c, {0, 0} };
+        v[1] = (SDL_Vertex){ {sx + half, sy - half}, c, {1, 0} };
+        v[2] = (SDL_Vertex){ {sx + half, sy + half}, c, {1, 1} };
+        v[3] = (SDL_Vertex){ {sx - half, sy + half}, c, {0, 1} };
+
+        if (++batched == PARTICLE_BATCH_SIZE) {
+            SDL_RenderGeometry(renderer, ps->texture, ps->vertices, batched * 4, ps->indices, batched * 6);
+            batched = 0;
+        }
+    }
+
+    if (batched > 0) {
+        SDL_RenderGeometry(renderer, ps->texture, ps->vertices, batched * 4, ps->indices, batched * 6);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL2/SDL.h>
+#include "memtrack.h"
+
+/*
+            DEFINITIONS
+*/
+#define MAX_PARTICLES 131072      // Pool capacity, a multiple of 4 (SIMD blocks)
+#define PARTICLE_BATCH_SIZE 8192  // Particles per SDL_RenderGeometry call
+#define PARTICLE_DRAG 0.985f      // Velocity kept per update
+
+/*
+            PARTICLE STRUCTURES
+*/
+// Structure of arrays: every field lives in its own aligned array so the
+// update loop can process 4 particles per instruction. Live particles are
+// packed in [0, live): a dead one is replaced by the last, so neither the
+// update nor the render walk dead slots.
+typedef struct {
+    float* x;              // World position
+    float* y;
+    float* vx;             // Velocity (px per second)
+    float* vy;
+    float* life;           // Remaining lifetime (seconds), <= 0 means dead
+    float* inv_max_life;   // 1 / initial lifetime, used to derive alpha
+    float* alpha;          // Fade factor (0.0 - 1.0), recomputed on update
+    float* size;           // Quad size in px
+    SDL_Color* color;      // Base color (alpha channel unused)
+
+    int live;              // Slots [0, live) are alive
+    int replace;           // Pool full: the next slot a spawn overwrites
+
+    Uint32 rng;            // xorshift state for emitter jitter
+    void* block;           // Single allocation holding every array
+
+    SDL_Texture* texture;  // Soft round sprite shared by all particles
+    SDL_Vertex* vertices;  // Batch vertex buffer (4 per particle)
+    int* indices;          // Batch index buffer (6 per particle), built once
+} ParticleSystem;
+
+
+/*
+            DECLARATIONS
+*/
+int initParticleSystem(ParticleSystem* ps, SDL_Renderer* renderer);
+void destroyParticleSystem(ParticleSystem* ps);
+void clearParticles(ParticleSystem* ps);
+
+void spawnParticle(ParticleSystem* ps, float x, float y, float vx, float vy, float life, float size, SDL_Color color);
+void emitParticleBurst(ParticleSystem* ps, float x, float y, int count, float speed, float life, SDL_Color color);
+void emitParticleCone(ParticleSystem* ps, float x, float y, float base_vx, float base_vy, float direction, float spread,
+                      float speed, int count, float life, float size, SDL_Color color);
+float particleRandom(ParticleSystem* ps);
+
+void updateParticles(ParticleSystem* ps, float dt);
+void renderParticles(SDL_Renderer* renderer, ParticleSystem* ps, float camera_x, float camera_y, int screen_w, int screen_h);
+
+#endif
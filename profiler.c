@@ -0,0 +1,188 @@
+#include "profiler.h"
+#include "memtrack.h"
+#include <stdio.h>
+#include <string.h>
+
+int profilerRecording = 0;
+
+static struct {
+    SDL_SpinLock lock;               // Buffer table
+    ProfileBuffer* buffers[PROFILER_MAX_THREADS];
+    int num_buffers;
+    int dropped_threads;             // Table was full
+
+    SDL_atomic_t frame;              // Stamped on every event
+    Uint64 frame_start;
+    Uint64 origin;                   // Trace time 0
+    int trace_frames;
+    int always;                      // --profile: the whole run is recorded
+    int dump_at;                     // Frame a key-started capture ends at, 0 if none
+} profiler;
+
+static _Thread_local ProfileBuffer* localBuffer;
+static _Thread_local int localFailed;
+static _Thread_local const char* localName;
+
+// record: from the start (--profile), dumped again at exit.
+// Otherwise nothing is recorded until requestProfilerDump.
+void initProfiler(int record, int trace_frames) {
+    profiler.origin = SDL_GetPerformanceCounter();
+    profiler.trace_frames = trace_frames > 0 ? trace_frames : PROFILER_TRACE_FRAMES;
+    profiler.always = record;
+    profilerRecording = record;
+    if (record) printf("Profiler: recording, the last %d frames are written at exit\n", profiler.trace_frames);
+}
+
+// Call after every other thread has been joined
+void shutdownProfiler() {
+    if (profiler.always) dumpProfilerTrace(PROFILER_TRACE_PATH, profiler.trace_frames);
+    profilerRecording = 0;
+
+    for (int i = 0; i < profiler.num_buffers; i++) memFree(profiler.buffers[i]);
+    profiler.num_buffers = 0;
+    localBuffer = NULL;
+}
+
+// Shown in the trace, before the thread records its first zone
+void nameProfilerThread(const char* name) {
+    localName = name;
+    if (localBuffer) snprintf(localBuffer->name, PROFILER_NAME_LENGTH, "%s", name);
+}
+
+static ProfileBuffer* createBuffer() {
+    ProfileBuffer* buffer = memAlloc(sizeof(ProfileBuffer), MEM_GENERAL);
+    if (!buffer) return NULL;
+    SDL_AtomicSet(&buffer->write, 0);
+    buffer->thread = SDL_ThreadID();
+
+    SDL_AtomicLock(&profiler.lock);
+    int index = profiler.num_buffers;
+    if (index < PROFILER_MAX_THREADS) profiler.buffers[profiler.num_buffers++] = buffer;
+    else profiler.dropped_threads++;
+    SDL_AtomicUnlock(&profiler.lock);
+
+    if (index == PROFILER_MAX_THREADS) {
+        memFree(buffer);
+        return NULL;
+    }
+    if (localName) snprintf(buffer->name, PROFILER_NAME_LENGTH, "%s", localName);
+    else snprintf(buffer->name, PROFILER_NAME_LENGTH, "thread %d", index + 1);
+    return buffer;
+}
+
+// Through profileEnd. The ring overwrites the oldest zones.
+void recordProfileZone(const char* name, Uint64 start, Uint64 end) {
+    ProfileBuffer* buffer = localBuffer;
+    if (!buffer) {
+        if (localFailed) return;
+        buffer = localBuffer = createBuffer();
+        if (!buffer) {
+            localFailed = 1;
+            return;
+        }
+    }
+
+    Uint32 write = (Uint32)SDL_AtomicGet(&buffer->write);
+    buffer->events[write & (PROFILER_EVENTS - 1)] = (ProfileEvent){
+        .name = name,
+        .start = start,
+        .end = end,
+        .frame = (Uint32)SDL_AtomicGet(&profiler.frame)
+    };
+    SDL_AtomicSet(&buffer->write, (int)(write + 1));
+}
+
+// Main thread, once per frame after the present. Also finishes a capture
+// started by requestProfilerDump.
+void profileFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (profilerRecording && profiler.frame_start) recordProfileZone("frame", profiler.frame_start, now);
+    profiler.frame_start = now;
+    int frame = SDL_AtomicAdd(&profiler.frame, 1) + 1;
+
+    if (profiler.dump_at && frame >= profiler.dump_at) {
+        dumpProfilerTrace(PROFILER_TRACE_PATH, profiler.trace_frames);
+        profiler.dump_at = 0;
+        if (!profiler.always) profilerRecording = 0;
+    }
+}
+
+// The profile key: writes what was recorded, or records the next frames
+// first when the profiler was off
+void requestProfilerDump() {
+    if (profiler.always) {
+        dumpProfilerTrace(PROFILER_TRACE_PATH, profiler.trace_frames);
+    } else if (!profiler.dump_at) {
+        profilerRecording = 1;
+        profiler.dump_at = SDL_AtomicGet(&profiler.frame) + profiler.trace_frames;
+        printf("Profiler: recording %d frames\n", profiler.trace_frames);
+    }
+}
+
+static double traceMicroseconds(Uint64 counter) {
+    return (double)(counter - profiler.origin) * 1000000.0 / SDL_GetPerformanceFrequency();
+}
+
+// Copies the events of the last frames out of a ring that may still be written
+static int copyRecentEvents(ProfileBuffer* buffer, ProfileEvent* out, Uint32 first_frame) {
+    Uint32 write = (Uint32)SDL_AtomicGet(&buffer->write);
+    Uint32 oldest = write > PROFILER_EVENTS ? write - PROFILER_EVENTS : 0;
+
+    int count = 0;
+    for (Uint32 i = oldest; i != write; i++) out[count++] = buffer->events[i & (PROFILER_EVENTS - 1)];
+
+    // Whatever the thread wrote meanwhile replaced the start of the copy
+    Uint32 lapped = (Uint32)SDL_AtomicGet(&buffer->write) - write;
+    int kept = 0;
+    for (int i = (int)SDL_min(lapped, (Uint32)count); i < count; i++) {
+        if ((Sint32)(out[i].frame - first_frame) >= 0) out[kept++] = out[i];
+    }
+    return kept;
+}
+
+// Chrome trace of the last frames, one track per thread
+void dumpProfilerTrace(const char* path, int frames) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Warning: Could not write %s\n", path);
+        return;
+    }
+
+    ProfileEvent* events = memAlloc(sizeof(ProfileEvent) * PROFILER_EVENTS, MEM_GENERAL);
+    if (!events) {
+        fclose(file);
+        return;
+    }
+
+    Uint32 frame = (Uint32)SDL_AtomicGet(&profiler.frame);
+    Uint32 first_frame = frame > (Uint32)frames ? frame - frames : 0;
+
+    SDL_AtomicLock(&profiler.lock);
+    int num_buffers = profiler.num_buffers;
+    SDL_AtomicUnlock(&profiler.lock);
+
+    int total = 0;
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"game\"}}");
+    for (int b = 0; b < num_buffers; b++) {
+        ProfileBuffer* buffer = profiler.buffers[b];
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", b + 1, buffer->name);
+
+        int count = copyRecentEvents(buffer, events, first_frame);
+        for (int i = 0; i < count; i++) {
+            ProfileEvent* event = &events[i];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+                    event->name, traceMicroseconds(event->start),
+                    traceMicroseconds(event->end) - traceMicroseconds(event->start), b + 1);
+            if (strcmp(event->name, "frame") == 0) fprintf(file, ",\"args\":{\"frame\":%u}", event->frame);
+            fprintf(file, "}");
+        }
+        total += count;
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    memFree(events);
+
+    printf("Profiler: %d zones from %u frames written to %s\n", total, frame - first_frame, path);
+    if (profiler.dropped_threads > 0) printf("Profiler: %d threads not recorded, raise PROFILER_MAX_THREADS\n", profiler.dropped_threads);
+}
@@ -0,0 +1,71 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL2/SDL.h>
+
+/*
+            DEFINITIONS
+*/
+#define PROFILER_EVENTS 65536        // Zones kept per thread, power of two
+#define PROFILER_MAX_THREADS 16
+#define PROFILER_NAME_LENGTH 32
+#define PROFILER_TRACE_FRAMES 300    // Dumped by the profile key, --profile=N to change
+#define PROFILER_TRACE_PATH "frame_trace.json"  // Open in chrome://tracing or ui.perfetto.dev
+
+/*
+            PROFILER STRUCTURES
+*/
+typedef struct {
+    const char* name;                // String literal or __func__, not copied
+    Uint64 start;                    // 0 when the profiler was not recording
+} ProfileZone;
+
+typedef struct {
+    const char* name;
+    Uint64 start, end;               // Performance counter
+    Uint32 frame;
+} ProfileEvent;
+
+// One per thread that recorded a zone, written by that thread only. The
+// write counter is published after the event so a dump from another thread
+// reads complete events (and drops the ones lapped while it was reading).
+typedef struct {
+    ProfileEvent events[PROFILER_EVENTS];
+    SDL_atomic_t write;
+    SDL_threadID thread;
+    char name[PROFILER_NAME_LENGTH];
+} ProfileBuffer;
+
+// Read by every zone: a plain load and a branch while the profiler is off
+extern int profilerRecording;
+
+// Zones: PROFILE_BEGIN/PROFILE_END open and close a block, PROFILE_FUNCTION
+// lasts until the enclosing function or block returns
+#define PROFILE_BEGIN(name) { ProfileZone profile_zone_ = profileBegin(name);
+#define PROFILE_END() profileEnd(&profile_zone_); }
+#define PROFILE_FUNCTION() ProfileZone profile_function_ __attribute__((cleanup(profileEnd))) = profileBegin(__func__)
+
+
+/*
+            DECLARATIONS
+*/
+void recordProfileZone(const char* name, Uint64 start, Uint64 end);
+
+static inline ProfileZone profileBegin(const char* name) {
+    ProfileZone zone = { name, 0 };
+    if (profilerRecording) zone.start = SDL_GetPerformanceCounter();
+    return zone;
+}
+
+static inline void profileEnd(ProfileZone* zone) {
+    if (zone->start) recordProfileZone(zone->name, zone->start, SDL_GetPerformanceCounter());
+}
+
+void initProfiler(int record, int trace_frames);
+void shutdownProfiler();
+void nameProfilerThread(const char* name);
+void profileFrame();
+void requestProfilerDump();
+void dumpProfilerTrace(const char* path, int frames);
+
+#endif
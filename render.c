@@ -3,13 +3,19 @@
 #include "init.h"   // Needs resources and UI elements
 #include "menu.h"        // Needs menu rendering functions
 #include "sounds.h"
+#include "profiler.h"
+#include "netgame.h"     // Other players
+#define DRAWSTATS_COUNT
+#include "drawstats.h"
 #include <stdio.h>
 
 void renderMainMenu(SDL_Renderer* renderer, GameResources* resources, UIElements* ui) {
+    PROFILE_FUNCTION();
     // Render background
-    if (resources->menuBackground) {
+    SDL_Texture* background = getTexture(&resources->textures, resources->menuBackground);
+    if (background) {
         SDL_Rect bgRect = {0, 0, resources->windowWidth, resources->windowHeight};
-        SDL_RenderCopy(renderer, resources->menuBackground, NULL, &bgRect);
+        SDL_RenderCopy(renderer, background, NULL, &bgRect);
     }
 
     // Semi-transparent overlay
@@ -31,18 +37,18 @@ void renderMainMenu(SDL_Renderer* renderer, GameResources* resources, UIElements
         SDL_RenderFillRect(renderer, &particle);
     }
 
-    // Render title (top center)
-    renderText(renderer, resources->titleFont, "Fight game", ui->yellow, &ui->titleRect, 1, 1);
-
-    renderMenuList(renderer, resources, ui->menuButtons, ui->nbMenuButtons);
+    // Title and buttons
+    renderMenuLayer(renderer, resources, ui, MAIN_MENU);
 
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
 }
 
 void renderOptionsScreen(SDL_Renderer* renderer, Game* game, GameResources* resources, UIElements* ui) {
-    if (resources->optionsBackground) {
+    PROFILE_FUNCTION();
+    SDL_Texture* background = getTexture(&resources->textures, resources->optionsBackground);
+    if (background) {
         SDL_Rect bgRect = {0, 0, resources->windowWidth, resources->windowHeight};
-        SDL_RenderCopy(renderer, resources->optionsBackground, NULL, &bgRect);
+        SDL_RenderCopy(renderer, background, NULL, &bgRect);
     }
 
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
@@ -67,49 +73,116 @@ void renderOptionsScreen(SDL_Renderer* renderer, Game* game, GameResources* reso
         SDL_RenderFillRect(renderer, &particle);
     }
 
-    // Render title
-    renderText(renderer, resources->titleFont, "Options", ui->yellow, &ui->titleRect, 1, 1);
+    // Title, sliders and checkbox
+    renderMenuLayer(renderer, resources, ui, OPTIONS);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+}
+
+void renderLoadingScreen(SDL_Renderer* renderer, GameResources* resources, float progress, const char* current) {
+    PROFILE_FUNCTION();
+    SDL_Color yellow = {255, 230, 0, 0};
+    SDL_Color white = {255, 255, 255, 0};
+    int w = resources->windowWidth;
+    int h = resources->windowHeight;
+
+    SDL_SetRenderDrawColor(renderer, 26, 28, 58, 255);
+    SDL_RenderClear(renderer);
+
+    renderText(renderer, resources->titleFont, "Fight game", yellow, &(SDL_Rect){(w - 400) / 2, h / 2 - 160, 400, 60}, 1, 1);
+
+    // Spinner: 12 dots, the brightest one turns every 80 ms
+    Uint32 frameTime = SDL_GetTicks();
+    int lead = (frameTime / 80) % 12;
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    for (int i = 0; i < 12; i++) {
+        float angle = i * 2 * M_PI / 12;
+        int x = w / 2 + cos(angle) * 30;
+        int y = h / 2 - 50 + sin(angle) * 30;
+        int fade = (i - lead + 12) % 12;
+        SDL_SetRenderDrawColor(renderer, 255, 230, 0, 255 - fade * 20);
+        SDL_RenderFillRect(renderer, &(SDL_Rect){x - 3, y - 3, 6, 6});
+    }
+
+    // Progress bar
+    int barWidth = w / 3;
+    SDL_Rect bar = {(w - barWidth) / 2, h / 2 + 20, barWidth, 20};
+    SDL_SetRenderDrawColor(renderer, 80, 80, 80, 255);
+    SDL_RenderFillRect(renderer, &bar);
+    SDL_SetRenderDrawColor(renderer, 39 + 100, 44 + 100, 92 + 160, 255);
+    SDL_RenderFillRect(renderer, &(SDL_Rect){bar.x, bar.y, (int)(barWidth * progress), bar.h});
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 
-    renderMenuList(renderer, resources, ui->optionsButtons, ui->nbOptionsButtons);
+    char progressText[16];
+    sprintf(progressText, "%.0f%%", progress * 100);
+    renderText(renderer, resources->uiFont, progressText, white, &(SDL_Rect){bar.x, bar.y + 30, barWidth, 30}, 1, 0);
+    renderText(renderer, resources->uiFont, current, white, &(SDL_Rect){bar.x - barWidth / 2, bar.y + 60, barWidth * 2, 30}, 1, 0);
 
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderPresent(renderer);
 }
 
 void renderGameplay(SDL_Renderer* renderer, Game* game, Fighter* fighter, GameResources* resources, UIElements* ui, BackgroundEffects* bg_effects) {
+    PROFILE_FUNCTION();
+    // Passes other than the sprites set their own
+    DRAW_PASS(DRAW_PASS_SPRITES);
+
     // Sprites
     // Render starfield first (far background)
     renderStarfield(renderer, bg_effects, resources);
     renderOrbitalTrails(renderer, bg_effects, resources);
-    renderAstralObjects(renderer, bg_effects, resources);
+    renderAstralObjects(renderer, bg_effects, game->player.discovered, resources);
     renderSolarSystem(renderer, bg_effects, resources);
+
+    // Exhaust and discovery particles (additive, batched)
+    renderParticles(renderer, &bg_effects->particles, resources->bg_x, resources->bg_y, resources->windowWidth, resources->windowHeight);
     
+    // Other players, online
+    renderRemotePlayers(renderer, game->net, fighter, resources);
+
     // Render thruster
-    renderThruster(renderer, fighter, resources);
+    renderThruster(renderer, fighter, game->player.angle, resources);
 
     // Fighter rotation - FIXED center calculation
     SDL_Point center = {fighter->rect.w / 2, fighter->rect.h / 2};
-    SDL_RenderCopyEx(renderer, resources->fighterTexture, NULL, &fighter->rect, fighter->angle, &center, SDL_FLIP_NONE);
+    SDL_Texture* fighterTexture = getTexture(&resources->textures, resources->fighterTexture);
+    if (fighterTexture) SDL_RenderCopyEx(renderer, fighterTexture, NULL, &fighter->rect, game->player.angle, &center, SDL_FLIP_NONE);
 
     // Render bullets
-    for (int i = 0; i < game->numBullets; i++) {
-        SDL_RenderCopy(renderer, resources->bulletTexture, NULL, &game->bullets[i]);
+    SDL_Texture* bulletTexture = game->numBullets ? getTexture(&resources->textures, resources->bulletTexture) : NULL;
+    for (int i = 0; i < game->numBullets && bulletTexture; i++) {
+        SDL_RenderCopy(renderer, bulletTexture, NULL, &game->bullets[i]);
     }
 
     // UI
+    setDrawPass(DRAW_PASS_HUD);
     // Render score
     char scoreText[20];
-    sprintf(scoreText, "Score: %d", game->score);
+    sprintf(scoreText, "Score: %d", game->player.score);
     renderDiscoveryProgress(renderer, game, resources, ui);
     renderText(renderer, resources->font, scoreText, ui->yellow, &ui->scoreRect, 0, 0);
     
     // Pause
-    SDL_RenderCopy(renderer, resources->isHoveringPause?resources->pauseTexture:resources->pauseTexture2, NULL, &ui->pauseButtonRect);
+    SDL_RenderCopy(renderer, getTexture(&resources->textures, resources->isHoveringPause?resources->pauseTexture:resources->pauseTexture2), NULL, &ui->pauseButtonRect);
 }
 
 void renderGameScreen(SDL_Renderer* renderer, Game* game, Fighter* fighter, GameResources* resources, UIElements* ui, BackgroundEffects* bg_effects) {
+    PROFILE_FUNCTION();
+    resetDrawStats();
+    Uint64 start = SDL_GetPerformanceCounter();
+
     // Clear screen
     SDL_RenderClear(renderer);
 
+    // A menu holds its background while it is shown
+    TextureHandle background = game->screen == MAIN_MENU ? resources->menuBackground :
+                               game->screen == OPTIONS ? resources->optionsBackground : 0;
+    if (ui->background != background) {
+        releaseTexture(&resources->textures, ui->background);
+        acquireTexture(&resources->textures, background);
+        ui->background = background;
+    }
+
     switch (game->screen) {
         case MAIN_MENU:
             renderMainMenu(renderer, resources, ui);
@@ -121,32 +194,69 @@ void renderGameScreen(SDL_Renderer* renderer, Game* game, Fighter* fighter, Game
             renderGameplay(renderer, game, fighter, resources, ui, bg_effects);
             break;
     }
+    drawStats.render_ms = (SDL_GetPerformanceCounter() - start) * 1000.0f / SDL_GetPerformanceFrequency();
 
-    // Update screen
+    // Not counted in the render time, it shows its own
+    if (game->screen == GAME) renderPerfOverlay(renderer, &ui->overlay, resources->uiFont);
+
+    // Update screen, waits for the display with vsync
+    PROFILE_BEGIN("SDL_RenderPresent");
     SDL_RenderPresent(renderer);
+    PROFILE_END();
 }
 
-void renderThruster(SDL_Renderer* renderer, Fighter* fighter, GameResources* resources) {
+void renderThruster(SDL_Renderer* renderer, Fighter* fighter, float angle, GameResources* resources) {
+    PROFILE_FUNCTION();
     if (!fighter->thruster.is_visible) return;
     
     // Get current thruster texture from resources
     int frame = fighter->thruster.current_frame;
-    SDL_Texture* thrusterTexture = resources->thrusterTextures[frame];
-    if (!thrusterTexture) return;
+    SDL_Texture* thrusterTexture = getTexture(&resources->textures, resources->thrusterTextures[frame]);
+    SDL_Point size;
+    if (!thrusterTexture || !getTextureSize(&resources->textures, resources->thrusterTextures[frame], &size.x, &size.y)) return;
     
     // Render left thruster
-    renderSingleThruster(renderer, thrusterTexture, fighter, fighter->thruster.left_offset);
+    renderSingleThruster(renderer, thrusterTexture, size, fighter, angle, fighter->thruster.left_offset);
     
     // Render right thruster
-    renderSingleThruster(renderer, thrusterTexture, fighter, fighter->thruster.right_offset);
+    renderSingleThruster(renderer, thrusterTexture, size, fighter, angle, fighter->thruster.right_offset);
+}
+
+// Where the last snapshot had them, moved along their speed since. Tinted
+// so the own fighter stands out.
+void renderRemotePlayers(SDL_Renderer* renderer, const NetClient* net, const Fighter* fighter, GameResources* resources) {
+    PROFILE_FUNCTION();
+    if (!net || net->state != NET_CONNECTED) return;
+    SDL_Texture* texture = getTexture(&resources->textures, resources->fighterTexture);
+    if (!texture) return;
+
+    SDL_Point center = {FIGHTER_WIDTH / 2, FIGHTER_HEIGHT / 2};
+    SDL_SetTextureColorMod(texture, 150, 200, 255);
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        const NetRemotePlayer* remote = &net->remotes[i];
+        if (!remote->present) continue;
+
+        int x = remote->x + remote->speed_x * remote->age - resources->bg_x;
+        int y = remote->y + remote->speed_y * remote->age - resources->bg_y;
+        if (x < -FIGHTER_HEIGHT || y < -FIGHTER_HEIGHT ||
+            x > resources->windowWidth + FIGHTER_HEIGHT || y > resources->windowHeight + FIGHTER_HEIGHT) continue;
+
+        // Same thrusters as the own fighter, at its place
+        Fighter other = *fighter;
+        other.rect = (SDL_Rect){ x - FIGHTER_WIDTH / 2, y - FIGHTER_HEIGHT / 2, FIGHTER_WIDTH, FIGHTER_HEIGHT };
+        other.thruster.is_visible = remote->thrusting;
+        renderThruster(renderer, &other, remote->angle, resources);
+        SDL_RenderCopyEx(renderer, texture, NULL, &other.rect, remote->angle, &center, SDL_FLIP_NONE);
+    }
+    SDL_SetTextureColorMod(texture, 255, 255, 255);
 }
 
-void renderSingleThruster(SDL_Renderer* renderer, SDL_Texture* texture, Fighter* fighter, SDL_Point offset) {
+void renderSingleThruster(SDL_Renderer* renderer, SDL_Texture* texture, SDL_Point size, Fighter* fighter, float angle, SDL_Point offset) {
+    PROFILE_FUNCTION();
     if (!texture) return;
     
-    // Get original thruster texture dimensions
-    int original_w, original_h;
-    SDL_QueryTexture(texture, NULL, NULL, &original_w, &original_h);
+    // Original thruster texture dimensions
+    int original_w = size.x, original_h = size.y;
     
     // Apply scaling factor (e.g., 2.0x for twice as big)
     float scale_factor = 0.8f;
@@ -160,7 +270,7 @@ void renderSingleThruster(SDL_Renderer* renderer, SDL_Texture* texture, Fighter*
     };
     
     // Calculate thruster position based on offset and ship rotation
-    float rad_angle = fighter->angle * M_PI / 180.0f;
+    float rad_angle = angle * M_PI / 180.0f;
     
     // Rotate the offset by the ship's angle
     int rotated_x = offset.x * cos(rad_angle) - offset.y * sin(rad_angle);
@@ -181,13 +291,15 @@ void renderSingleThruster(SDL_Renderer* renderer, SDL_Texture* texture, Fighter*
     };
     
     // Thruster should point opposite to ship direction (180° difference)
-    float thruster_angle = fighter->angle + 90.0f;
+    float thruster_angle = angle + 90.0f;
     
     SDL_RenderCopyEx(renderer, texture, NULL, &dest_rect, 
                     thruster_angle, NULL, SDL_FLIP_NONE);
 }
 
 void renderOrbitalTrails(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources) {
+    PROFILE_FUNCTION();
+    DRAW_PASS(DRAW_PASS_TRAILS);
     for (int i = 1; i < NUM_PLANETS; i++) {  // Skip sun
         Planet* planet = &bg_effects->planets[i];
         
@@ -209,19 +321,20 @@ void renderOrbitalTrails(SDL_Renderer* renderer, BackgroundEffects* bg_effects,
 }
 
 void renderSolarSystem(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources) {
+    PROFILE_FUNCTION();
+    DRAW_PASS(DRAW_PASS_SOLAR_SYSTEM);
     for (int i = 0; i < NUM_PLANETS; i++) {
         Planet* planet = &bg_effects->planets[i];
-        SDL_Texture* planetTexture = resources->planetTextures[planet->texture_index];
+        TextureHandle planetHandle = resources->planetTextures[planet->texture_index];
         
-        if (!planetTexture) continue;
-        
-        // Get texture dimensions
-        int original_w, original_h;
-        SDL_QueryTexture(planetTexture, NULL, NULL, &original_w, &original_h);
-        
-        // Apply scaling
+        // Apply scaling (the height follows the texture aspect ratio once it is
+        // loaded, square until then)
         int planet_width = planet->width /10;
-        int planet_height = planet->width * original_h / original_w /10;
+        int planet_height = planet_width;
+        int original_w, original_h;
+        if (getTextureSize(&resources->textures, planetHandle, &original_w, &original_h)) {
+            planet_height = planet->width * original_h / original_w /10;
+        }
         
         // Calculate world position
         float world_x, world_y;
@@ -240,10 +353,14 @@ void renderSolarSystem(SDL_Renderer* renderer, BackgroundEffects* bg_effects, Ga
         int screen_x = world_x - resources->bg_x;
         int screen_y = world_y - resources->bg_y;
         
-        // Only render if visible on screen
+        // Only render (and load) if visible on screen
         if (screen_x + planet_width > -2000 && screen_x < resources->windowWidth + 2000 &&
             screen_y + planet_height > -2000 && screen_y < resources->windowHeight + 2000) {
             
+            // Not resident yet: skipped until the loader brings it in
+            SDL_Texture* planetTexture = getTexture(&resources->textures, planetHandle);
+            if (!planetTexture) continue;
+            
             SDL_Rect dest_rect = {
                 screen_x - planet_width / 2,
                 screen_y - planet_height / 2,
@@ -266,15 +383,27 @@ void renderSolarSystem(SDL_Renderer* renderer, BackgroundEffects* bg_effects, Ga
 }
 
 void renderStarfield(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources) {
+    PROFILE_FUNCTION();
+    DRAW_PASS(DRAW_PASS_STARFIELD);
+    // Look the star textures up once per frame rather than once per star
+    SDL_Texture* starTextures[STAR_TEXTURES] = {0};
+    SDL_Point starSizes[STAR_TEXTURES];
+    for (int i = 0; i < resources->num_star_textures; i++) {
+        starTextures[i] = getTexture(&resources->textures, resources->starTextures[i]);
+        if (!getTextureSize(&resources->textures, resources->starTextures[i], &starSizes[i].x, &starSizes[i].y)) {
+            starTextures[i] = NULL;
+        }
+    }
+
     for (int i = 0; i < bg_effects->num_stars; i++) {
         Star* star = &bg_effects->stars[i];
-        SDL_Texture* starTexture = resources->starTextures[star->texture_index];
+        SDL_Texture* starTexture = starTextures[star->texture_index];
         
         if (!starTexture) continue;
         
-        // Get original texture dimensions
-        int original_w, original_h;
-        SDL_QueryTexture(starTexture, NULL, NULL, &original_w, &original_h);
+        // Original texture dimensions
+        int original_w = starSizes[star->texture_index].x;
+        int original_h = starSizes[star->texture_index].y;
         
         // Apply scaling
         float base_scale_factor = 0.1f;
@@ -307,20 +436,24 @@ void renderStarfield(SDL_Renderer* renderer, BackgroundEffects* bg_effects, Game
             
             // Reset alpha for other textures
             SDL_SetTextureAlphaMod(starTexture, 255);
+            drawStats.stars_drawn++;
         }
     }
+    drawStats.stars_total = bg_effects->num_stars;
 }
 
-void renderAstralObjects(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources) {
-    for (int i = 0; i < TOTAL_ASTRAL_OBJECTS; i++) {
+void renderAstralObjects(SDL_Renderer* renderer, BackgroundEffects* bg_effects, const Uint8* discovered, GameResources* resources) {
+    PROFILE_FUNCTION();
+    DRAW_PASS(DRAW_PASS_ASTRAL);
+    for (int i = 0; i < bg_effects->num_astral_objects; i++) {
         AstralObject* obj = &bg_effects->astral_objects[i];
-        SDL_Texture* texture = resources->astralTextures[obj->texture_index];
+        SDL_Texture* texture = getTexture(&resources->textures, resources->astralTextures[obj->texture_index]);
         
-        //if (!texture) continue;
+        if (!texture) continue;
         
         // Get texture dimensions if not already stored
         if (obj->w == 0 || obj->h == 0) {
-            SDL_QueryTexture(texture, NULL, NULL, &obj->w, &obj->h);
+            getTextureSize(&resources->textures, resources->astralTextures[obj->texture_index], &obj->w, &obj->h);
         }
         
         // Apply scaling
@@ -340,8 +473,9 @@ void renderAstralObjects(SDL_Renderer* renderer, BackgroundEffects* bg_effects,
                 SDL_Rect dest_rect = {screen_x, screen_y, scaled_w, scaled_h};
                 SDL_RenderCopyEx(renderer, texture, NULL, &dest_rect, 
                                 obj->rotation, NULL, SDL_FLIP_NONE);
+                drawStats.objects_drawn++;
             
-            if (obj->discovered) {
+            if (discovered[i]) {
                 // Render discovered objects normally
                 SDL_Rect dest_rect = {screen_x, screen_y, scaled_w, scaled_h};
                 SDL_RenderCopyEx(renderer, texture, NULL, &dest_rect, 
@@ -374,26 +508,29 @@ void renderAstralObjects(SDL_Renderer* renderer, BackgroundEffects* bg_effects,
             }
         }
     }
+    drawStats.objects_total = bg_effects->num_astral_objects;
 }
 
 void renderDiscoveryProgress(SDL_Renderer* renderer, Game* game, GameResources* resources, UIElements* ui) {
+    PROFILE_FUNCTION();
+    DRAW_PASS(DRAW_PASS_HUD);
     char discovery_text[100];
     int shift;
 
     const int type_scores[4] = {CLOUD_SCORE, NEBULA_SCORE, NOVA_SCORE, VORTEX_SCORE};
     
     // Display total discovery progress
-    sprintf(discovery_text, "Points objectifs :  %d", game->discovery.total_score_earned);
+    sprintf(discovery_text, "Points objectifs :  %d", game->player.discovery.total_score_earned);
     renderText(renderer, resources->uiFont, discovery_text, ui->white, &(SDL_Rect) {0, 60, 240, 30}, 0, 0);
 
     sprintf(discovery_text, "Decouvertes :");
     renderText(renderer, resources->uiFont, discovery_text, ui->white, &(SDL_Rect) {0, 85, 240, 30}, 0, 0);
 
-    sprintf(discovery_text, "%d", game->discovery.total_discovered);
-    shift = floorf(game->discovery.total_discovered/MENU_MARGIN_RIGHT)==1 ? -13 : 0;
+    sprintf(discovery_text, "%d", game->player.discovery.total_discovered);
+    shift = floorf(game->player.discovery.total_discovered/MENU_MARGIN_RIGHT)==1 ? -13 : 0;
     renderText(renderer, resources->uiFont, discovery_text, ui->white, &(SDL_Rect) {165 + shift, 85, 240, 30}, 0, 0);
 
-    sprintf(discovery_text, "/%d", TOTAL_ASTRAL_OBJECTS);
+    sprintf(discovery_text, "/%d", game->player.discovery.total_objects);
     renderText(renderer, resources->uiFont, discovery_text, ui->white, &(SDL_Rect) {185, 85, 240, 30}, 0, 0);
     
     // Display progress for each type
@@ -402,14 +539,14 @@ void renderDiscoveryProgress(SDL_Renderer* renderer, Game* game, GameResources*
         sprintf(discovery_text, "%s:", type_names[i]);
         renderText(renderer, resources->uiFont, discovery_text, ui->white, &(SDL_Rect) {0, 150 + i * 30, 200, 30}, 0, 0);
 
-        if (game->discovery.discovered_count[i] < game->discovery.total_count[i]) {
-            sprintf(discovery_text, "%d", game->discovery.discovered_count[i]);
+        if (game->player.discovery.discovered_count[i] < game->player.discovery.total_count[i]) {
+            sprintf(discovery_text, "%d", game->player.discovery.discovered_count[i]);
             renderText(renderer, resources->uiFont, discovery_text, ui->white, &(SDL_Rect) {165, 150 + i * 30, 20, 30}, 0, 0);
 
-            sprintf(discovery_text, "/%d", game->discovery.total_count[i]);
+            sprintf(discovery_text, "/%d", game->player.discovery.total_count[i]);
             renderText(renderer, resources->uiFont, discovery_text, ui->white, &(SDL_Rect) {185, 150 + i * 30, 40, 30}, 0, 0);
         } else {
-            SDL_RenderCopy(renderer, resources->checkmarkTexture, NULL, &(SDL_Rect) {175, 150 + i * 30, 30, 20});
+            SDL_RenderCopy(renderer, getTexture(&resources->textures, resources->checkmarkTexture), NULL, &(SDL_Rect) {175, 150 + i * 30, 30, 20});
         }
 
         sprintf(discovery_text, "(%d)", type_scores[i]);
@@ -433,6 +570,7 @@ void drawCircle(SDL_Renderer* renderer, int center_x, int center_y, int radius,
 }
 
 void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color, SDL_Rect* dstRect, int centerHorizontally, int centerVertically) {
+    PROFILE_FUNCTION();
     SDL_Surface* textSurface = TTF_RenderText_Solid(font, text, color);
     if (!textSurface) return;
     
@@ -441,6 +579,7 @@ void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Co
         SDL_FreeSurface(textSurface);
         return;
     }
+    trackTexture(textTexture, TEXCAT_TEXT);
     
     // Create a new destination rect with proper aspect ratio
     SDL_Rect renderRect = {
@@ -466,55 +605,45 @@ void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Co
     }
     
     SDL_RenderCopy(renderer, textTexture, NULL, &renderRect);
-    SDL_DestroyTexture(textTexture);
+    destroyTrackedTexture(textTexture);
     SDL_FreeSurface(textSurface);
 }
 
 void renderMenuList(SDL_Renderer* renderer, GameResources* resources, MenuListItem* menuList, int listSize) {
-    int lineHeight = 80;
-    int currentYPosition = resources->windowHeight - lineHeight - MENU_MARGIN_RIGHT;
-    Button b;
-    Checkbox c;
-    Slider s;
-    int x, y;
-    
+    PROFILE_FUNCTION();
     for (int i=listSize-1; i>=0; i--) {
-        MenuListItem item = menuList[i];
-        SDL_Color color = item.isHovering ? item.hoverColor : item.textColor;
+        MenuListItem* item = &menuList[i];
+        SDL_Color color = item->isHovering ? item->hoverColor : item->textColor;
 
-        switch (item.type) {
+        switch (item->type) {
             case TYPE_BUTTON:
-                b = item.button;
-                // SDL_SetRenderDrawColor(renderer, b.fillColor.r, b.fillColor.g, b.fillColor.b, 255);
-                // SDL_RenderFillRect(renderer, &(SDL_Rect) {MENU_MARGIN_RIGHT, currentYPosition, item.w, item.h});
-                SDL_RenderCopy(renderer, resources->menuBgTexture, NULL, &(SDL_Rect){MENU_MARGIN_RIGHT, currentYPosition, item.w, item.h});
-                renderText(renderer, resources->font, item.text, color, &(SDL_Rect) {MENU_MARGIN_RIGHT+5, currentYPosition+5, item.w-5, item.h-5}, 1, 1);
+                SDL_RenderCopy(renderer, getTexture(&resources->textures, resources->menuBgTexture), NULL, &item->control);
+                renderText(renderer, resources->font, item->text, color, &item->label, 1, 1);
                 break;
             
-            case TYPE_CHECKBOX:
-                printf("%d\n", item.isHovering);
-                c = item.checkbox;
-                SDL_Texture* check = c.isChecked ?
-                        (item.isHovering ? resources->checkboxCheckedTexture : resources->checkboxCheckedTexture2) :
-                        (item.isHovering ? resources->checkboxUncheckedTexture : resources->checkboxUncheckedTexture2);
-                SDL_RenderCopy(renderer, check, NULL, &(SDL_Rect){MENU_MARGIN_RIGHT+300, currentYPosition, min(item.h, c.boxSize), min(item.h, c.boxSize)});
-                renderText(renderer, resources->font, item.text, color, &(SDL_Rect) {MENU_MARGIN_RIGHT, currentYPosition+5, item.w-c.boxSize-5, item.h-5}, 0, 1);
+            case TYPE_CHECKBOX: {
+                Checkbox c = item->checkbox;
+                TextureHandle check = c.isChecked ?
+                        (item->isHovering ? resources->checkboxCheckedTexture : resources->checkboxCheckedTexture2) :
+                        (item->isHovering ? resources->checkboxUncheckedTexture : resources->checkboxUncheckedTexture2);
+                SDL_RenderCopy(renderer, getTexture(&resources->textures, check), NULL, &item->control);
+                renderText(renderer, resources->font, item->text, color, &item->label, 0, 1);
                 break;
+            }
             
-            case TYPE_SLIDER:
-                x = MENU_MARGIN_RIGHT;
-                y = currentYPosition;
-                s = item.slider;
+            case TYPE_SLIDER: {
+                Slider s = item->slider;
+                SDL_Rect track = item->control;
 
                 // Render slider labels
-                renderText(renderer, resources->font, item.text, color, &(SDL_Rect){x, y, MENU_OFFSET, item.h}, 0, 1);
+                renderText(renderer, resources->font, item->text, color, &item->label, 0, 1);
 
                 // Music slider
                 SDL_SetRenderDrawColor(renderer, 80, 80, 80, 255);
-                SDL_RenderFillRect(renderer, &(SDL_Rect){x+MENU_OFFSET, y, s.length, s.innerHeight});
+                SDL_RenderFillRect(renderer, &track);
                 
                 // Filled portion of music slider
-                SDL_Rect sliderRect = {x+MENU_OFFSET, y, (int)(s.length * s.knobPosition), s.innerHeight};
+                SDL_Rect sliderRect = {track.x, track.y, (int)(track.w * s.knobPosition), track.h};
                 float p = s.knobPosition*100;
                 SDL_SetRenderDrawColor(renderer, (int)s.innerColor.r+p, (int)s.innerColor.g+p, (int)s.innerColor.b+2*p, s.innerColor.a);
                 SDL_RenderFillRect(renderer, &sliderRect);
@@ -525,20 +654,61 @@ void renderMenuList(SDL_Renderer* renderer, GameResources* resources, MenuListIt
 
                 // Render knobs
                 SDL_SetRenderDrawColor(renderer, s.knobColor.r, s.knobColor.g, s.knobColor.b, s.knobColor.a);
-                SDL_RenderFillRect(renderer, &(SDL_Rect){x+MENU_OFFSET + (int)(s.length * s.knobPosition) - 5, y-2, 10, s.innerHeight+4});
+                SDL_RenderFillRect(renderer, &(SDL_Rect){track.x + sliderRect.w - 5, track.y-2, 10, track.h+4});
                 
                 // Render volume percentages
                 char musicPercent[10];
                 sprintf(musicPercent, "%.0f%%", s.knobPosition * 100);
-                SDL_Rect musicPercentRect = {x + MENU_OFFSET + s.length, y, 40, 20};
-                renderText(renderer, resources->font, musicPercent, color, &musicPercentRect, 0, 1);
+                renderText(renderer, resources->font, musicPercent, color, &item->value, 0, 1);
                 break;
+            }
             default:
                 break;
         }
-
-        currentYPosition -= lineHeight;
     }
 
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
-}
\ No newline at end of file
+}
+
+// Title and buttons of a menu, from the cached layer. It is redrawn when the
+// hover, slider or checkbox state changed, when another menu is shown, when a
+// texture it uses was missing (still loading), or when any texture was
+// uploaded since: a hot reload only counts once the new one is resident.
+void renderMenuLayer(SDL_Renderer* renderer, GameResources* resources, UIElements* ui, GameState screen) {
+    PROFILE_FUNCTION();
+    const char* title = screen == OPTIONS ? "Options" : "Fight game";
+    MenuListItem* items = screen == OPTIONS ? ui->optionsButtons : ui->menuButtons;
+    int count = screen == OPTIONS ? ui->nbOptionsButtons : ui->nbMenuButtons;
+    TextureManager* tm = &resources->textures;
+
+    if (!ui->menuLayer) {
+        ui->menuLayer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, ui->layoutWidth, ui->layoutHeight);
+        if (!ui->menuLayer) {
+            // No render targets: draw it every frame
+            renderText(renderer, resources->titleFont, title, ui->yellow, &ui->titleRect, 1, 1);
+            renderMenuList(renderer, resources, items, count);
+            return;
+        }
+        SDL_SetTextureBlendMode(ui->menuLayer, SDL_BLENDMODE_BLEND);
+        trackTexture(ui->menuLayer, TEXCAT_UI);
+        ui->menuLayerDirty = 1;
+    }
+
+    if (ui->menuLayerDirty || ui->menuLayerScreen != screen || ui->menuLayerLoads != tm->loads) {
+        int misses = tm->frame_misses;
+
+        SDL_SetRenderTarget(renderer, ui->menuLayer);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        renderText(renderer, resources->titleFont, title, ui->yellow, &ui->titleRect, 1, 1);
+        renderMenuList(renderer, resources, items, count);
+        SDL_SetRenderTarget(renderer, NULL);
+
+        ui->menuLayerScreen = screen;
+        ui->menuLayerLoads = tm->loads;
+        ui->menuLayerDirty = tm->frame_misses != misses; // try again once they are loaded
+        ui->menuLayerRedraws++;
+    }
+
+    SDL_RenderCopy(renderer, ui->menuLayer, NULL, NULL);
+}
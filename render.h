@@ -5,22 +5,26 @@
 #include <SDL2/SDL_ttf.h>
 #include "init.h"  // Needs GameResources and UIElements
 #include "game.h"       // Needs Game and Fighter
+#include "netgame.h"    // Needs NetClient
 
 void renderGameScreen(SDL_Renderer* renderer, Game* game, Fighter* fighter, GameResources* resources, UIElements* ui, BackgroundEffects* bg_effects);
 void renderMainMenu(SDL_Renderer* renderer, GameResources* resources, UIElements* ui);
 void renderOptionsScreen(SDL_Renderer* renderer, Game* game, GameResources* resources, UIElements* ui);
+void renderLoadingScreen(SDL_Renderer* renderer, GameResources* resources, float progress, const char* current);
 void renderGameplay(SDL_Renderer* renderer, Game* game, Fighter* fighter, GameResources* resources, UIElements* ui, BackgroundEffects* bg_effects);
 
-void renderThruster(SDL_Renderer* renderer, Fighter* fighter, GameResources* resources);
-void renderSingleThruster(SDL_Renderer* renderer, SDL_Texture* texture, Fighter* fighter, SDL_Point offset);
+void renderThruster(SDL_Renderer* renderer, Fighter* fighter, float angle, GameResources* resources);
+void renderRemotePlayers(SDL_Renderer* renderer, const NetClient* net, const Fighter* fighter, GameResources* resources);
+void renderSingleThruster(SDL_Renderer* renderer, SDL_Texture* texture, SDL_Point size, Fighter* fighter, float angle, SDL_Point offset);
 
 void renderOrbitalTrails(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources);
 void renderSolarSystem(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources);
 void renderStarfield(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources);
-void renderAstralObjects(SDL_Renderer* renderer, BackgroundEffects* bg_effects, GameResources* resources);
+void renderAstralObjects(SDL_Renderer* renderer, BackgroundEffects* bg_effects, const Uint8* discovered, GameResources* resources);
 void renderDiscoveryProgress(SDL_Renderer* renderer, Game* game, GameResources* resources, UIElements* ui);
 void renderVolumeSliders(SDL_Renderer* renderer, GameResources* resources, Slider s, int x, int y);
 void renderMenuList(SDL_Renderer* renderer, GameResources* resources, MenuListItem* menuList, int listSize);
+void renderMenuLayer(SDL_Renderer* renderer, GameResources* resources, UIElements* ui, GameState screen);
 
 void drawCircle(SDL_Renderer* renderer, int center_x, int center_y, int radius, SDL_Color color);
 void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color, SDL_Rect* dstRect, int centerHorizontally, int centerVertically);
@@ -0,0 +1,241 @@
+#include "server.h"
+#include "sim.h"
+#include "gravity.h"
+#include "memtrack.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Returns 1 if arg was one of the server options
+int parseServerArgument(const char* arg, ServerOptions* options) {
+    if (strcmp(arg, "--server") == 0) {
+        options->enabled = 1;
+        return 1;
+    }
+    if (strncmp(arg, "--server=", 9) == 0) {
+        int sessions = atoi(arg + 9);
+        options->enabled = 1;
+        if (sessions < 1 || sessions > SERVER_MAX_SESSIONS) {
+            printf("Warning: --server needs 1 to %d sessions, got %s\n", SERVER_MAX_SESSIONS, arg + 9);
+        } else {
+            options->sessions = sessions;
+        }
+        return 1;
+    }
+    if (strncmp(arg, "--workers=", 10) == 0) {
+        options->workers = atoi(arg + 10);
+        return 1;
+    }
+    return 0;
+}
+
+// Discovery distances scale with the astral image sizes, read from the files
+static void loadAstralSizes(SDL_Point sizes[ASTRAL_TYPES]) {
+    for (int i = 0; i < ASTRAL_TYPES; i++) {
+        SDL_Surface* surface = IMG_Load(astralTexturePaths[i]);
+        if (!surface) {
+            printf("Warning: Could not load %s, using the fallback size\n", astralTexturePaths[i]);
+            sizes[i] = (SDL_Point){ 1000, 1000 };   // Same as the texture fallback
+            continue;
+        }
+        sizes[i] = (SDL_Point){ surface->w, surface->h };
+        SDL_FreeSurface(surface);
+    }
+}
+
+void initBot(Bot* bot, int seed) {
+    bot->rng = 0x9E3779B9u ^ ((Uint32)seed * 2654435761u);
+    if (!bot->rng) bot->rng = 1;
+    bot->target = -1;
+}
+
+static Uint32 botRandom(Bot* bot) {
+    Uint32 s = bot->rng;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    bot->rng = s;
+    return s;
+}
+
+// Next undiscovered object, from a random start so the bots spread out
+static int pickTarget(Bot* bot, const SimPlayer* player, const BackgroundEffects* world) {
+    int count = world->num_astral_objects;
+    if (count == 0) return -1;
+    int start = botRandom(bot) % count;
+    for (int i = 0; i < count; i++) {
+        int index = (start + i) % count;
+        if (!player->discovered[index]) return index;
+    }
+    return -1;
+}
+
+// Steers on the velocity error: the velocity it wants points at the target
+// and slows down close to it, the fighter turns toward the difference and
+// thrusts once it faces it. Same controls a player has.
+void runBot(Bot* bot, const SimPlayer* player, const BackgroundEffects* world, SimControls* controls) {
+    memset(controls, 0, sizeof(*controls));
+
+    if (bot->target < 0 || player->discovered[bot->target]) bot->target = pickTarget(bot, player, world);
+    if (bot->target < 0) return;
+
+    const AstralObject* obj = &world->astral_objects[bot->target];
+    float dx = obj->world_position.x + (int)(obj->w * obj->scale / 10) / 2 - player->x;
+    float dy = obj->world_position.y + (int)(obj->h * obj->scale / 10) / 2 - player->y;
+    float distance = sqrtf(dx * dx + dy * dy);
+    if (distance < 1.0f) return;
+
+    // Slow enough to brake in the distance left, turning around included
+    float wanted = SDL_min(SERVER_BOT_SPEED, sqrtf(FIGHTER_SPEED * distance));
+    float error_x = dx / distance * wanted - player->speed_x;
+    float error_y = dy / distance * wanted - player->speed_y;
+    if (error_x * error_x + error_y * error_y < FIGHTER_SPEED * FIGHTER_SPEED) return;
+
+    // 0 is up, clockwise, like the thrust in applyControls
+    float heading = atan2f(error_x, -error_y) * 180.0f / M_PI;
+    float diff = fmodf(heading - player->angle, 360.0f);
+    if (diff < -180.0f) diff += 360.0f;
+    if (diff >= 180.0f) diff -= 360.0f;
+
+    if (diff > ANGLES_PER_FRAME) controls->turn_right = 1;
+    else if (diff < -ANGLES_PER_FRAME) controls->turn_left = 1;
+    else controls->thrust = 1;
+}
+
+// Found everything: same player, a new round
+static void restartRound(ServerSession* session, const BackgroundEffects* world) {
+    SimPlayer* player = &session->player;
+    memset(player->discovered, 0, SDL_max(world->num_astral_objects, 1));
+    initDiscoverySystem(&player->discovery, world);
+    player->objectives_finished = 0;
+    session->bot.target = -1;
+    session->rounds++;
+}
+
+// Job: sessions [begin, end) of one tick
+static void stepSessions(void* data, int begin, int end) {
+    Server* server = data;
+    for (int i = begin; i < end; i++) {
+        ServerSession* session = &server->sessions[i];
+        runBot(&session->bot, &session->player, server->world, &session->controls);
+
+        SimEvents events;
+        stepSimPlayer(&session->player, &session->controls, server->world, &events);
+        if (session->player.objectives_finished) restartRound(session, server->world);
+    }
+}
+
+static void serverTick(Server* server) {
+    updateSolarSystem(server->world);
+    runJobs(&server->pool, stepSessions, server, server->num_sessions, SERVER_GRAIN);
+    server->tick++;
+}
+
+static void initSessions(Server* server, int count) {
+    server->sessions = memCalloc(count, sizeof(ServerSession), MEM_WORLD);
+    checkInit(!server->sessions, "Failed to allocate the sessions!");
+    server->num_sessions = count;
+
+    // Everyone starts on the sun
+    for (int i = 0; i < count; i++) {
+        ServerSession* session = &server->sessions[i];
+        initSimPlayer(&session->player, server->world, 0, 0);
+        initBot(&session->bot, i);
+    }
+}
+
+static void destroySessions(Server* server) {
+    for (int i = 0; i < server->num_sessions; i++) destroySimPlayer(&server->sessions[i].player);
+    memFree(server->sessions);
+    server->sessions = NULL;
+    server->num_sessions = 0;
+}
+
+// Runs count sessions for SERVER_RUN_SECONDS and prints one line
+static void measureSessions(Server* server, int count) {
+    initSessions(server, count);
+    for (int i = 0; i < SERVER_WARMUP_TICKS; i++) serverTick(server);
+    SDL_AtomicSet(&server->pool.steals, 0);
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter(), now;
+    Uint64 ticks = 0;
+    do {
+        serverTick(server);
+        ticks++;
+        now = SDL_GetPerformanceCounter();
+    } while (now - start < SERVER_RUN_SECONDS * frequency);
+
+    double seconds = (double)(now - start) / frequency;
+    double session_ticks = (double)ticks * count / seconds;
+    Uint64 found = 0;
+    for (int i = 0; i < count; i++) {
+        const ServerSession* session = &server->sessions[i];
+        found += (Uint64)session->rounds * server->world->num_astral_objects + session->player.discovery.total_discovered;
+    }
+
+    printf("%9d %10llu %12.0f %16.0f %10.3f %12.0f %10.2f %12.2f\n",
+           count, (unsigned long long)ticks, ticks / seconds, session_ticks, seconds * 1000.0 / ticks,
+           session_ticks / FPS, (double)SDL_AtomicGet(&server->pool.steals) / ticks, (double)found / count);
+    destroySessions(server);
+}
+
+// The world the game spawns, without the textures: what a server needs to
+// run the rules. IMG_Init first, the astral sizes come from the images.
+BackgroundEffects* createHeadlessWorld(const WorldConfig* config) {
+    static GameData data;
+    loadGameData(&data);
+
+    BackgroundEffects* world = memCalloc(1, sizeof(BackgroundEffects), MEM_WORLD);
+    checkInit(!world, "Failed to allocate the world");
+    initWorld(world, config);
+
+    // The game never seeds rand(): start from the same sequence every time,
+    // the starfield takes its share before the astral objects
+    srand(1);
+    generateStarfield(world);
+    initSolarSystem(world, &data);
+    SDL_Point sizes[ASTRAL_TYPES];
+    loadAstralSizes(sizes);
+    spawnAstralObjects(world, sizes);
+    initWorldGravity(world);
+    return world;
+}
+
+void destroyHeadlessWorld(BackgroundEffects* world) {
+    destroyGravityField(world);
+    destroyWorld(world);
+    memFree(world);
+}
+
+int runServer(const ServerOptions* options, const WorldConfig* config) {
+    checkInit(SDL_Init(0) < 0, "SDL could not initialize!");
+    checkInit(!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG), "SDL_image could not initialize!");
+
+    static Server server;
+    server.world = createHeadlessWorld(config);
+
+    initJobPool(&server.pool, options->workers);
+    printf("Server: %d workers, %d astral objects, ticks of 1/%d s\n",
+           server.pool.num_workers, server.world->num_astral_objects, FPS);
+    // realtime: sessions this machine could keep at FPS ticks per second.
+    // steals per tick, discovered per session over the run.
+    printf("%9s %10s %12s %16s %10s %12s %10s %12s\n",
+           "sessions", "ticks", "ticks/s", "session ticks/s", "ms/tick", "realtime", "steals", "discovered");
+    const int sweep[] = { 1, 10, 100, 1000, 10000 };
+    if (options->sessions > 0) {
+        measureSessions(&server, options->sessions);
+    } else {
+        for (int i = 0; i < (int)(sizeof(sweep) / sizeof(sweep[0])); i++) measureSessions(&server, sweep[i]);
+    }
+
+    destroyJobPool(&server.pool);
+    destroyHeadlessWorld(server.world);
+    server.world = NULL;
+    IMG_Quit();
+    SDL_Quit();
+
+    printMemoryLeaks();
+    return 0;
+}
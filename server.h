@@ -0,0 +1,63 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <SDL2/SDL.h>
+#include "init.h"
+#include "jobs.h"
+
+/*
+            DEFINITIONS
+*/
+#define SERVER_RUN_SECONDS 2.0       // Wall time measured per session count
+#define SERVER_WARMUP_TICKS 30       // Not measured: first touches of the sessions, workers waking up
+#define SERVER_GRAIN 64              // Sessions per job range
+#define SERVER_MAX_SESSIONS 1000000
+#define SERVER_BOT_SPEED 12.0f       // px per tick, the bots cruise at it
+
+/*
+            SERVER STRUCTURES
+*/
+// --server[=sessions] [--workers=N]: no window, renderer or audio
+typedef struct {
+    int enabled;
+    int sessions;                    // 0 sweeps 1, 10, 100, 1000 and 10000
+    int workers;                     // 0 for one per core
+} ServerOptions;
+
+// Flies a player from astral object to astral object with the player's controls
+typedef struct {
+    Uint32 rng;                      // xorshift
+    int target;                      // Astral object it flies to, -1 to pick one
+} Bot;
+
+// One independent game, flown by a bot
+typedef struct {
+    SimPlayer player;
+    SimControls controls;
+    Bot bot;
+    int rounds;                      // Times it found everything, then started over
+} ServerSession;
+
+// Every session plays in the same world: the solar system is advanced once
+// per tick, then the sessions step in parallel and only read it. A tick is
+// the game's fixed 1/FPS step, run as fast as the machine goes.
+typedef struct {
+    BackgroundEffects* world;
+    JobPool pool;
+    ServerSession* sessions;
+    int num_sessions;
+    Uint64 tick;
+} Server;
+
+
+/*
+            DECLARATIONS
+*/
+int parseServerArgument(const char* arg, ServerOptions* options);
+int runServer(const ServerOptions* options, const WorldConfig* config);
+BackgroundEffects* createHeadlessWorld(const WorldConfig* config);
+void destroyHeadlessWorld(BackgroundEffects* world);
+void initBot(Bot* bot, int seed);
+void runBot(Bot* bot, const SimPlayer* player, const BackgroundEffects* world, SimControls* controls);
+
+#endif
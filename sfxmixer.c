@@ -0,0 +1,264 @@
+#include "sfxmixer.h"
+#include <SDL2/SDL_mixer.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Mixes frames of pcm into mix, gains ramping linearly from (left0, right0)
+// to (left1, right1). Both buffers are interleaved stereo, mix 16-byte aligned.
+void mixSfxVoice(float* mix, const float* pcm, int frames, float left0, float right0, float left1, float right1) {
+    float step_left = (left1 - left0) / frames;
+    float step_right = (right1 - right0) / frames;
+    int f = 0;
+
+#ifdef __SSE2__
+    // Two frames per iteration
+    __m128 gain = _mm_setr_ps(left0, right0, left0 + step_left, right0 + step_right);
+    __m128 step = _mm_setr_ps(2 * step_left, 2 * step_right, 2 * step_left, 2 * step_right);
+    for (; f + 2 <= frames; f += 2) {
+        __m128 in = _mm_loadu_ps(&pcm[f * 2]);
+        __m128 out = _mm_load_ps(&mix[f * 2]);
+        _mm_store_ps(&mix[f * 2], _mm_add_ps(out, _mm_mul_ps(in, gain)));
+        gain = _mm_add_ps(gain, step);
+    }
+#endif
+
+    for (; f < frames; f++) {
+        mix[f * 2 + 0] += pcm[f * 2 + 0] * (left0 + step_left * f);
+        mix[f * 2 + 1] += pcm[f * 2 + 1] * (right0 + step_right * f);
+    }
+}
+
+// Adds the mixed effects to what SDL_mixer produced (music), saturating
+void addSfxToStream(Sint16* stream, const float* mix, int samples) {
+    int i = 0;
+
+#ifdef __SSE2__
+    // Widen the stream to float, add, pack back with signed saturation
+    for (; i + 8 <= samples; i += 8) {
+        __m128i in = _mm_loadu_si128((const __m128i*)&stream[i]);
+        __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16));
+        __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16));
+        __m128i a = _mm_cvtps_epi32(_mm_add_ps(low, _mm_load_ps(&mix[i])));
+        __m128i b = _mm_cvtps_epi32(_mm_add_ps(high, _mm_load_ps(&mix[i + 4])));
+        _mm_storeu_si128((__m128i*)&stream[i], _mm_packs_epi32(a, b));
+    }
+#endif
+
+    for (; i < samples; i++) {
+        float sample = stream[i] + mix[i];
+        stream[i] = (Sint16)(sample > 32767.0f ? 32767 : sample < -32768.0f ? -32768 : sample);
+    }
+}
+
+/*
+            AUDIO CALLBACK
+*/
+static void endVoice(SfxMixer* sm, SfxVoice* voice, int index) {
+    voice->active = 0;
+    SDL_AtomicSet(&sm->finished[index], (int)voice->generation);
+}
+
+static void retireBank(SfxMixer* sm, SoundBank* bank) {
+    if (!bank) return;
+    Uint32 write = SDL_AtomicGet(&sm->retired_write);
+    sm->retired[write & (SFX_QUEUE_SIZE - 1)] = bank;
+    SDL_AtomicSet(&sm->retired_write, (int)(write + 1));
+}
+
+static void runCommand(SfxMixer* sm, const SfxCommand* command) {
+    SfxVoice* voice = &sm->voices[command->voice];
+
+    switch (command->type) {
+        case SFX_PLAY:
+            if (voice->active) endVoice(sm, voice, command->voice);
+            *voice = (SfxVoice){
+                .active = 1,
+                .sound = command->sound,
+                .generation = command->generation,
+                .gain_left = command->gain_left, .gain_right = command->gain_right,
+                .target_left = command->gain_left, .target_right = command->gain_right
+            };
+            break;
+        case SFX_STOP:
+            if (voice->active) endVoice(sm, voice, command->voice);
+            break;
+        case SFX_GAIN:
+            voice->target_left = command->gain_left;
+            voice->target_right = command->gain_right;
+            break;
+        case SFX_BANK:
+            // Voices keep their sound id, past the end of a shorter sound they stop
+            retireBank(sm, sm->bank);
+            sm->bank = command->bank;
+            break;
+    }
+}
+
+// SDL_mixer post-mix hook, audio thread: never blocks, never allocates
+static void sfxCallback(void* data, Uint8* stream, int length) {
+    SfxMixer* sm = data;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    Uint32 read = SDL_AtomicGet(&sm->command_read);
+    Uint32 write = SDL_AtomicGet(&sm->command_write);
+    for (; read != write; read++) runCommand(sm, &sm->commands[read & (SFX_QUEUE_SIZE - 1)]);
+    SDL_AtomicSet(&sm->command_read, (int)read);
+
+    Sint16* out = (Sint16*)stream;
+    int frames = length / (2 * sizeof(Sint16));
+    int active = 0;
+
+    while (frames > 0) {
+        int block = frames < SFX_MIX_FRAMES ? frames : SFX_MIX_FRAMES;
+        memset(sm->mix, 0, block * 2 * sizeof(float));
+        active = 0;
+
+        for (int v = 0; v < SFX_MAX_VOICES; v++) {
+            SfxVoice* voice = &sm->voices[v];
+            if (!voice->active) continue;
+
+            Uint32 frames = 0;
+            const float* pcm = soundBankSamples(sm->bank, voice->sound, &frames);
+            if (!pcm || voice->position >= frames) {
+                endVoice(sm, voice, v);
+                continue;
+            }
+
+            int count = frames - voice->position;
+            if (count > block) count = block;
+
+            // Ramp towards the target over this pass, no zipper noise on pan updates
+            float left = voice->gain_left + (voice->target_left - voice->gain_left) * count / block;
+            float right = voice->gain_right + (voice->target_right - voice->gain_right) * count / block;
+            mixSfxVoice(sm->mix, &pcm[voice->position * 2], count, voice->gain_left, voice->gain_right, left, right);
+            voice->gain_left = left;
+            voice->gain_right = right;
+
+            voice->position += count;
+            sm->voice_frames += count;
+            active++;
+            if (voice->position >= frames) endVoice(sm, voice, v);
+        }
+
+        addSfxToStream(out, sm->mix, block * 2);
+        out += block * 2;
+        frames -= block;
+    }
+
+    if (active > sm->peak_voices) sm->peak_voices = active;
+    sm->callbacks++;
+    sm->callback_ticks += SDL_GetPerformanceCounter() - start;
+}
+
+/*
+            GAME THREAD
+*/
+static void freeRetiredBanks(SfxMixer* sm) {
+    Uint32 read = SDL_AtomicGet(&sm->retired_read);
+    Uint32 write = SDL_AtomicGet(&sm->retired_write);
+    for (; read != write; read++) freeSoundBank(sm->retired[read & (SFX_QUEUE_SIZE - 1)]);
+    SDL_AtomicSet(&sm->retired_read, (int)read);
+}
+
+// Returns 0 (sound effects stay silent) if the output is not 16-bit stereo
+int initSfxMixer(SfxMixer* sm) {
+    memset(sm, 0, sizeof(*sm));
+
+    int channels;
+    Uint16 format;
+    if (!Mix_QuerySpec(&sm->frequency, &format, &channels) || format != AUDIO_S16SYS || channels != 2) {
+        printf("Warning: Sound effects need 16-bit stereo output, effects disabled\n");
+        return 0;
+    }
+
+    sm->enabled = 1;
+    Mix_SetPostMix(sfxCallback, sm);
+    return 1;
+}
+
+void shutdownSfxMixer(SfxMixer* sm) {
+    if (!sm->enabled) return;
+    Mix_SetPostMix(NULL, NULL); // takes the audio lock: the callback is not running after this
+    sm->enabled = 0;
+
+    // The callback state is ours now: run what it did not get to, then free every bank
+    Uint32 read = SDL_AtomicGet(&sm->command_read);
+    Uint32 write = SDL_AtomicGet(&sm->command_write);
+    for (; read != write; read++) runCommand(sm, &sm->commands[read & (SFX_QUEUE_SIZE - 1)]);
+    SDL_AtomicSet(&sm->command_read, (int)read);
+
+    freeRetiredBanks(sm);
+    freeSoundBank(sm->bank);
+    sm->bank = NULL;
+}
+
+// Returns 0 if the queue is full, the command is dropped
+static int pushCommand(SfxMixer* sm, SfxCommand command) {
+    freeRetiredBanks(sm); // keeps the retire ring from filling up
+    Uint32 write = SDL_AtomicGet(&sm->command_write);
+    if (write - (Uint32)SDL_AtomicGet(&sm->command_read) == SFX_QUEUE_SIZE) {
+        sm->dropped_commands++;
+        return 0;
+    }
+
+    sm->commands[write & (SFX_QUEUE_SIZE - 1)] = command;
+    SDL_AtomicSet(&sm->command_write, (int)(write + 1)); // publishes the command
+    return 1;
+}
+
+// The mixer owns the bank from here, the previous one is freed once the
+// callback let go of it. Returns 0 (the bank is freed) if the queue is full.
+int setSfxBank(SfxMixer* sm, SoundBank* bank) {
+    if (!sm->enabled || !pushCommand(sm, (SfxCommand){ .type = SFX_BANK, .bank = bank })) {
+        freeSoundBank(bank);
+        return 0;
+    }
+    return 1;
+}
+
+// Replaces whatever the voice was playing. Returns 0 if the command was dropped.
+int playSfx(SfxMixer* sm, int voice, int sound, float gain_left, float gain_right) {
+    if (!sm->enabled || voice < 0 || voice >= SFX_MAX_VOICES) return 0;
+
+    Uint32 generation = sm->generation[voice] + 1;
+    if (!pushCommand(sm, (SfxCommand){
+            .type = SFX_PLAY, .voice = voice, .sound = sound, .generation = generation,
+            .gain_left = gain_left, .gain_right = gain_right })) {
+        return 0;
+    }
+    sm->generation[voice] = generation;
+    return 1;
+}
+
+void stopSfx(SfxMixer* sm, int voice) {
+    if (!sm->enabled || voice < 0 || voice >= SFX_MAX_VOICES) return;
+    pushCommand(sm, (SfxCommand){ .type = SFX_STOP, .voice = voice });
+}
+
+void setSfxGain(SfxMixer* sm, int voice, float gain_left, float gain_right) {
+    if (!sm->enabled || voice < 0 || voice >= SFX_MAX_VOICES) return;
+    pushCommand(sm, (SfxCommand){ .type = SFX_GAIN, .voice = voice, .gain_left = gain_left, .gain_right = gain_right });
+}
+
+// 1 from the play command until the callback reports the end, even if it has
+// not picked the command up yet
+int sfxVoicePlaying(SfxMixer* sm, int voice) {
+    if (voice < 0 || voice >= SFX_MAX_VOICES) return 0;
+    return (Uint32)SDL_AtomicGet(&sm->finished[voice]) != sm->generation[voice];
+}
+
+// Call after shutdownSfxMixer, the counters belong to the callback until then
+void printSfxStats(SfxMixer* sm) {
+    if (sm->callbacks == 0) return;
+
+    double ms = (double)sm->callback_ticks * 1000.0 / SDL_GetPerformanceFrequency();
+    printf("SFX mixer: %llu callbacks, %.3f ms average, peak %d voices, %llu dropped commands\n",
+           (unsigned long long)sm->callbacks, ms / sm->callbacks, sm->peak_voices, (unsigned long long)sm->dropped_commands);
+    if (sm->voice_frames > 0) {
+        printf("SFX mixer: %.2f ns per voice frame\n", ms * 1000000.0 / sm->voice_frames);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef SFXMIXER_H
+#define SFXMIXER_H
+
+#include <SDL2/SDL.h>
+#include "soundbank.h"
+
+/*
+            DEFINITIONS
+*/
+#define SFX_MAX_VOICES 32
+#define SFX_QUEUE_SIZE 256           // Commands in flight, power of two
+#define SFX_MIX_FRAMES 1024          // Frames mixed per pass inside the callback
+
+typedef enum {
+    SFX_PLAY,
+    SFX_STOP,
+    SFX_GAIN,
+    SFX_BANK
+} SfxCommandType;
+
+/*
+            MIXER STRUCTURES
+*/
+typedef struct {
+    SfxCommandType type;
+    int voice;
+    int sound;                       // Sound bank entry
+    Uint32 generation;               // SFX_PLAY: reported back when the voice ends
+    float gain_left, gain_right;
+    SoundBank* bank;                 // SFX_BANK
+} SfxCommand;
+
+typedef struct {
+    int active;
+    int sound;
+    Uint32 position;                 // Frame
+    Uint32 generation;
+    float gain_left, gain_right;     // Applied, ramps to the target over one pass
+    float target_left, target_right;
+} SfxVoice;
+
+// Sound effects are mixed by us in the SDL_mixer post-mix hook, on top of
+// the music, with SIMD, straight from the sound bank (already in the output
+// format). The game thread never takes the audio lock: it pushes commands
+// into a single-producer single-consumer ring that the callback drains at the
+// start of each buffer. Banks the callback replaced come back through a
+// second ring and are freed on the game thread.
+typedef struct {
+    // Game thread -> audio callback
+    SfxCommand commands[SFX_QUEUE_SIZE];
+    SDL_atomic_t command_read;
+    SDL_atomic_t command_write;
+
+    // Audio callback -> game thread
+    SoundBank* retired[SFX_QUEUE_SIZE];
+    SDL_atomic_t retired_read;
+    SDL_atomic_t retired_write;
+
+    // Voice ends, per voice: the generation of the play that finished
+    SDL_atomic_t finished[SFX_MAX_VOICES];
+
+    // Game thread only
+    Uint32 generation[SFX_MAX_VOICES];
+    Uint64 dropped_commands;
+    int enabled;
+    int frequency;                   // Device rate, sound banks are converted to it
+
+    // Audio callback only
+    SoundBank* bank;
+    SfxVoice voices[SFX_MAX_VOICES];
+    float mix[SFX_MIX_FRAMES * 2] __attribute__((aligned(16)));
+
+    // Written by the callback, read once it is unhooked
+    Uint64 callbacks;
+    Uint64 callback_ticks;           // Performance counter
+    Uint64 voice_frames;             // Frames mixed, summed over voices
+    int peak_voices;
+} SfxMixer;
+
+
+/*
+            DECLARATIONS
+*/
+int initSfxMixer(SfxMixer* sm);
+void shutdownSfxMixer(SfxMixer* sm);
+int setSfxBank(SfxMixer* sm, SoundBank* bank);
+int playSfx(SfxMixer* sm, int voice, int sound, float gain_left, float gain_right);
+void stopSfx(SfxMixer* sm, int voice);
+void setSfxGain(SfxMixer* sm, int voice, float gain_left, float gain_right);
+int sfxVoicePlaying(SfxMixer* sm, int voice);
+void printSfxStats(SfxMixer* sm);
+
+void mixSfxVoice(float* mix, const float* pcm, int frames, float left0, float right0, float left1, float right1);
+void addSfxToStream(Sint16* stream, const float* mix, int samples);
+
+#endif
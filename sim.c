@@ -0,0 +1,263 @@
+#include "sim.h"
+#include "gravity.h"
+#include "memtrack.h"
+#include "profiler.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// x, y is where the fighter starts and where reset brings it back
+void initSimPlayer(SimPlayer* player, const BackgroundEffects* world, float x, float y) {
+    memset(player, 0, sizeof(*player));
+    player->x = player->spawn_x = x;
+    player->y = player->spawn_y = y;
+
+    player->discovered = memCalloc(SDL_max(world->num_astral_objects, 1), sizeof(Uint8), MEM_WORLD);
+    checkInit(!player->discovered, "Failed to allocate the discovery flags!");
+    initDiscoverySystem(&player->discovery, world);
+}
+
+void destroySimPlayer(SimPlayer* player) {
+    memFree(player->discovered);
+    player->discovered = NULL;
+}
+
+void initDiscoverySystem(DiscoverySystem* discovery, const BackgroundEffects* world) {
+    // Initialize counts to zero
+    memset(discovery, 0, sizeof(*discovery));
+
+    // Set total counts based on the world that was spawned
+    for (int i = 0; i < ASTRAL_TYPES; i++) discovery->total_count[i] = world->config.astral_counts[i];
+    discovery->total_objects = world->num_astral_objects;
+}
+
+// Totals from the flags alone, for flags that came from somewhere else (a snapshot)
+void countDiscoveries(SimPlayer* player, const BackgroundEffects* world) {
+    initDiscoverySystem(&player->discovery, world);
+    for (int i = 0; i < world->num_astral_objects; i++) {
+        if (!player->discovered[i]) continue;
+        const AstralObject* obj = &world->astral_objects[i];
+        player->discovery.discovered_count[obj->texture_index]++;
+        player->discovery.total_score[obj->texture_index] += obj->score_value;
+        player->discovery.total_discovered++;
+        player->discovery.total_score_earned += obj->score_value;
+    }
+}
+
+// One fixed tick. events is cleared first.
+void stepSimPlayer(SimPlayer* player, const SimControls* controls, const BackgroundEffects* world, SimEvents* events) {
+    events->num_discovered = 0;
+    events->finished = 0;
+
+    applyControls(player, controls);
+
+    // Apply speed limit after all movement calculations
+    limitFighterSpeed(player, FIGHTER_MAX_SPEED);
+
+    if (world->config.gravity != GRAVITY_OFF) calculateGravityForces(player, world);
+
+    player->x += player->speed_x;
+    player->y += player->speed_y;
+
+    // Check for astral object discovery
+    if (!player->objectives_finished) {
+        int new_discoveries = checkAstralObjectDiscovery(player, world, events);
+        player->score += new_discoveries * DISCOVERY_BONUS;
+    }
+}
+
+static void thrust(SimPlayer* player) {
+    float rad_angle = player->angle * M_PI / 180.0f;
+    player->speed_x += sin(rad_angle) * FIGHTER_SPEED;
+    player->speed_y += -cos(rad_angle) * FIGHTER_SPEED;
+    player->thrusting = 1;
+}
+
+void applyControls(SimPlayer* player, const SimControls* controls) {
+    player->thrusting = 0;
+
+    if (controls->thrust) thrust(player);
+
+    if (controls->retro) {
+        int action = getShortestRotationDirection(player);
+        if (action == THRUST) { // accelerate if angle opposite to speed
+            thrust(player);
+        } else {
+            switch(action) {
+                case TURN_LEFT:
+                    player->angle -= ANGLES_PER_FRAME;
+                    break;
+                case TURN_RIGHT:
+                    player->angle += ANGLES_PER_FRAME;
+                    break;
+                default: // DO_NOTHING
+                    break;
+            }
+        }
+    }
+
+    if (controls->turn_left) player->angle -= ANGLES_PER_FRAME;
+    if (controls->turn_right) player->angle += ANGLES_PER_FRAME;
+
+    if (controls->reset) {
+        player->speed_x = 0;
+        player->speed_y = 0;
+        player->angle = 0;
+        player->x = player->spawn_x;
+        player->y = player->spawn_y;
+    }
+}
+
+void updateSolarSystem(BackgroundEffects* world) {
+    PROFILE_FUNCTION();
+    for (int i = 0; i < NUM_PLANETS; i++) {
+        Planet* planet = &world->planets[i];
+
+        // Skip the sun (index 0) as it's stationary
+        if (i > 0) {
+            // Update orbit angle
+            planet->orbit_angle += planet->orbit_speed * SPEED_MULTIPLICATOR;
+            if (planet->orbit_angle > 2 * M_PI) {
+                planet->orbit_angle -= 2 * M_PI;
+            }
+        }
+
+        // Update world position (sun at 0,0, planets orbit around it)
+        if (i == 0) {
+            planet->world_pos.x = 0;
+            planet->world_pos.y = 0;
+        } else {
+            planet->world_pos.x = cos(planet->orbit_angle) * planet->orbit_radius;
+            planet->world_pos.y = sin(planet->orbit_angle) * planet->orbit_radius;
+        }
+    }
+
+    // Re-stamp the planets that moved, when the rules sample the field
+    updateGravityField(world);
+}
+
+// Helper function to find the shortest rotation direction movement direction and facing direction of the fighter
+int getShortestRotationDirection(SimPlayer* player) {
+    int currentAngle = player->angle;
+    int targetAngle = ((int) getFighterMovementDirection(player) + 180) % 360; // [0, 360]
+
+    currentAngle = currentAngle % 360; // [-360, 360]
+    if (currentAngle < 0) currentAngle += 360; // [0, 360]
+
+    if (abs(currentAngle - targetAngle) < ANGLES_PER_FRAME + 0.01f) {
+        player->angle = targetAngle;
+        if (getFighterMovementSpeed(player) < 0.2) {
+            player->speed_x = 0;
+            player->speed_y = 0;
+            return DO_NOTHING;
+        } else {
+            return THRUST;
+        }
+    } else if (currentAngle < targetAngle) {
+        return abs(targetAngle - currentAngle) < 180 ? TURN_RIGHT : TURN_LEFT;
+    } else { // reverse direction if fighter angle > target angle
+        return abs(targetAngle - currentAngle) < 180 ? TURN_LEFT : TURN_RIGHT;
+    }
+}
+
+// Calculate the direction (angle) the fighter is moving based on velocity
+float getFighterMovementDirection(const SimPlayer* player) {
+    // If the fighter is not moving, return current angle
+    if (fabs(player->speed_x) < 0.01f && fabs(player->speed_y) < 0.01f) {
+        return player->angle - 180;
+    }
+
+    // Calculate angle from velocity vector using atan2
+    // atan2(y, x) gives angle in radians, convert to degrees
+    float direction = atan2f(player->speed_y, player->speed_x) * (180.0f / M_PI) +90;
+
+    // Convert from [-180, 180] range to [0, 360] range
+    if (direction < 0) {
+        direction += 360;
+    }
+    return direction;
+}
+
+/*
+atan2:
+         270°
+    180°      0°
+          90°
+
+my system:
+          0°
+    270°      90°
+         180°
+
+so +90°
+*/
+
+// out: speed > 0
+float getFighterMovementSpeed(const SimPlayer* player) {
+    float sqrSpeed = player->speed_x*player->speed_x + player->speed_y*player->speed_y;
+    return sqrtf(sqrSpeed);
+}
+
+void limitFighterSpeed(SimPlayer* player, float max_speed) {
+    float current_speed = getFighterMovementSpeed(player);
+
+    if (current_speed > max_speed) {
+        // Normalize the velocity vector and scale to max speed
+        float ratio = max_speed / current_speed;
+        player->speed_x *= ratio;
+        player->speed_y *= ratio;
+    }
+}
+
+void calculateGravityForces(SimPlayer* player, const BackgroundEffects* world) {
+    // Exact sum over planets or grid lookup, depending on the field mode
+    float accel_x, accel_y;
+    computeGravity(world, player->x, player->y, &accel_x, &accel_y);
+
+    // Apply acceleration to fighter velocity
+    player->speed_x += accel_x;
+    player->speed_y += accel_y;
+}
+
+int checkAstralObjectDiscovery(SimPlayer* player, const BackgroundEffects* world, SimEvents* events) {
+    PROFILE_FUNCTION();
+    int new_discoveries = 0;
+
+    for (int i = 0; i < world->num_astral_objects; i++) {
+        const AstralObject* obj = &world->astral_objects[i];
+
+        // Skip already discovered objects
+        if (player->discovered[i]) continue;
+
+        int scaled_w = obj->w * obj->scale /10;
+        int scaled_h = obj->h * obj->scale /10;
+
+        // Calculate distance between centers
+        float dx = obj->world_position.x + scaled_w/2 - player->x;
+        float dy = obj->world_position.y + scaled_h/2 - player->y;
+        float distance = sqrtf(dx * dx + dy * dy);
+
+        // Check if fighter is close enough (within 100px)
+        if (distance < fminf(obj->w, obj->h) * obj->scale * 0.8f /10) {
+            // Mark as discovered and update scores
+            player->discovered[i] = 1;
+            int type = obj->texture_index;
+
+            player->discovery.discovered_count[type]++;
+            player->discovery.total_score[type] += obj->score_value;
+            player->discovery.total_discovered++;
+            player->discovery.total_score_earned += obj->score_value;
+            player->score += obj->score_value;
+
+            if (events->num_discovered < SIM_MAX_EVENTS) events->discovered[events->num_discovered++] = i;
+            new_discoveries++;
+        }
+    }
+
+    if (player->discovery.total_discovered == player->discovery.total_objects) {
+        player->objectives_finished = 1;
+        events->finished = 1;
+    }
+
+    return new_discoveries;
+}
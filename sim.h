@@ -0,0 +1,40 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <SDL2/SDL.h>
+#include "init.h"   // World and SimPlayer structures
+
+/*
+            DEFINITIONS
+*/
+#define ANGLES_PER_FRAME 5
+#define SPEED_MULTIPLICATOR 0.00008
+#define DISCOVERY_BONUS 100             // On top of the object's own score
+
+enum {TURN_LEFT, TURN_RIGHT, THRUST, DO_NOTHING};
+
+// Game rules, apart from rendering, audio and input: nothing here touches a
+// renderer, a texture, the mixer or the event queue. The game steps one
+// player per frame, the server thousands from worker threads.
+// The world (planets, astral objects) is shared: a tick only reads it, apart
+// from updateSolarSystem which runs once per tick for everyone.
+
+/*
+            DECLARATIONS
+*/
+void initSimPlayer(SimPlayer* player, const BackgroundEffects* world, float x, float y);
+void destroySimPlayer(SimPlayer* player);
+void initDiscoverySystem(DiscoverySystem* discovery, const BackgroundEffects* world);
+void countDiscoveries(SimPlayer* player, const BackgroundEffects* world);
+void stepSimPlayer(SimPlayer* player, const SimControls* controls, const BackgroundEffects* world, SimEvents* events);
+void applyControls(SimPlayer* player, const SimControls* controls);
+void updateSolarSystem(BackgroundEffects* world);
+
+int getShortestRotationDirection(SimPlayer* player);
+float getFighterMovementDirection(const SimPlayer* player);
+float getFighterMovementSpeed(const SimPlayer* player);
+void limitFighterSpeed(SimPlayer* player, float max_speed);
+void calculateGravityForces(SimPlayer* player, const BackgroundEffects* world);
+int checkAstralObjectDiscovery(SimPlayer* player, const BackgroundEffects* world, SimEvents* events);
+
+#endif
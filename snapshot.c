@@ -0,0 +1,345 @@
+#include "snapshot.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+void storePlayerState(NetPlayerState* state, const SimPlayer* player) {
+    int angle = (int)lroundf(player->angle) % 360;
+    if (angle < 0) angle += 360;
+
+    state->x = (Sint32)lroundf(player->x * NET_POSITION_SCALE);
+    state->y = (Sint32)lroundf(player->y * NET_POSITION_SCALE);
+    state->speed_x = (Sint32)lroundf(player->speed_x * NET_SPEED_SCALE);
+    state->speed_y = (Sint32)lroundf(player->speed_y * NET_SPEED_SCALE);
+    state->angle = angle;
+    state->score = player->score;
+    state->present = 1;
+    state->thrusting = player->thrusting != 0;
+    state->finished = player->objectives_finished != 0;
+}
+
+// Leaves the discovery flags and totals alone, they come separately
+void loadPlayerState(SimPlayer* player, const NetPlayerState* state) {
+    player->x = state->x / NET_POSITION_SCALE;
+    player->y = state->y / NET_POSITION_SCALE;
+    player->speed_x = state->speed_x / NET_SPEED_SCALE;
+    player->speed_y = state->speed_y / NET_SPEED_SCALE;
+    player->angle = state->angle;
+    player->score = state->score;
+    player->thrusting = state->thrusting;
+    player->objectives_finished = state->finished;
+}
+
+// Rounds the player to what a snapshot can carry
+void quantizeSimPlayer(SimPlayer* player) {
+    NetPlayerState state;
+    storePlayerState(&state, player);
+    loadPlayerState(player, &state);
+}
+
+void storePlanetAngles(Uint16 angles[NUM_PLANETS], const BackgroundEffects* world) {
+    for (int i = 0; i < NUM_PLANETS; i++) {
+        // orbit_angle stays in [0, 2 pi], 2 pi wraps to 0
+        angles[i] = (Uint16)((Uint32)lround(world->planets[i].orbit_angle * NET_PLANET_ANGLE_SCALE) & 0xFFFF);
+    }
+}
+
+void loadPlanetAngles(BackgroundEffects* world, const Uint16 angles[NUM_PLANETS]) {
+    for (int i = 1; i < NUM_PLANETS; i++) {   // The sun stays at the center
+        Planet* planet = &world->planets[i];
+        planet->orbit_angle = angles[i] / NET_PLANET_ANGLE_SCALE;
+        planet->world_pos.x = cos(planet->orbit_angle) * planet->orbit_radius;
+        planet->world_pos.y = sin(planet->orbit_angle) * planet->orbit_radius;
+    }
+}
+
+int discoveryFlagBytes(const BackgroundEffects* world) {
+    return SDL_max((world->num_astral_objects + 7) / 8, 1);
+}
+
+void packDiscoveryFlags(Uint8* flags, const Uint8* discovered, int count) {
+    memset(flags, 0, (count + 7) / 8);
+    for (int i = 0; i < count; i++) {
+        if (discovered[i]) flags[i >> 3] |= 1 << (i & 7);
+    }
+}
+
+void unpackDiscoveryFlags(Uint8* discovered, const Uint8* flags, int count) {
+    for (int i = 0; i < count; i++) discovered[i] = (flags[i >> 3] >> (i & 7)) & 1;
+}
+
+static int samePlayerState(const NetPlayerState* a, const NetPlayerState* b) {
+    return a->present == b->present && a->x == b->x && a->y == b->y &&
+           a->speed_x == b->speed_x && a->speed_y == b->speed_y && a->angle == b->angle &&
+           a->score == b->score && a->thrusting == b->thrusting && a->finished == b->finished;
+}
+
+// Where the base's speed takes a position after ticks: a player coasting
+// codes its position in 1 bit. Integers, both ends get the same.
+static Sint32 predictPosition(Sint32 position, Sint32 speed, Uint32 ticks) {
+    return position + (Sint32)((Sint64)speed * ticks * NET_POSITION_SCALE / NET_SPEED_SCALE);
+}
+
+// Planets, then every player slot: 1 bit for a slot that did not change,
+// otherwise its presence and the fields that changed. A player the base
+// does not have is coded against zeros. Both ticks must be set.
+void writeWorldDelta(BitWriter* writer, const NetSnapshot* snapshot, const NetSnapshot* base) {
+    static const NetPlayerState empty = {0};
+
+    for (int i = 1; i < NUM_PLANETS; i++) {
+        writeDelta(writer, snapshot->planet_angles[i], base->planet_angles[i]);
+    }
+
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        const NetPlayerState* player = &snapshot->players[i];
+        const NetPlayerState* from = &base->players[i];
+        if (samePlayerState(player, from)) {
+            writeBits(writer, 0, 1);
+            continue;
+        }
+        writeBits(writer, 1, 1);
+        writeBits(writer, player->present, 1);
+        if (!player->present) continue;
+
+        if (!from->present) from = &empty;
+        Uint32 ticks = snapshot->tick - base->tick;
+        writeDelta(writer, player->x, predictPosition(from->x, from->speed_x, ticks));
+        writeDelta(writer, player->y, predictPosition(from->y, from->speed_y, ticks));
+        writeDelta(writer, player->speed_x, from->speed_x);
+        writeDelta(writer, player->speed_y, from->speed_y);
+        writeDelta(writer, player->angle, from->angle);
+        writeDelta(writer, player->score, from->score);
+        writeBits(writer, player->thrusting, 1);
+        writeBits(writer, player->finished, 1);
+    }
+}
+
+// snapshot->tick is set by the caller
+void readWorldDelta(BitReader* reader, NetSnapshot* snapshot, const NetSnapshot* base) {
+    static const NetPlayerState empty = {0};
+
+    snapshot->planet_angles[0] = base->planet_angles[0];
+    for (int i = 1; i < NUM_PLANETS; i++) {
+        snapshot->planet_angles[i] = (Uint16)readDelta(reader, base->planet_angles[i]);
+    }
+
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        NetPlayerState* player = &snapshot->players[i];
+        const NetPlayerState* from = &base->players[i];
+        if (!readBits(reader, 1)) {
+            *player = *from;
+            continue;
+        }
+        memset(player, 0, sizeof(*player));
+        player->present = readBits(reader, 1);
+        if (!player->present) continue;
+
+        if (!from->present) from = &empty;
+        Uint32 ticks = snapshot->tick - base->tick;
+        player->x = readDelta(reader, predictPosition(from->x, from->speed_x, ticks));
+        player->y = readDelta(reader, predictPosition(from->y, from->speed_y, ticks));
+        player->speed_x = readDelta(reader, from->speed_x);
+        player->speed_y = readDelta(reader, from->speed_y);
+        player->angle = readDelta(reader, from->angle);
+        player->score = readDelta(reader, from->score);
+        player->thrusting = readBits(reader, 1);
+        player->finished = readBits(reader, 1);
+    }
+}
+
+// The indices that flipped since the base, or all the flags when that is
+// shorter (a full snapshot late in a round)
+void writeFlagsDelta(BitWriter* writer, const Uint8* flags, const Uint8* base, int count) {
+    int changed = 0;
+    for (int i = 0; i < (count + 7) / 8; i++) {
+        for (Uint8 diff = flags[i] ^ base[i]; diff; diff &= diff - 1) changed++;
+    }
+
+    int index_bits = bitsFor(count);
+    if ((long long)changed * index_bits > count) {
+        writeBits(writer, 1, 1);
+        appendBits(writer, flags, count);
+        return;
+    }
+
+    writeBits(writer, 0, 1);
+    writeVarint(writer, changed);
+    for (int i = 0; i < (count + 7) / 8; i++) {
+        Uint8 diff = flags[i] ^ base[i];
+        for (int bit = 0; diff; bit++, diff >>= 1) {
+            if (diff & 1) writeBits(writer, i * 8 + bit, index_bits);
+        }
+    }
+}
+
+void readFlagsDelta(BitReader* reader, Uint8* flags, const Uint8* base, int count) {
+    int bytes = (count + 7) / 8;
+    if (readBits(reader, 1)) {
+        for (int i = 0; i < count; i += 8) flags[i >> 3] = readBits(reader, SDL_min(8, count - i));
+        return;
+    }
+
+    memcpy(flags, base, bytes);
+    Uint32 changed = readVarint(reader);
+    int index_bits = bitsFor(count);
+    for (Uint32 i = 0; i < changed && !reader->overflow; i++) {
+        Uint32 index = readBits(reader, index_bits);
+        if (index >= (Uint32)count) {
+            reader->overflow = 1;
+            return;
+        }
+        flags[index >> 3] ^= 1 << (index & 7);
+    }
+}
+
+static void hashInt(Uint32* hash, Sint32 value) {
+    for (int i = 0; i < 4; i++) {
+        *hash ^= ((Uint32)value >> (i * 8)) & 0xFF;
+        *hash *= 16777619u;
+    }
+}
+
+// FNV-1a over what discovery depends on: a client and a server that spawned
+// different astral objects would never agree on what was found
+Uint32 hashWorld(const BackgroundEffects* world) {
+    Uint32 hash = 2166136261u;
+    hashInt(&hash, world->num_astral_objects);
+    for (int i = 0; i < world->num_astral_objects; i++) {
+        const AstralObject* obj = &world->astral_objects[i];
+        hashInt(&hash, obj->world_position.x);
+        hashInt(&hash, obj->world_position.y);
+        hashInt(&hash, obj->w);
+        hashInt(&hash, obj->h);
+        hashInt(&hash, (Sint32)lroundf(obj->scale * 1000.0f));
+        hashInt(&hash, obj->texture_index);
+        hashInt(&hash, obj->score_value);
+    }
+    return hash;
+}
+
+/*
+            CODEC CHECK
+*/
+static Uint32 codecRandom(Uint32* state) {
+    Uint32 s = *state;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    *state = s;
+    return s;
+}
+
+// Anywhere in a world a few times the default size, at any speed a fighter reaches
+static void randomPlayerState(NetPlayerState* player, Uint32* rng) {
+    memset(player, 0, sizeof(*player));
+    player->present = 1;
+    player->x = (Sint32)(codecRandom(rng) % (1u << 26)) - (1 << 25);
+    player->y = (Sint32)(codecRandom(rng) % (1u << 26)) - (1 << 25);
+    player->speed_x = (Sint32)(codecRandom(rng) % (1u << 16)) - (1 << 15);
+    player->speed_y = (Sint32)(codecRandom(rng) % (1u << 16)) - (1 << 15);
+    player->angle = codecRandom(rng) % 360;
+    player->score = codecRandom(rng) % 100000;
+    player->thrusting = codecRandom(rng) & 1;
+    player->finished = codecRandom(rng) & 1;
+}
+
+// What the server could send ticks after base: every player slot kept,
+// nudged, replaced, emptied or filled
+static void randomSnapshot(NetSnapshot* snapshot, const NetSnapshot* base, Uint32 ticks, Uint32* rng) {
+    *snapshot = *base;
+    snapshot->tick = base->tick + ticks;
+    for (int i = 1; i < NUM_PLANETS; i++) snapshot->planet_angles[i] += codecRandom(rng) % 512;
+
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        NetPlayerState* player = &snapshot->players[i];
+        switch (codecRandom(rng) % 4) {
+        case 0:
+            break;
+        case 1:
+            if (!player->present) break;
+            player->x = predictPosition(player->x, player->speed_x, ticks) + (Sint32)(codecRandom(rng) % 64) - 32;
+            player->y = predictPosition(player->y, player->speed_y, ticks) + (Sint32)(codecRandom(rng) % 64) - 32;
+            player->angle = (player->angle + codecRandom(rng) % 8) % 360;
+            break;
+        case 2:
+            randomPlayerState(player, rng);
+            break;
+        default:
+            memset(player, 0, sizeof(*player));
+            break;
+        }
+    }
+}
+
+// Unused bits of the last byte stay clear, as packDiscoveryFlags leaves them
+static void randomFlags(Uint8* flags, const Uint8* base, int count, int flips, Uint32* rng) {
+    int bytes = (count + 7) / 8;
+    memcpy(flags, base, bytes);
+    for (int i = 0; i < flips; i++) {
+        int index = codecRandom(rng) % count;
+        flags[index >> 3] ^= 1 << (index & 7);
+    }
+}
+
+static int checkWorldRoundTrip(const NetSnapshot* snapshot, const NetSnapshot* base) {
+    Uint8 data[4096];
+    BitWriter writer;
+    initBitWriter(&writer, data, sizeof(data));
+    writeWorldDelta(&writer, snapshot, base);
+
+    NetSnapshot decoded;
+    decoded.tick = snapshot->tick;
+    BitReader reader;
+    initBitReader(&reader, data, bitWriterBytes(&writer));
+    readWorldDelta(&reader, &decoded, base);
+    if (writer.overflow || reader.overflow || reader.bits != writer.bits) return 0;
+
+    if (memcmp(decoded.planet_angles + 1, snapshot->planet_angles + 1, sizeof(Uint16) * (NUM_PLANETS - 1)) != 0) return 0;
+    for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+        if (!samePlayerState(&decoded.players[i], &snapshot->players[i])) return 0;
+    }
+    return 1;
+}
+
+static int checkFlagsRoundTrip(const Uint8* flags, const Uint8* base, int count) {
+    Uint8 data[NET_CODEC_MAX_FLAGS / 8 + 64];
+    BitWriter writer;
+    initBitWriter(&writer, data, sizeof(data));
+    writeFlagsDelta(&writer, flags, base, count);
+
+    Uint8 decoded[NET_CODEC_MAX_FLAGS / 8];
+    BitReader reader;
+    initBitReader(&reader, data, bitWriterBytes(&writer));
+    readFlagsDelta(&reader, decoded, base, count);
+    if (writer.overflow || reader.overflow || reader.bits != writer.bits) return 0;
+    return memcmp(decoded, flags, (count + 7) / 8) == 0;
+}
+
+// Sends random snapshots and discovery flags through the codec, against
+// nothing and against a random base, and compares what comes back. Returns
+// the number of rounds that did not.
+int checkSnapshotCodec(Uint32 seed) {
+    Uint32 rng = seed ? seed : 1;
+    static const NetSnapshot nothing = {0};
+    static NetSnapshot base, snapshot;
+    Uint8 no_flags[NET_CODEC_MAX_FLAGS / 8] = {0};
+    Uint8 base_flags[NET_CODEC_MAX_FLAGS / 8], flags[NET_CODEC_MAX_FLAGS / 8];
+    int failed = 0;
+
+    for (int round = 0; round < NET_CODEC_ROUNDS; round++) {
+        // A base as a client joining mid-game would have it, then what came after
+        randomSnapshot(&base, &nothing, 4 * (1 + codecRandom(&rng) % 100000), &rng);
+        randomSnapshot(&snapshot, &base, 4 * (1 + codecRandom(&rng) % 63), &rng);
+
+        int count = 1 + codecRandom(&rng) % NET_CODEC_MAX_FLAGS;
+        randomFlags(base_flags, no_flags, count, codecRandom(&rng) % (count + 1), &rng);
+        // Few flips take the index path, many send every flag
+        int flips = round % 2 ? codecRandom(&rng) % 4 : codecRandom(&rng) % (count + 1);
+        randomFlags(flags, base_flags, count, flips, &rng);
+
+        int ok = checkWorldRoundTrip(&base, &nothing) && checkWorldRoundTrip(&snapshot, &base) &&
+                 checkFlagsRoundTrip(base_flags, no_flags, count) && checkFlagsRoundTrip(flags, base_flags, count);
+        if (!ok && failed++ == 0) printf("Codec check: round %d (seed %u, %d flags) did not decode to what was sent\n", round, seed, count);
+    }
+    return failed;
+}
@@ -0,0 +1,64 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <SDL2/SDL.h>
+#include "init.h"   // World and SimPlayer structures
+#include "net.h"
+
+/*
+            DEFINITIONS
+*/
+#define NET_MAX_PLAYERS 64
+#define NET_POSITION_SCALE 8.0f      // Positions go in 1/8 px
+#define NET_SPEED_SCALE 256.0f       // Speeds in 1/256 px per tick
+#define NET_PLANET_ANGLE_SCALE (65536.0 / (2 * M_PI))   // Orbit angles in 16 bits per turn
+#define NET_CODEC_ROUNDS 256         // Random snapshots checkSnapshotCodec sends through the codec
+#define NET_CODEC_MAX_FLAGS 2048     // Most astral objects it codes the flags of
+
+/*
+            SNAPSHOT STRUCTURES
+*/
+// One player as it goes on the wire. The server rounds its players to this
+// after every tick (quantizeSimPlayer), so a client predicting from a
+// snapshot starts from exactly the state the server has.
+typedef struct {
+    Sint32 x, y;
+    Sint32 speed_x, speed_y;
+    Sint32 angle;                    // Whole degrees, 0 to 359: the controls only turn by whole degrees
+    Sint32 score;
+    Uint8 present;
+    Uint8 thrusting;
+    Uint8 finished;
+} NetPlayerState;
+
+// What every client gets of a server tick. Each one also gets its own
+// discovery flags, packed 8 to a byte, kept next to the snapshot.
+typedef struct {
+    Uint32 tick;                     // 0 for none
+    Uint16 planet_angles[NUM_PLANETS];
+    NetPlayerState players[NET_MAX_PLAYERS];
+} NetSnapshot;
+
+
+/*
+            DECLARATIONS
+*/
+void storePlayerState(NetPlayerState* state, const SimPlayer* player);
+void loadPlayerState(SimPlayer* player, const NetPlayerState* state);
+void quantizeSimPlayer(SimPlayer* player);
+void storePlanetAngles(Uint16 angles[NUM_PLANETS], const BackgroundEffects* world);
+void loadPlanetAngles(BackgroundEffects* world, const Uint16 angles[NUM_PLANETS]);
+
+int discoveryFlagBytes(const BackgroundEffects* world);
+void packDiscoveryFlags(Uint8* flags, const Uint8* discovered, int count);
+void unpackDiscoveryFlags(Uint8* discovered, const Uint8* flags, int count);
+
+void writeWorldDelta(BitWriter* writer, const NetSnapshot* snapshot, const NetSnapshot* base);
+void readWorldDelta(BitReader* reader, NetSnapshot* snapshot, const NetSnapshot* base);
+void writeFlagsDelta(BitWriter* writer, const Uint8* flags, const Uint8* base, int count);
+void readFlagsDelta(BitReader* reader, Uint8* flags, const Uint8* base, int count);
+
+Uint32 hashWorld(const BackgroundEffects* world);
+int checkSnapshotCodec(Uint32 seed);
+
+#endif
@@ -0,0 +1,162 @@
+#include "soundbank.h"
+#include "memtrack.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SOUNDBANK_ALIGN(size) (((size) + MEMTRACK_ALIGN - 1) & ~(size_t)(MEMTRACK_ALIGN - 1))
+#define SOUNDBANK_FRAME (2 * sizeof(float))
+
+// One entry while a bank is built: a decoded file waiting to be converted,
+// or the samples it keeps from the bank being replaced
+typedef struct {
+    const char* path;
+    Uint8* wav;                      // SDL_LoadWAV data, NULL when copied or missing
+    Uint32 length;
+    SDL_AudioCVT cvt;
+    const float* copy;
+    Uint32 copy_frames;
+} SoundSource;
+
+// Decodes the WAV file and prepares its conversion to float stereo at
+// frequency. The sound stays empty (0 frames) on failure.
+static void openSound(SoundSource* source, int frequency) {
+    SDL_AudioSpec spec;
+    if (!SDL_LoadWAV(source->path, &spec, &source->wav, &source->length)) {
+        printf("Warning: Failed to load sound %s: %s\n", source->path, SDL_GetError());
+        source->wav = NULL;
+        return;
+    }
+
+    if (SDL_BuildAudioCVT(&source->cvt, spec.format, spec.channels, spec.freq, AUDIO_F32SYS, 2, frequency) < 0) {
+        printf("Warning: Cannot convert sound %s: %s\n", source->path, SDL_GetError());
+        SDL_FreeWAV(source->wav);
+        source->wav = NULL;
+    }
+}
+
+// Bytes the sound keeps once converted (an upper estimate), and the most the
+// conversion needs while it runs
+static void soundSize(const SoundSource* source, size_t* size, size_t* scratch) {
+    if (!source->wav) {
+        *size = *scratch = source->copy_frames * SOUNDBANK_FRAME;
+        return;
+    }
+    *size = (size_t)(source->length * source->cvt.len_ratio) + SOUNDBANK_SLACK_FRAMES * SOUNDBANK_FRAME;
+    *scratch = SDL_max(*size, (size_t)source->length * source->cvt.len_mult);
+}
+
+// Converts (or copies) the sound to out, inside the bank: SDL_ConvertAudio
+// works in place, there is no intermediate buffer. Returns its frames.
+static Uint32 fillSound(SoundSource* source, float* out, size_t room) {
+    if (!source->wav) {
+        if (source->copy_frames) memcpy(out, source->copy, source->copy_frames * SOUNDBANK_FRAME);
+        return source->copy_frames;
+    }
+
+    Uint32 frames = 0;
+    if ((size_t)source->length * source->cvt.len_mult > room) {
+        printf("Warning: No room to convert sound %s\n", source->path);
+    } else {
+        source->cvt.buf = (Uint8*)out;
+        source->cvt.len = source->length;
+        memcpy(out, source->wav, source->length);
+
+        if (source->cvt.needed && SDL_ConvertAudio(&source->cvt) < 0) {
+            printf("Warning: Cannot convert sound %s: %s\n", source->path, SDL_GetError());
+        } else {
+            frames = (source->cvt.needed ? source->cvt.len_cvt : source->cvt.len) / SOUNDBANK_FRAME;
+            // Rescaled to the 16-bit range the mixer works in
+            for (Uint32 s = 0; s < frames * 2; s++) out[s] *= 32767.0f;
+        }
+    }
+
+    SDL_FreeWAV(source->wav);
+    source->wav = NULL;
+    return frames;
+}
+
+// Sized from the sources: every sound at its estimated size, plus the largest
+// working space a single conversion needs past its own estimate
+static SoundBank* buildSoundBank(SoundSource* sources, int count, int frequency) {
+    size_t header = SOUNDBANK_ALIGN(sizeof(SoundBank) + (size_t)count * sizeof(SoundBankEntry));
+    size_t samples = 0, extra = 0;
+    for (int i = 0; i < count; i++) {
+        size_t size, scratch;
+        soundSize(&sources[i], &size, &scratch);
+        samples += size;
+        extra = SDL_max(extra, scratch - size);
+    }
+
+    SoundBank* bank = memAlloc(header + samples + extra, MEM_AUDIO);
+    if (bank) {
+        bank->count = count;
+        bank->frequency = frequency;
+        bank->pcm = (float*)((char*)bank + header);
+
+        // Back to back: each conversion starts where the previous one ended
+        Uint32 offset = 0;
+        for (int i = 0; i < count; i++) {
+            size_t room = samples + extra - offset * SOUNDBANK_FRAME;
+            Uint32 frames = fillSound(&sources[i], &bank->pcm[offset * 2], room);
+            bank->entries[i] = (SoundBankEntry){ sources[i].path, offset, frames };
+            offset += frames;
+        }
+        bank->total_frames = offset;
+        printf("Sound bank: %d sounds, %.1f KB at %d Hz\n", count, offset * SOUNDBANK_FRAME / 1024.0, frequency);
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (sources[i].wav) SDL_FreeWAV(sources[i].wav);
+    }
+    return bank;
+}
+
+// Missing files keep their slot with 0 frames, so sound ids stay stable.
+// Returns NULL only if the bank itself cannot be allocated.
+SoundBank* loadSoundBank(const char** paths, int count, int frequency) {
+    SoundSource* sources = memCalloc(SDL_max(count, 1), sizeof(SoundSource), MEM_AUDIO);
+    if (!sources) return NULL;
+
+    for (int i = 0; i < count; i++) {
+        sources[i].path = paths[i];
+        openSound(&sources[i], frequency);
+    }
+
+    SoundBank* bank = buildSoundBank(sources, count, frequency);
+    memFree(sources);
+    return bank;
+}
+
+// A new bank with sound taken from replacement (a bank of that one sound,
+// converted on an asset worker) and the others copied from bank, nothing is
+// decoded. Without a bank the others are empty. Returns NULL if it cannot be
+// allocated.
+SoundBank* replaceSoundBankEntry(const SoundBank* bank, const char** paths, int count, int sound, const SoundBank* replacement) {
+    SoundSource* sources = memCalloc(SDL_max(count, 1), sizeof(SoundSource), MEM_AUDIO);
+    if (!sources) return NULL;
+
+    for (int i = 0; i < count; i++) {
+        sources[i].path = paths[i];
+        const SoundBank* from = i == sound ? replacement : bank;
+        int entry = i == sound ? 0 : i;
+        if (from && entry < from->count) {
+            sources[i].copy = &from->pcm[from->entries[entry].offset * 2];
+            sources[i].copy_frames = from->entries[entry].frames;
+        }
+    }
+
+    SoundBank* replaced = buildSoundBank(sources, count, replacement->frequency);
+    memFree(sources);
+    return replaced;
+}
+
+void freeSoundBank(SoundBank* bank) {
+    memFree(bank);
+}
+
+// NULL if the sound is not in the bank or failed to load
+const float* soundBankSamples(const SoundBank* bank, int sound, Uint32* frames) {
+    if (!bank || sound < 0 || sound >= bank->count || bank->entries[sound].frames == 0) return NULL;
+    *frames = bank->entries[sound].frames;
+    return &bank->pcm[bank->entries[sound].offset * 2];
+}
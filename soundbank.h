@@ -0,0 +1,41 @@
+#ifndef SOUNDBANK_H
+#define SOUNDBANK_H
+
+#include <SDL2/SDL.h>
+
+/*
+            DEFINITIONS
+*/
+#define SOUNDBANK_SLACK_FRAMES 64    // Over the converter's length estimate, per sound
+
+/*
+            SOUND BANK STRUCTURES
+*/
+typedef struct {
+    const char* path;
+    Uint32 offset;                   // First frame in pcm
+    Uint32 frames;                   // 0 if the file could not be loaded
+} SoundBankEntry;
+
+// Every effect converted once to the mixer format (interleaved stereo float,
+// 16-bit scale) at the device rate, back to back in one buffer. The bank, its
+// entries and its samples are a single allocation sized from the sound count,
+// freed with freeSoundBank. Files are converted in place inside it.
+typedef struct {
+    int count;
+    int frequency;
+    Uint32 total_frames;
+    float* pcm;                      // Follows the entries in the same block
+    SoundBankEntry entries[];        // count of them
+} SoundBank;
+
+
+/*
+            DECLARATIONS
+*/
+SoundBank* loadSoundBank(const char** paths, int count, int frequency);
+SoundBank* replaceSoundBankEntry(const SoundBank* bank, const char** paths, int count, int sound, const SoundBank* replacement);
+void freeSoundBank(SoundBank* bank);
+const float* soundBankSamples(const SoundBank* bank, int sound, Uint32* frames);
+
+#endif
@@ -1,12 +1,13 @@
 #include "sounds.h"
 #include <stdio.h>
+#include <math.h>
 
 void setMusicVolume(GameResources* resources, float volume) {
     if (!resources) return;
     
     volume = volume < 0.0f ? 0.0f : volume > 1.0f ? 1.0f : volume;
     resources->musicVolume = volume;
-    Mix_VolumeMusic((int)(MIX_MAX_VOLUME * volume));
+    setMusicStreamVolume(&resources->music, volume);
 }
 
 void setSoundEffectsVolume(GameResources* resources, float volume) {
@@ -16,29 +17,41 @@ void setSoundEffectsVolume(GameResources* resources, float volume) {
     resources->soundEffectsVolume = volume;
     
     // Update volume of all currently playing sound effects
-    for (int i = 0; i < Mix_AllocateChannels(-1); i++) {
-        if (Mix_Playing(i)) {
-            Mix_Volume(i, (int)(volume));
-        }
-    }
+    setVoiceVolume(&resources->voices, volume);
 }
 
-void playSound(Mix_Chunk* sound, GameResources* resources) {
-    if (!sound || !resources) return;
+// Queued for the end of the frame (flushSoundEvents), duplicates play once
+void playSound(GameResources* resources, int sound) {
+    if (!resources) return;
+    triggerSound(&resources->voices, sound, 1.0f);
+}
 
-    int volume = (int) (MIX_MAX_VOLUME * resources->soundEffectsVolume);
-    Mix_VolumeChunk(sound, volume);
-    
-    // Use -1 to let SDL_mixer find any available channel
-    int channel = Mix_PlayChannel(-1, sound, 0);
-    
-    if (channel == -1) {
-        // If all channels are busy, try to play on channel 0 (will interrupt)
-        Mix_HaltChannel(0);
-        channel = Mix_PlayChannel(0, sound, 0);
-        
-        if (channel == -1) {
-            printf("Completely failed to play sound: %s\n", Mix_GetError());
-        }
+// World position, heard from the fighter: panned, attenuated, culled when too far
+void playSoundAt(GameResources* resources, int sound, float x, float y) {
+    if (!resources) return;
+    triggerSoundAt(&resources->voices, sound, 1.0f, x, y);
+}
+
+// Once per tick after the game update: the fighter is the listener
+void updateSounds(GameResources* resources, const SimPlayer* player) {
+    setListenerPosition(&resources->voices, player->x, player->y);
+    flushSoundEvents(&resources->voices, resources->soundEffectsVolume);
+}
+
+// Menu track outside the game, in game one track per region of the solar system.
+// Switching is a crossfade on the streaming thread, calling this every frame is cheap.
+void updateMusic(Game* game, GameResources* resources) {
+    int track = resources->menuTrack;
+
+    if (game->screen == GAME) {
+        // Distance from the sun to the center of the screen
+        float x = resources->bg_x + resources->windowWidth / 2;
+        float y = resources->bg_y + resources->windowHeight / 2;
+        track = sqrtf(x * x + y * y) < MUSIC_INNER_RADIUS ? resources->innerTrack : resources->outerTrack;
+
+        // Region track that could not be decoded: stay on the theme
+        if (track < 0 || resources->music.tracks[track].failed) track = resources->menuTrack;
     }
-}
\ No newline at end of file
+
+    if (SDL_AtomicGet(&resources->music.wanted) != track) playMusicTrack(&resources->music, track);
+}
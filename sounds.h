@@ -6,6 +6,9 @@
 
 void setMusicVolume(GameResources* resources, float volume);
 void setSoundEffectsVolume(GameResources* resources, float volume);
-void playSound(Mix_Chunk* sound, GameResources* resources);
+void playSound(GameResources* resources, int sound);
+void playSoundAt(GameResources* resources, int sound, float x, float y);
+void updateSounds(GameResources* resources, const SimPlayer* player);
+void updateMusic(Game* game, GameResources* resources);
 
 #endif
\ No newline at end of file
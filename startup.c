@@ -0,0 +1,175 @@
+#include "startup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct {
+    StartupSpan spans[STARTUP_MAX_SPANS];
+    int count;
+    int depth;
+    int recording;
+    Uint64 origin;
+    SDL_threadID main_thread;
+} trace;
+
+typedef struct {
+    const char* path;
+    double decode_ms;
+    double upload_ms;
+} AssetCost;
+
+// First call in main: everything before it is not measured
+void initStartupTrace() {
+    memset(&trace, 0, sizeof(trace));
+    trace.origin = SDL_GetPerformanceCounter();
+    trace.main_thread = SDL_ThreadID();
+    trace.recording = 1;
+}
+
+static int addSpan(const char* name, const char* category, SDL_threadID thread, Uint64 start, Uint64 end, int depth) {
+    if (!trace.recording || trace.count == STARTUP_MAX_SPANS) return -1;
+
+    StartupSpan* span = &trace.spans[trace.count];
+    snprintf(span->name, STARTUP_NAME_LENGTH, "%s", name);
+    span->category = category;
+    span->thread = thread;
+    span->start = start;
+    span->end = end;
+    span->depth = depth;
+    return trace.count++;
+}
+
+// Main thread only. Returns -1 when not recording, endStartupSpan ignores it.
+int beginStartupSpan(const char* name) {
+    int span = addSpan(name, "init", trace.main_thread, SDL_GetPerformanceCounter(), 0, trace.depth);
+    if (span >= 0) trace.depth++;
+    return span;
+}
+
+void endStartupSpan(int span) {
+    if (span < 0) return;
+    trace.spans[span].end = SDL_GetPerformanceCounter();
+    trace.depth--;
+}
+
+// Called by the loader after an upload, while the trace is recording
+void traceAssetSpans(const Asset* asset) {
+    if (!trace.recording) return;
+
+    if (asset->decode_end > asset->decode_start) {
+        addSpan(asset->path, "decode", asset->decode_thread, asset->decode_start, asset->decode_end, 0);
+    }
+    addSpan(asset->path, "upload", trace.main_thread, asset->upload_start, asset->upload_end, trace.depth);
+}
+
+static double spanMilliseconds(const StartupSpan* span) {
+    return assetMilliseconds(span->start, span->end);
+}
+
+static double traceMicroseconds(Uint64 counter) {
+    return (double)(counter - trace.origin) * 1000000.0 / SDL_GetPerformanceFrequency();
+}
+
+// Chrome tracing uses small integer thread ids: main is 1, workers follow
+static int traceThreadIndex(SDL_threadID thread, SDL_threadID* threads, int* num_threads) {
+    for (int i = 0; i < *num_threads; i++) {
+        if (threads[i] == thread) return i + 1;
+    }
+    threads[*num_threads] = thread;
+    return ++(*num_threads);
+}
+
+static void writeJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\') fputc('\\', file);
+        if ((unsigned char)*text >= 0x20) fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+static void writeStartupTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Warning: Could not write %s\n", path);
+        return;
+    }
+
+    SDL_threadID threads[STARTUP_MAX_SPANS];
+    int num_threads = 0;
+    traceThreadIndex(trace.main_thread, threads, &num_threads);
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"startup\"}}");
+    for (int i = 0; i < trace.count; i++) {
+        StartupSpan* span = &trace.spans[i];
+        int tid = traceThreadIndex(span->thread, threads, &num_threads);
+
+        fprintf(file, ",\n{\"name\":");
+        writeJsonString(file, span->name);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                span->category, traceMicroseconds(span->start), spanMilliseconds(span) * 1000.0, tid);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                i + 1, i == 0 ? "main" : "asset worker");
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+}
+
+static int compareAssetCost(const void* a, const void* b) {
+    const AssetCost* x = a;
+    const AssetCost* y = b;
+    double total_x = x->decode_ms + x->upload_ms;
+    double total_y = y->decode_ms + y->upload_ms;
+    return (total_x < total_y) - (total_x > total_y);
+}
+
+static void printStartupSummary(Uint64 end) {
+    printf("Startup: %.1f ms to the first frame\n", assetMilliseconds(trace.origin, end));
+    for (int i = 0; i < trace.count; i++) {
+        StartupSpan* span = &trace.spans[i];
+        if (strcmp(span->category, "init") != 0) continue;
+        printf("  %*s%-*s %9.2f ms\n", span->depth * 2, "", 44 - span->depth * 2, span->name, spanMilliseconds(span));
+    }
+
+    // Pair each asset's decode and upload spans
+    static AssetCost costs[STARTUP_MAX_SPANS];
+    int num_costs = 0;
+    for (int i = 0; i < trace.count; i++) {
+        StartupSpan* span = &trace.spans[i];
+        int upload = strcmp(span->category, "upload") == 0;
+        if (!upload && strcmp(span->category, "decode") != 0) continue;
+
+        int c = 0;
+        while (c < num_costs && strcmp(costs[c].path, span->name) != 0) c++;
+        if (c == num_costs) costs[num_costs++] = (AssetCost){ span->name, 0, 0 };
+
+        if (upload) costs[c].upload_ms += spanMilliseconds(span);
+        else costs[c].decode_ms += spanMilliseconds(span);
+    }
+    if (num_costs == 0) return;
+
+    qsort(costs, num_costs, sizeof(AssetCost), compareAssetCost);
+    printf("Slowest assets (decode on workers, upload on the main thread):\n");
+    for (int i = 0; i < num_costs && i < STARTUP_SLOWEST_ASSETS; i++) {
+        printf("  %-60s decode %8.2f ms  upload %7.2f ms\n", costs[i].path, costs[i].decode_ms, costs[i].upload_ms);
+    }
+}
+
+// Call once the first frame is on screen: closes any open span, writes the
+// Chrome trace and prints the summary. Later calls do nothing.
+void finishStartupTrace(const char* path) {
+    if (!trace.recording) return;
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    for (int i = 0; i < trace.count; i++) {
+        if (trace.spans[i].end == 0) trace.spans[i].end = end;
+    }
+    trace.recording = 0;
+
+    writeStartupTrace(path);
+    printStartupSummary(end);
+    printf("Startup trace written to %s (%d spans)\n", path, trace.count);
+}
@@ -0,0 +1,40 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <SDL2/SDL.h>
+#include "assets.h"
+
+/*
+            DEFINITIONS
+*/
+#define STARTUP_MAX_SPANS 1024
+#define STARTUP_NAME_LENGTH 128
+#define STARTUP_TRACE_PATH "startup_trace.json"  // Open in chrome://tracing or ui.perfetto.dev
+#define STARTUP_SLOWEST_ASSETS 10
+
+/*
+            TRACE STRUCTURES
+*/
+// Recording starts in main before anything else and stops after the first
+// frame is presented. Spans are only opened and closed on the main thread;
+// asset decode spans are copied from the loader timestamps with the id of
+// the worker that decoded them.
+typedef struct {
+    char name[STARTUP_NAME_LENGTH];
+    const char* category;        // "init", or "decode" / "upload" for an asset
+    SDL_threadID thread;
+    Uint64 start, end;           // Performance counter
+    int depth;                   // Nesting level on the main thread
+} StartupSpan;
+
+
+/*
+            DECLARATIONS
+*/
+void initStartupTrace();
+int beginStartupSpan(const char* name);
+void endStartupSpan(int span);
+void traceAssetSpans(const Asset* asset);
+void finishStartupTrace(const char* path);
+
+#endif
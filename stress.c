@@ -0,0 +1,90 @@
+#include "stress.h"
+#include "game.h"
+#include "memtrack.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRESS_BULLET_W 16
+#define STRESS_BULLET_H 6
+
+// "--name=N" with N > 0, 0 when arg is something else
+static int parseCount(const char* arg, const char* name, int* value) {
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) != 0 || arg[length] != '=') return 0;
+    int n = atoi(arg + length + 1);
+    if (n <= 0) {
+        printf("Warning: %s needs a positive count, got %s\n", name, arg + length + 1);
+        return 1;
+    }
+    *value = n;
+    return 1;
+}
+
+// World sizes and --stress from the command line. Returns 1 if arg was one of them.
+int parseWorldArgument(const char* arg, WorldConfig* config, int* stress_frames) {
+    int objects = 0;
+    if (strcmp(arg, "--stress") == 0) {
+        *stress_frames = STRESS_FRAMES;
+        return 1;
+    }
+    if (parseCount(arg, "--stress", stress_frames)) return 1;
+    if (parseCount(arg, "--stars", &config->num_stars)) return 1;
+    if (parseCount(arg, "--radius", &config->starfield_radius)) return 1;
+    if (parseCount(arg, "--bullets", &config->max_bullets)) return 1;
+    if (parseCount(arg, "--objects", &objects)) {
+        if (objects > 0) setAstralObjectCount(config, objects);
+        return 1;
+    }
+    return 0;
+}
+
+void initStressRun(StressRun* run, int frames) {
+    memset(run, 0, sizeof(*run));
+    run->frames = frames;
+}
+
+// After updateGameState: the camera and the bullets are overridden every frame
+void updateStressRun(StressRun* run, FramePacer* pacer, Game* game, Fighter* fighter, GameResources* resources,
+                     const BackgroundEffects* bg_effects, int* quit) {
+    if (!run->frames) return;
+
+    // The fighter flies a 3:2 Lissajous curve, as if the simulation ran at FPS.
+    // It still discovers what it passes over.
+    float t = run->frame * 2.0f * (float)M_PI / (STRESS_PATH_SECONDS * FPS);
+    float extent = bg_effects->config.starfield_radius * STRESS_PATH_SCALE;
+    game->player.x = sinf(3.0f * t) * extent;
+    game->player.y = sinf(2.0f * t) * extent;
+    game->player.speed_x = game->player.speed_y = 0;
+    followPlayer(resources, fighter, &game->player);
+
+    // Kept full, whatever removed some comes back anywhere on screen
+    while (game->numBullets < game->maxBullets) {
+        game->bullets[game->numBullets++] = (SDL_Rect){
+            rand() % SDL_max(resources->windowWidth, 1), rand() % SDL_max(resources->windowHeight, 1),
+            STRESS_BULLET_W, STRESS_BULLET_H
+        };
+    }
+
+    run->frame++;
+    if (run->frame == STRESS_WARMUP_FRAMES) resetFrameStats(pacer);
+    if (run->frame >= run->frames + STRESS_WARMUP_FRAMES) *quit = 1;
+}
+
+void printStressReport(const StressRun* run, const FramePacer* pacer, const BackgroundEffects* bg_effects, const Game* game) {
+    if (!run->frames) return;
+
+    FrameStats stats;
+    getFrameStats(pacer, &stats);
+    printf("Stress run: %d stars, %d astral objects, %d bullets, %d px radius\n",
+           bg_effects->num_stars, bg_effects->num_astral_objects, game->maxBullets, bg_effects->config.starfield_radius);
+    if (stats.frames == 0 || stats.average_ms <= 0.0) {
+        printf("Stress run: no frames measured (quit during the warmup)\n");
+    } else {
+        printf("Stress run: %llu frames, %.1f fps average, frame ms p50 %.2f p95 %.2f p99 %.2f max %.2f\n",
+               (unsigned long long)stats.frames, 1000.0 / stats.average_ms,
+               stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms);
+    }
+    printMemoryReport();
+}
@@ -0,0 +1,38 @@
+#ifndef STRESS_H
+#define STRESS_H
+
+#include <SDL2/SDL.h>
+#include "init.h"
+#include "pacer.h"
+
+/*
+            DEFINITIONS
+*/
+#define STRESS_FRAMES 3000           // --stress without a count
+#define STRESS_WARMUP_FRAMES 120     // Texture loads and the first touches of the world, not timed
+#define STRESS_PATH_SECONDS 60.0f    // One full loop of the camera path
+#define STRESS_PATH_SCALE 0.8f       // Of the starfield radius
+
+/*
+            STRESS STRUCTURES
+*/
+// --stress: the world is scaled up (see initWorldConfig), the camera flies a
+// fixed Lissajous path over the starfield and the bullets are kept full, then
+// the run quits and reports the frame times and memory. The path only depends
+// on the frame number, so two runs on the same machine see the same frames.
+typedef struct {
+    int frames;                      // 0 when off
+    int frame;
+} StressRun;
+
+
+/*
+            DECLARATIONS
+*/
+int parseWorldArgument(const char* arg, WorldConfig* config, int* stress_frames);
+void initStressRun(StressRun* run, int frames);
+void updateStressRun(StressRun* run, FramePacer* pacer, Game* game, Fighter* fighter, GameResources* resources,
+                     const BackgroundEffects* bg_effects, int* quit);
+void printStressReport(const StressRun* run, const FramePacer* pacer, const BackgroundEffects* bg_effects, const Game* game);
+
+#endif
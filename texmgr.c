@@ -0,0 +1,215 @@
+#include "texmgr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void initTextureManager(TextureManager* tm, AssetLoader* loader, size_t budget) {
+    memset(tm, 0, sizeof(*tm));
+    tm->loader = loader;
+    tm->budget = budget;
+    tm->count = 1; // handle 0 is reserved for "no texture"
+}
+
+static void unloadTexture(TextureManager* tm, TextureEntry* entry) {
+    if (!entry->texture) return;
+
+    destroyTrackedTexture(entry->texture);
+    entry->texture = NULL;
+    tm->resident_bytes -= entry->bytes;
+    tm->resident_count--;
+    entry->bytes = 0;
+}
+
+void destroyTextureManager(TextureManager* tm) {
+    for (int i = 1; i < tm->count; i++) {
+        unloadTexture(tm, &tm->entries[i]);
+    }
+}
+
+// Same path registered twice returns the same handle
+TextureHandle registerTexture(TextureManager* tm, TextureDesc desc) {
+    TextureHandle existing = findTexture(tm, desc.path);
+    if (existing) return existing;
+
+    if (tm->count == TEXMGR_MAX) {
+        printf("Error: Too many textures, raise TEXMGR_MAX (%s)\n", desc.path);
+        exit(1);
+    }
+
+    TextureHandle handle = tm->count++;
+    TextureEntry* entry = &tm->entries[handle];
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->path, desc.path, PAK_PATH_LENGTH - 1);
+    entry->desc = desc;
+    entry->desc.path = entry->path;
+    return handle;
+}
+
+void acquireTexture(TextureManager* tm, TextureHandle handle) {
+    if (handle <= 0 || handle >= tm->count) return;
+    tm->entries[handle].refcount++;
+}
+
+void releaseTexture(TextureManager* tm, TextureHandle handle) {
+    if (handle <= 0 || handle >= tm->count) return;
+    if (tm->entries[handle].refcount > 0) tm->entries[handle].refcount--;
+}
+
+// Render thread, called by the asset loader once the texture exists
+static void onTextureReady(Asset* asset, void* object) {
+    TextureManager* tm = asset->userdata;
+    TextureEntry* entry = &tm->entries[asset->user_index];
+    SDL_Texture* texture = object;
+
+    entry->loading = 0;
+    if (!texture) {
+        if (entry->texture) printf("Warning: Reload of %s failed, keeping the old texture\n", entry->path);
+        else entry->failed = 1;
+        return;
+    }
+
+    unloadTexture(tm, entry);
+
+    int w, h;
+    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+    trackTexture(texture, entry->desc.category);
+    entry->texture = texture;
+    entry->bytes = (size_t)w * h * 4;
+    entry->size = asset->logical_size;
+    entry->last_used = tm->frame; // don't evict it before it had a chance to be drawn
+
+    tm->resident_bytes += entry->bytes;
+    tm->resident_count++;
+    if (tm->resident_bytes > tm->peak_bytes) tm->peak_bytes = tm->resident_bytes;
+    tm->loads++;
+}
+
+static void queueTextureLoad(TextureManager* tm, TextureHandle handle, int with_fallback) {
+    TextureEntry* entry = &tm->entries[handle];
+    entry->loading = 1;
+    queueAsset(tm->loader, (Asset){
+        .kind = ASSET_TEXTURE,
+        .path = entry->path,
+        .on_ready = onTextureReady,
+        .userdata = tm,
+        .user_index = handle,
+        // Only the first load: an evicted texture that can no longer be read
+        // comes back as its placeholder rather than ending the game
+        .required = with_fallback && (entry->desc.flags & TEXTURE_REQUIRED) && entry->size.x <= 0,
+        .blend = entry->desc.flags & TEXTURE_BLEND,
+        .fallback_w = with_fallback ? entry->desc.fallback_w : 0,
+        .fallback_h = with_fallback ? entry->desc.fallback_h : 0,
+        .fallback_color = entry->desc.fallback_color
+    });
+}
+
+// Starts decoding in the background if the texture is not resident
+void requestTexture(TextureManager* tm, TextureHandle handle) {
+    if (handle <= 0 || handle >= tm->count) return;
+
+    TextureEntry* entry = &tm->entries[handle];
+    if (entry->texture || entry->loading || entry->failed) return;
+
+    queueTextureLoad(tm, handle, 1);
+}
+
+// The file changed on disk: decode it again, the old texture stays on screen
+// until the new one is uploaded. A bad file keeps the old texture.
+void reloadTexture(TextureManager* tm, TextureHandle handle) {
+    if (handle <= 0 || handle >= tm->count) return;
+
+    TextureEntry* entry = &tm->entries[handle];
+    entry->failed = 0;
+    if (!entry->texture) return; // not resident, the next request reads the new file
+
+    queueTextureLoad(tm, handle, 0);
+    tm->reloads++;
+}
+
+// 0 if the path was never registered
+TextureHandle findTexture(TextureManager* tm, const char* path) {
+    for (int i = 1; i < tm->count; i++) {
+        if (strcmp(tm->entries[i].path, path) == 0) return i;
+    }
+    return 0;
+}
+
+// Returns NULL (and starts loading) when the texture is not resident:
+// callers skip drawing it this frame.
+SDL_Texture* getTexture(TextureManager* tm, TextureHandle handle) {
+    if (handle <= 0 || handle >= tm->count) return NULL;
+
+    TextureEntry* entry = &tm->entries[handle];
+    if (entry->texture) {
+        entry->last_used = tm->frame;
+        tm->hits++;
+        return entry->texture;
+    }
+
+    if (!entry->failed) {
+        tm->misses++;
+        tm->frame_misses++;
+        requestTexture(tm, handle);
+    }
+    return NULL;
+}
+
+// Source image size (what draw sizes are computed from), known once the
+// texture has been loaded. Returns 0 before that, without starting a load:
+// off-screen objects can be sized without bringing their texture in.
+int getTextureSize(TextureManager* tm, TextureHandle handle, int* w, int* h) {
+    if (handle <= 0 || handle >= tm->count) return 0;
+
+    TextureEntry* entry = &tm->entries[handle];
+    if (entry->size.x <= 0) return 0;
+
+    *w = entry->size.x;
+    *h = entry->size.y;
+    return 1;
+}
+
+// Least recently used texture that may go: unreferenced ones first, then
+// referenced ones idle for TEXMGR_IDLE_FRAMES. Never pinned or drawn this frame.
+static TextureEntry* findEvictionCandidate(TextureManager* tm) {
+    TextureEntry* best = NULL;
+    int best_referenced = 1;
+
+    for (int i = 1; i < tm->count; i++) {
+        TextureEntry* entry = &tm->entries[i];
+        if (!entry->texture || (entry->desc.flags & TEXTURE_PINNED)) continue;
+        if (entry->last_used >= tm->frame) continue;
+
+        int referenced = entry->refcount > 0;
+        if (referenced && tm->frame - entry->last_used < TEXMGR_IDLE_FRAMES) continue;
+
+        if (!best || referenced < best_referenced ||
+            (referenced == best_referenced && entry->last_used < best->last_used)) {
+            best = entry;
+            best_referenced = referenced;
+        }
+    }
+    return best;
+}
+
+// Call once per frame after presenting
+void endTextureFrame(TextureManager* tm) {
+    while (tm->resident_bytes > tm->budget) {
+        TextureEntry* victim = findEvictionCandidate(tm);
+        if (!victim) break; // everything left is in use, stay over budget
+
+        unloadTexture(tm, victim);
+        tm->evictions++;
+    }
+
+    tm->frame++;
+    tm->frame_misses = 0;
+}
+
+void printTextureStats(TextureManager* tm) {
+    printf("Textures: %d/%d resident, %.1f MB (peak %.1f MB, budget %.1f MB)\n",
+           tm->resident_count, tm->count - 1,
+           tm->resident_bytes / (1024.0 * 1024.0), tm->peak_bytes / (1024.0 * 1024.0), tm->budget / (1024.0 * 1024.0));
+    printf("Textures: %llu hits, %llu misses, %llu loads, %llu evictions, %llu reloads\n",
+           (unsigned long long)tm->hits, (unsigned long long)tm->misses,
+           (unsigned long long)tm->loads, (unsigned long long)tm->evictions, (unsigned long long)tm->reloads);
+}
@@ -0,0 +1,85 @@
+#ifndef TEXMGR_H
+#define TEXMGR_H
+
+#include <SDL2/SDL.h>
+#include "assets.h"
+#include "memtrack.h"
+
+/*
+            DEFINITIONS
+*/
+#define TEXMGR_MAX 256                              // Registered textures
+#define TEXMGR_DEFAULT_BUDGET (256u * 1024 * 1024)  // Resident texture bytes before eviction
+#define TEXMGR_IDLE_FRAMES 120                      // Referenced textures unused this long can be evicted
+#define TEXMGR_UPLOAD_BUDGET 2.0f                   // ms of texture creation per game frame
+
+// Texture flags
+#define TEXTURE_BLEND    0x1   // SDL_BLENDMODE_BLEND
+#define TEXTURE_REQUIRED 0x2   // Abort if it cannot be loaded
+#define TEXTURE_PINNED   0x4   // Never evicted (UI, always on screen)
+
+typedef int TextureHandle;     // 0 is "no texture"
+
+/*
+            TEXTURE MANAGER STRUCTURES
+*/
+typedef struct {
+    const char* path;
+    int flags;
+    TextureCategory category;    // Memory report bucket
+    int fallback_w, fallback_h;  // Placeholder when the file is missing (0: none)
+    SDL_Color fallback_color;
+} TextureDesc;
+
+typedef struct {
+    char path[PAK_PATH_LENGTH];
+    TextureDesc desc;            // desc.path points to path above
+    SDL_Texture* texture;        // NULL while not resident
+    SDL_Point size;              // Source image size, known after the first load
+    size_t bytes;                // Estimated VRAM use while resident
+    int refcount;
+    int loading;                 // A decode is in flight
+    int failed;                  // Missing file without placeholder, don't retry
+    Uint64 last_used;            // Frame of the last getTexture
+} TextureEntry;
+
+typedef struct {
+    TextureEntry entries[TEXMGR_MAX];  // Handle = index, entry 0 unused
+    int count;
+    AssetLoader* loader;
+
+    size_t budget;
+    size_t resident_bytes;
+    size_t peak_bytes;
+    int resident_count;
+    Uint64 frame;
+
+    // Counters (since init)
+    Uint64 hits;
+    Uint64 misses;
+    Uint64 loads;
+    Uint64 evictions;
+    Uint64 reloads;              // Files changed on disk (hot reload)
+    int frame_misses;            // Misses during the current frame
+} TextureManager;
+
+
+/*
+            DECLARATIONS
+*/
+void initTextureManager(TextureManager* tm, AssetLoader* loader, size_t budget);
+void destroyTextureManager(TextureManager* tm);
+TextureHandle registerTexture(TextureManager* tm, TextureDesc desc);
+TextureHandle findTexture(TextureManager* tm, const char* path);
+
+void acquireTexture(TextureManager* tm, TextureHandle handle);
+void releaseTexture(TextureManager* tm, TextureHandle handle);
+void requestTexture(TextureManager* tm, TextureHandle handle);
+void reloadTexture(TextureManager* tm, TextureHandle handle);
+SDL_Texture* getTexture(TextureManager* tm, TextureHandle handle);
+int getTextureSize(TextureManager* tm, TextureHandle handle, int* w, int* h);
+
+void endTextureFrame(TextureManager* tm);
+void printTextureStats(TextureManager* tm);
+
+#endif
@@ -0,0 +1,174 @@
+// Packs the images listed in data/assets.list into one archive of pre-decoded
+// RGBA pixels at draw resolution (see pak.h for the layout).
+// Usage: packassets.out <list> <archive>
+#include "pak.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PAK_MAX_ENTRIES 256
+
+typedef struct {
+    PakEntry entry;
+    Uint8* pixels;
+} PackedImage;
+
+// Fits (w, h) inside (max_w, max_h) keeping the aspect ratio, never upscales
+static void fitSize(int w, int h, int max_w, int max_h, int* out_w, int* out_h) {
+    float scale = 1.0f;
+    if (max_w > 0 && w > max_w) scale = (float)max_w / w;
+    if (max_h > 0 && h * scale > max_h) scale = (float)max_h / h;
+
+    *out_w = SDL_max(1, (int)(w * scale + 0.5f));
+    *out_h = SDL_max(1, (int)(h * scale + 0.5f));
+}
+
+// Box filter with alpha weighting, so transparent pixels don't darken the edges
+static Uint8* downsample(SDL_Surface* src, int dst_w, int dst_h) {
+    Uint8* dst = malloc((size_t)dst_w * dst_h * 4);
+    if (!dst) return NULL;
+
+    for (int y = 0; y < dst_h; y++) {
+        int y0 = y * src->h / dst_h;
+        int y1 = SDL_max((y + 1) * src->h / dst_h, y0 + 1);
+
+        for (int x = 0; x < dst_w; x++) {
+            int x0 = x * src->w / dst_w;
+            int x1 = SDL_max((x + 1) * src->w / dst_w, x0 + 1);
+            Uint64 r = 0, g = 0, b = 0, a = 0, n = 0;
+
+            for (int sy = y0; sy < y1; sy++) {
+                const Uint8* row = (const Uint8*)src->pixels + sy * src->pitch;
+                for (int sx = x0; sx < x1; sx++) {
+                    const Uint8* p = &row[sx * 4];
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                    n++;
+                }
+            }
+
+            Uint8* out = &dst[(y * dst_w + x) * 4];
+            out[0] = a ? r / a : 0;
+            out[1] = a ? g / a : 0;
+            out[2] = a ? b / a : 0;
+            out[3] = a / n;
+        }
+    }
+    return dst;
+}
+
+static int packImage(const char* path, int max_w, int max_h, PackedImage* image) {
+    SDL_Surface* loaded = IMG_Load(path);
+    if (!loaded) {
+        printf("Warning: skipping %s: %s\n", path, IMG_GetError());
+        return 0;
+    }
+
+    // SDL_CreateTextureFromSurface blends these, the game does the same for packed ones
+    int alpha = loaded->format->Amask != 0 || SDL_HasColorKey(loaded);
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!rgba) {
+        printf("Warning: skipping %s: %s\n", path, SDL_GetError());
+        return 0;
+    }
+
+    int w, h;
+    fitSize(rgba->w, rgba->h, max_w, max_h, &w, &h);
+
+    memset(image, 0, sizeof(*image));
+    strncpy(image->entry.path, path, PAK_PATH_LENGTH - 1);
+    image->entry.width = w;
+    image->entry.height = h;
+    image->entry.logical_w = rgba->w;
+    image->entry.logical_h = rgba->h;
+    image->entry.size = (Uint64)w * h * 4;
+    image->entry.flags = alpha ? PAK_ALPHA : 0;
+
+    SDL_LockSurface(rgba);
+    image->pixels = downsample(rgba, w, h);
+    SDL_UnlockSurface(rgba);
+    SDL_FreeSurface(rgba);
+
+    if (!image->pixels) return 0;
+    printf("  %-70s %5dx%-5d -> %4dx%-4d\n", path, image->entry.logical_w, image->entry.logical_h, w, h);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        printf("Usage: %s <asset list> <archive>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* list = fopen(argv[1], "r");
+    if (!list) {
+        printf("Error: cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    SDL_Init(0);
+    IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+
+    static PackedImage images[PAK_MAX_ENTRIES];
+    int count = 0;
+    char line[512];
+
+    while (fgets(line, sizeof(line), list)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0') continue;
+
+        // max_w max_h path (the path is the rest of the line, it may contain spaces)
+        int max_w, max_h, consumed;
+        if (sscanf(line, "%d %d %n", &max_w, &max_h, &consumed) != 2 || line[consumed] == '\0') {
+            printf("Warning: bad line in %s: %s\n", argv[1], line);
+            continue;
+        }
+        if (count == PAK_MAX_ENTRIES) {
+            printf("Error: more than %d images\n", PAK_MAX_ENTRIES);
+            return 1;
+        }
+
+        if (packImage(&line[consumed], max_w, max_h, &images[count])) count++;
+    }
+    fclose(list);
+
+    // Lay the blobs out after the index, each on a PAK_ALIGN boundary
+    Uint64 offset = sizeof(PakHeader) + (Uint64)count * sizeof(PakEntry);
+    for (int i = 0; i < count; i++) {
+        offset = (offset + PAK_ALIGN - 1) / PAK_ALIGN * PAK_ALIGN;
+        images[i].entry.offset = offset;
+        offset += images[i].entry.size;
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (!out) {
+        printf("Error: cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    PakHeader header = {{'F', 'P', 'A', 'K'}, PAK_VERSION, count, 0};
+    fwrite(&header, sizeof(header), 1, out);
+    for (int i = 0; i < count; i++) {
+        fwrite(&images[i].entry, sizeof(PakEntry), 1, out);
+    }
+
+    static const Uint8 padding[PAK_ALIGN];
+    for (int i = 0; i < count; i++) {
+        long position = ftell(out);
+        fwrite(padding, 1, images[i].entry.offset - position, out);
+        fwrite(images[i].pixels, 1, images[i].entry.size, out);
+        free(images[i].pixels);
+    }
+
+    printf("Packed %d images into %s (%.1f MB)\n", count, argv[2], ftell(out) / (1024.0 * 1024.0));
+    fclose(out);
+
+    IMG_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "ui.h"
+#include "memtrack.h"
+
+// Rows stack up from the bottom of the screen, the last item lowest
+static void layoutMenuList(MenuListItem* items, int count, int height) {
+    int y = height - MENU_LINE_HEIGHT - MENU_MARGIN_RIGHT;
+
+    for (int i = count - 1; i >= 0; i--) {
+        MenuListItem* item = &items[i];
+        int x = MENU_MARGIN_RIGHT;
+        item->bounds = (SDL_Rect){ x, y, item->w, item->h };
+        item->value = (SDL_Rect){ 0, 0, 0, 0 };
+
+        switch (item->type) {
+            case TYPE_BUTTON:
+                item->control = item->bounds;
+                item->label = (SDL_Rect){ x + 5, y + 5, item->w - 5, item->h - 5 };
+                break;
+
+            case TYPE_CHECKBOX: {
+                int box = min(item->h, item->checkbox.boxSize);
+                item->control = (SDL_Rect){ x + MENU_OFFSET, y, box, box };
+                item->label = (SDL_Rect){ x, y + 5, item->w - item->checkbox.boxSize - 5, item->h - 5 };
+                break;
+            }
+
+            case TYPE_SLIDER:
+                item->control = (SDL_Rect){ x + MENU_OFFSET, y, item->slider.length, item->slider.innerHeight };
+                item->label = (SDL_Rect){ x, y, MENU_OFFSET, item->h };
+                item->value = (SDL_Rect){ x + MENU_OFFSET + item->slider.length, y, 40, 20 };
+                break;
+        }
+
+        y -= MENU_LINE_HEIGHT;
+    }
+}
+
+// On init and when the window size changes. The menu layer is recreated at
+// the new size on its next draw.
+void layoutUI(UIElements* ui, int width, int height) {
+    ui->titleRect = (SDL_Rect){ (width - 400) / 2, 30, 400, 60 };
+    ui->pauseButtonRect = (SDL_Rect){ width - 50 - MENU_MARGIN_RIGHT, 10, 50, 50 };
+    ui->scoreRect = (SDL_Rect){ MENU_MARGIN_RIGHT, 10, MENU_OFFSET, 50 };
+
+    layoutMenuList(ui->menuButtons, ui->nbMenuButtons, height);
+    layoutMenuList(ui->optionsButtons, ui->nbOptionsButtons, height);
+
+    if (ui->menuLayer && (width != ui->layoutWidth || height != ui->layoutHeight)) {
+        destroyTrackedTexture(ui->menuLayer);
+        ui->menuLayer = NULL;
+    }
+    ui->layoutWidth = width;
+    ui->layoutHeight = height;
+    ui->menuLayerDirty = 1;
+}
+
+// Index of the row under the point, -1 if none
+int hitTestMenuList(const MenuListItem* items, int count, int x, int y) {
+    for (int i = 0; i < count; i++) {
+        const SDL_Rect* r = &items[i].bounds;
+        if (x >= r->x && x <= r->x + r->w && y >= r->y && y <= r->y + r->h) return i;
+    }
+    return -1;
+}
+
+// Slider position under x, clamped to 0..1
+float sliderValueAt(const MenuListItem* item, int x) {
+    return min(max((float)(x - item->control.x) / item->control.w, 0.0f), 1.0f);
+}
+
+void setMenuHover(UIElements* ui, MenuListItem* item, int hovering) {
+    if (item->isHovering == hovering) return;
+    item->isHovering = hovering;
+    ui->menuLayerDirty = 1;
+}
+
+// After changing what a menu item shows (slider, checkbox)
+void markMenuDirty(UIElements* ui) {
+    ui->menuLayerDirty = 1;
+}
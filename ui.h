@@ -0,0 +1,16 @@
+#ifndef UI_H
+#define UI_H
+
+#include <SDL2/SDL.h>
+#include "init.h"  // Needs UIElements and MenuListItem
+
+/*
+            DECLARATIONS
+*/
+void layoutUI(UIElements* ui, int width, int height);
+int hitTestMenuList(const MenuListItem* items, int count, int x, int y);
+float sliderValueAt(const MenuListItem* item, int x);
+void setMenuHover(UIElements* ui, MenuListItem* item, int hovering);
+void markMenuDirty(UIElements* ui);
+
+#endif
@@ -0,0 +1,283 @@
+#include "voices.h"
+#include <SDL2/SDL_mixer.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+void initVoiceManager(VoiceManager* vm) {
+    memset(vm, 0, sizeof(*vm));
+    vm->volume = 1.0f;
+    for (int i = 0; i < VOICE_CHANNELS; i++) vm->voices[i].sound = -1;
+
+    // SDL_mixer only plays the music hook now, effects are mixed by us
+    Mix_AllocateChannels(0);
+    initSfxMixer(&vm->mixer);
+}
+
+void shutdownVoiceManager(VoiceManager* vm) {
+    shutdownSfxMixer(&vm->mixer); // frees the bank
+    vm->bank = NULL;
+    printVoiceStats(vm);
+    printSfxStats(&vm->mixer);
+}
+
+// Returns the sound id for triggerSound, -1 if the table is full.
+// Nothing is loaded before loadSounds.
+int registerSound(VoiceManager* vm, const char* path, int priority, int max_voices) {
+    if (vm->num_sounds == VOICE_MAX_SOUNDS) {
+        printf("Warning: Too many sounds, raise VOICE_MAX_SOUNDS\n");
+        return -1;
+    }
+
+    vm->sounds[vm->num_sounds] = (SoundDef){
+        .path = path,
+        .priority = priority,
+        .max_voices = max_voices > 0 ? max_voices : 1
+    };
+    return vm->num_sounds++;
+}
+
+// -1 if the path was never registered
+int findSound(VoiceManager* vm, const char* path) {
+    for (int i = 0; i < vm->num_sounds; i++) {
+        if (strcmp(vm->sounds[i].path, path) == 0) return i;
+    }
+    return -1;
+}
+
+// Converts every registered sound into one bank for the mixer
+void loadSounds(VoiceManager* vm) {
+    if (!vm->mixer.enabled) return;
+
+    const char* paths[VOICE_MAX_SOUNDS];
+    for (int i = 0; i < vm->num_sounds; i++) paths[i] = vm->sounds[i].path;
+
+    SoundBank* bank = loadSoundBank(paths, vm->num_sounds, vm->mixer.frequency);
+    if (bank && setSfxBank(&vm->mixer, bank)) vm->bank = bank;
+}
+
+// Render thread: the reloaded sound came back converted, the new bank copies
+// the others from the current one. Playing voices keep going.
+static void onSoundDecoded(Asset* asset, void* object) {
+    VoiceManager* vm = asset->userdata;
+    SoundBank* decoded = object;
+    int sound = asset->user_index;
+    if (!decoded) return;
+
+    // Edited again meanwhile, a newer decode is on its way
+    if (asset->queued_at != vm->reload_queued[sound]) {
+        freeSoundBank(decoded);
+        return;
+    }
+
+    const char* paths[VOICE_MAX_SOUNDS];
+    for (int i = 0; i < vm->num_sounds; i++) paths[i] = vm->sounds[i].path;
+    SoundBank* bank = replaceSoundBankEntry(vm->bank, paths, vm->num_sounds, sound, decoded);
+    freeSoundBank(decoded);
+    if (bank && setSfxBank(&vm->mixer, bank)) vm->bank = bank;
+}
+
+// The file changed on disk: only that sound is decoded again, on the asset
+// workers. The current bank plays until it comes back.
+void reloadSound(VoiceManager* vm, AssetLoader* loader, int sound) {
+    if (!vm->mixer.enabled || sound < 0 || sound >= vm->num_sounds) return;
+
+    int index = queueAsset(loader, (Asset){
+        .kind = ASSET_SOUND,
+        .path = vm->sounds[sound].path,
+        .on_ready = onSoundDecoded,
+        .userdata = vm,
+        .user_index = sound,
+        .frequency = vm->mixer.frequency
+    });
+    vm->reload_queued[sound] = loader->assets[index].queued_at;
+}
+
+// 1 inside VOICE_NEAR_DISTANCE, 0 at VOICE_AUDIBLE_RANGE and beyond
+static float emitterAttenuation(VoiceManager* vm, const SoundEmitter* emitter) {
+    if (!emitter->positional) return 1.0f;
+
+    float dx = emitter->x - vm->listener_x;
+    float dy = emitter->y - vm->listener_y;
+    float distance = sqrtf(dx * dx + dy * dy);
+    if (distance <= VOICE_NEAR_DISTANCE) return 1.0f;
+    if (distance >= VOICE_AUDIBLE_RANGE) return 0.0f;
+
+    float t = 1.0f - (distance - VOICE_NEAR_DISTANCE) / (VOICE_AUDIBLE_RANGE - VOICE_NEAR_DISTANCE);
+    return t * t;
+}
+
+// Equal-power pan, scaled so a centered emitter plays both sides at full level
+static void emitterPan(VoiceManager* vm, const SoundEmitter* emitter, float* left, float* right) {
+    if (!emitter->positional) {
+        *left = *right = 1.0f;
+        return;
+    }
+
+    float pan = (emitter->x - vm->listener_x) / VOICE_PAN_WIDTH;
+    pan = pan < -1.0f ? -1.0f : pan > 1.0f ? 1.0f : pan;
+    float angle = (pan + 1.0f) * (float)M_PI / 4;
+    *left = fminf(1.0f, cosf(angle) * (float)M_SQRT2);
+    *right = fminf(1.0f, sinf(angle) * (float)M_SQRT2);
+}
+
+static void addTrigger(VoiceManager* vm, int sound, float gain, SoundEmitter emitter) {
+    if (sound < 0 || sound >= vm->num_sounds) return;
+
+    gain = gain < 0.0f ? 0.0f : gain > 1.0f ? 1.0f : gain;
+    vm->triggered++;
+
+    // Duplicates this frame: the loudest one (gain and distance) is kept
+    if (vm->pending[sound]++ > 0) {
+        vm->merged++;
+        float kept = vm->pending_gain[sound] * emitterAttenuation(vm, &vm->pending_emitter[sound]);
+        if (gain * emitterAttenuation(vm, &emitter) <= kept) return;
+    }
+    vm->pending_gain[sound] = gain;
+    vm->pending_emitter[sound] = emitter;
+}
+
+// Cheap, call it as often as the game wants: nothing plays before the flush
+void triggerSound(VoiceManager* vm, int sound, float gain) {
+    addTrigger(vm, sound, gain, (SoundEmitter){ 0 });
+}
+
+// At a world position, panned and attenuated relative to the listener
+void triggerSoundAt(VoiceManager* vm, int sound, float gain, float x, float y) {
+    addTrigger(vm, sound, gain, (SoundEmitter){ 1, x, y });
+}
+
+// Once per tick before the flush, usually the fighter center in world coordinates
+void setListenerPosition(VoiceManager* vm, float x, float y) {
+    vm->listener_x = x;
+    vm->listener_y = y;
+}
+
+// Setting, trigger gain, distance and pan folded into one gain per side
+static void voiceGains(VoiceManager* vm, const Voice* voice, float* left, float* right) {
+    float gain = vm->volume * voice->gain * emitterAttenuation(vm, &voice->emitter);
+    emitterPan(vm, &voice->emitter, left, right);
+    *left *= gain;
+    *right *= gain;
+}
+
+// Sends the voice gains to the mixer if they moved enough to be heard
+static void applyVoice(VoiceManager* vm, int channel) {
+    Voice* voice = &vm->voices[channel];
+    float left, right;
+    voiceGains(vm, voice, &left, &right);
+
+    if (fabsf(left - voice->applied_left) > 0.001f || fabsf(right - voice->applied_right) > 0.001f) {
+        setSfxGain(&vm->mixer, channel, left, right);
+        voice->applied_left = left;
+        voice->applied_right = right;
+    }
+}
+
+// Channel to start sound on, -1 to drop it
+static int pickChannel(VoiceManager* vm, int sound) {
+    SoundDef* def = &vm->sounds[sound];
+
+    // Too many of this sound already: restart its oldest instance
+    int instances = 0, oldest_instance = -1;
+    for (int i = 0; i < VOICE_CHANNELS; i++) {
+        if (vm->voices[i].sound != sound) continue;
+        instances++;
+        if (oldest_instance < 0 || vm->voices[i].started < vm->voices[oldest_instance].started) oldest_instance = i;
+    }
+    if (instances >= def->max_voices) return oldest_instance;
+
+    // Free channel, otherwise the lowest priority voice, the oldest among equals
+    int victim = -1;
+    for (int i = 0; i < VOICE_CHANNELS; i++) {
+        Voice* voice = &vm->voices[i];
+        if (voice->sound < 0) return i;
+
+        if (victim < 0 || voice->priority < vm->voices[victim].priority ||
+            (voice->priority == vm->voices[victim].priority && voice->started < vm->voices[victim].started)) {
+            victim = i;
+        }
+    }
+    return vm->voices[victim].priority <= def->priority ? victim : -1;
+}
+
+// Once per frame, after the game update. volume is the sound effects setting (0 to 1).
+void flushSoundEvents(VoiceManager* vm, float volume) {
+    if (!vm->mixer.enabled) return;
+    vm->volume = volume;
+
+    // Forget the voices that finished
+    for (int i = 0; i < VOICE_CHANNELS; i++) {
+        if (vm->voices[i].sound >= 0 && !sfxVoicePlaying(&vm->mixer, i)) vm->voices[i].sound = -1;
+    }
+
+    // Pending sounds, highest priority first
+    int order[VOICE_MAX_SOUNDS];
+    int count = 0;
+    for (int s = 0; s < vm->num_sounds; s++) {
+        if (!vm->pending[s]) continue;
+
+        int i = count++;
+        while (i > 0 && vm->sounds[order[i - 1]].priority < vm->sounds[s].priority) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = s;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int sound = order[i];
+        SoundDef* def = &vm->sounds[sound];
+        Uint32 frames;
+        vm->pending[sound] = 0;
+        if (!soundBankSamples(vm->bank, sound, &frames)) continue; // missing file
+
+        if (emitterAttenuation(vm, &vm->pending_emitter[sound]) <= 0.0f) {
+            vm->culled++;
+            continue;
+        }
+
+        int channel = pickChannel(vm, sound);
+        if (channel < 0) {
+            vm->dropped++;
+            continue;
+        }
+
+        Voice voice = {
+            .sound = sound,
+            .priority = def->priority,
+            .gain = vm->pending_gain[sound],
+            .emitter = vm->pending_emitter[sound],
+            .started = vm->next_start
+        };
+        voiceGains(vm, &voice, &voice.applied_left, &voice.applied_right);
+        if (!playSfx(&vm->mixer, channel, sound, voice.applied_left, voice.applied_right)) {
+            vm->dropped++;
+            continue;
+        }
+
+        if (vm->voices[channel].sound >= 0) vm->stolen++;
+        vm->voices[channel] = voice;
+        vm->next_start++;
+        vm->played++;
+    }
+
+    // The listener moved: one pass over every playing voice
+    for (int i = 0; i < VOICE_CHANNELS; i++) {
+        if (vm->voices[i].sound >= 0) applyVoice(vm, i);
+    }
+}
+
+// Applies a new sound effects setting to the voices already playing
+void setVoiceVolume(VoiceManager* vm, float volume) {
+    vm->volume = volume;
+    for (int i = 0; i < VOICE_CHANNELS; i++) {
+        if (vm->voices[i].sound >= 0) applyVoice(vm, i);
+    }
+}
+
+void printVoiceStats(VoiceManager* vm) {
+    printf("Sounds: %llu triggered, %llu merged, %llu played, %llu stolen, %llu dropped, %llu culled\n",
+           (unsigned long long)vm->triggered, (unsigned long long)vm->merged, (unsigned long long)vm->played,
+           (unsigned long long)vm->stolen, (unsigned long long)vm->dropped, (unsigned long long)vm->culled);
+}
@@ -0,0 +1,97 @@
+#ifndef VOICES_H
+#define VOICES_H
+
+#include <SDL2/SDL.h>
+#include "sfxmixer.h"
+#include "assets.h"
+
+/*
+            DEFINITIONS
+*/
+#define VOICE_CHANNELS 16            // Effects mixer voices in use (at most SFX_MAX_VOICES)
+#define VOICE_MAX_SOUNDS 32          // Registered sound effects, sound id = bank entry
+
+// Higher wins when every channel is busy
+#define SOUND_PRIORITY_LOW 0         // Frequent and expendable (shots, impacts)
+#define SOUND_PRIORITY_NORMAL 1
+#define SOUND_PRIORITY_HIGH 2        // Cues the player must hear (discovery chime)
+
+// World emitters, distances in px from the listener (the fighter)
+#define VOICE_NEAR_DISTANCE 300.0f   // Full volume inside
+#define VOICE_AUDIBLE_RANGE 2500.0f  // Silent past it: culled before taking a channel
+#define VOICE_PAN_WIDTH 1000.0f      // Horizontal offset for a hard left or right
+
+/*
+            VOICE STRUCTURES
+*/
+typedef struct {
+    const char* path;
+    int priority;
+    int max_voices;                  // Instances playing at once, the oldest restarts past it
+} SoundDef;
+
+typedef struct {
+    int positional;                  // 0: centered, full volume (UI, global cues)
+    float x, y;                      // World position
+} SoundEmitter;
+
+typedef struct {
+    int sound;                       // -1: free
+    int priority;
+    float gain;
+    SoundEmitter emitter;
+    float applied_left, applied_right;  // Last sent to the mixer, to skip unchanged updates
+    Uint64 started;                  // Play order, lower is older
+} Voice;
+
+// Triggers are only recorded during the frame, one pending entry per sound:
+// the same sound triggered many times in a frame plays once. The flush then
+// starts them by priority, stealing the lowest priority (then oldest) voice
+// when the channel budget is used up. Positional voices get their pan and
+// attenuation from the listener position, recomputed for all of them once
+// per flush. Playback goes through the effects mixer command queue, the
+// game thread never waits on the audio thread.
+typedef struct {
+    SfxMixer mixer;
+    SoundDef sounds[VOICE_MAX_SOUNDS];
+    int num_sounds;
+    const SoundBank* bank;           // Last one handed to the mixer, alive until the next
+    Uint64 reload_queued[VOICE_MAX_SOUNDS];   // Newest hot reload per sound, older decodes are dropped
+
+    Voice voices[VOICE_CHANNELS];
+    Uint64 next_start;
+
+    int pending[VOICE_MAX_SOUNDS];   // Triggers this frame
+    float pending_gain[VOICE_MAX_SOUNDS];
+    SoundEmitter pending_emitter[VOICE_MAX_SOUNDS];
+
+    float listener_x, listener_y;    // World position
+    float volume;                    // Sound effects setting (0 to 1)
+
+    // Counters (since init)
+    Uint64 triggered;
+    Uint64 merged;                   // Duplicates folded into one voice
+    Uint64 played;
+    Uint64 stolen;
+    Uint64 dropped;                  // Nothing of lower or equal priority to steal
+    Uint64 culled;                   // Out of audible range
+} VoiceManager;
+
+
+/*
+            DECLARATIONS
+*/
+void initVoiceManager(VoiceManager* vm);
+void shutdownVoiceManager(VoiceManager* vm);
+int registerSound(VoiceManager* vm, const char* path, int priority, int max_voices);
+int findSound(VoiceManager* vm, const char* path);
+void loadSounds(VoiceManager* vm);
+void reloadSound(VoiceManager* vm, AssetLoader* loader, int sound);
+void triggerSound(VoiceManager* vm, int sound, float gain);
+void triggerSoundAt(VoiceManager* vm, int sound, float gain, float x, float y);
+void setListenerPosition(VoiceManager* vm, float x, float y);
+void flushSoundEvents(VoiceManager* vm, float volume);
+void setVoiceVolume(VoiceManager* vm, float volume);
+void printVoiceStats(VoiceManager* vm);
+
+#endif